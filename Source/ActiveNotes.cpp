@@ -0,0 +1,107 @@
+#include "ActiveNotes.h"
+
+//==============================================================================
+void ActiveNotes::handleMidiEvent(const juce::uint8* data, int numBytes) noexcept
+{
+    if (data == nullptr || numBytes < 3)
+        return;
+
+    auto type = data[0] & 0xf0;
+    auto channel = (data[0] & 0x0f) + 1;
+
+    if (type == 0x90 && data[2] > 0)
+    {
+        noteOn(channel, data[1]);
+    }
+    else if (type == 0x80 || type == 0x90)
+    {
+        // Note on with velocity 0 is a note off
+        noteOff(channel, data[1]);
+    }
+    else if (type == 0xb0 && (data[1] == 120 || data[1] == 123))
+    {
+        // All sound off / all notes off already silenced the channel
+        notes[channel - 1][0] = 0;
+        notes[channel - 1][1] = 0;
+    }
+}
+
+void ActiveNotes::noteOn(int channel, int noteNumber) noexcept
+{
+    jassert(channel >= 1 && channel <= 16 && noteNumber >= 0 && noteNumber < 128);
+    notes[(channel - 1) & 15][(noteNumber >> 6) & 1] |= (juce::uint64) 1 << (noteNumber & 63);
+}
+
+void ActiveNotes::noteOff(int channel, int noteNumber) noexcept
+{
+    jassert(channel >= 1 && channel <= 16 && noteNumber >= 0 && noteNumber < 128);
+    notes[(channel - 1) & 15][(noteNumber >> 6) & 1] &= ~((juce::uint64) 1 << (noteNumber & 63));
+}
+
+bool ActiveNotes::isNoteOn(int channel, int noteNumber) const noexcept
+{
+    if (channel < 1 || channel > 16 || noteNumber < 0 || noteNumber > 127)
+        return false;
+
+    return (notes[channel - 1][noteNumber >> 6] >> (noteNumber & 63)) & 1;
+}
+
+int ActiveNotes::getNumActiveNotes() const noexcept
+{
+    int numNotes = 0;
+
+    for (auto& channelNotes : notes)
+        numNotes += juce::countNumberOfBits(channelNotes[0]) + juce::countNumberOfBits(channelNotes[1]);
+
+    return numNotes;
+}
+
+bool ActiveNotes::isEmpty() const noexcept
+{
+    for (auto& channelNotes : notes)
+        if ((channelNotes[0] | channelNotes[1]) != 0)
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+int ActiveNotes::releaseAll(juce::MidiBuffer& destination, int samplePosition) noexcept
+{
+    return releaseAllExcept(ActiveNotes(), destination, samplePosition);
+}
+
+int ActiveNotes::releaseAllExcept(const ActiveNotes& notesToKeep, juce::MidiBuffer& destination, int samplePosition) noexcept
+{
+    int numReleased = 0;
+
+    for (int channel = 0; channel < 16; ++channel)
+    {
+        for (int word = 0; word < 2; ++word)
+        {
+            // Only visit set bits; idle channels cost one compare
+            auto kept = notes[channel][word] & notesToKeep.notes[channel][word];
+
+            for (auto bits = notes[channel][word] & ~kept; bits != 0; bits &= bits - 1)
+            {
+                auto bit = juce::countNumberOfBits((bits & (~bits + 1)) - 1);
+
+                const juce::uint8 noteOff[] = { static_cast<juce::uint8>(0x80 | channel),
+                                                static_cast<juce::uint8>(word * 64 + bit),
+                                                0 };
+                destination.addEvent(noteOff, 3, samplePosition);
+                ++numReleased;
+            }
+
+            notes[channel][word] = kept;
+        }
+    }
+
+    return numReleased;
+}
+
+void ActiveNotes::clear() noexcept
+{
+    for (auto& channelNotes : notes)
+        channelNotes[0] = channelNotes[1] = 0;
+}
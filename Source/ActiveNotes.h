@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Active Note Tracker for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    A 128-bit set of sounding notes for each MIDI channel (256 bytes in total),
+    updated from the events a track renders. When playback stops, jumps or the
+    track is replaced, releaseAll() emits exactly one note-off per note that is
+    still sounding. It has a fixed size and never allocates, so it lives on the
+    audio thread.
+*/
+class ActiveNotes
+{
+public:
+    //==============================================================================
+    ActiveNotes() = default;
+
+    //==============================================================================
+    /** Update the set from a raw MIDI message (note on/off, all notes off) */
+    void handleMidiEvent(const juce::uint8* data, int numBytes) noexcept;
+
+    /** Mark a note as sounding
+        @param channel      MIDI channel 1-16
+        @param noteNumber   Note number 0-127
+    */
+    void noteOn(int channel, int noteNumber) noexcept;
+
+    /** Mark a note as released
+        @param channel      MIDI channel 1-16
+        @param noteNumber   Note number 0-127
+    */
+    void noteOff(int channel, int noteNumber) noexcept;
+
+    /** Check if a note is sounding */
+    bool isNoteOn(int channel, int noteNumber) const noexcept;
+
+    /** Get the number of sounding notes on all channels */
+    int getNumActiveNotes() const noexcept;
+
+    /** Check if no notes are sounding */
+    bool isEmpty() const noexcept;
+
+    //==============================================================================
+    /** Emit a note-off for every sounding note and clear the set
+        @param destination      Buffer receiving the note-offs
+        @param samplePosition   Sample offset of the note-offs inside the block
+        @returns number of note-offs emitted
+    */
+    int releaseAll(juce::MidiBuffer& destination, int samplePosition) noexcept;
+
+    /** Emit a note-off for every sounding note that is not in another set,
+        and keep only the notes that are
+        @param notesToKeep      Notes that carry on sounding
+        @param destination      Buffer receiving the note-offs
+        @param samplePosition   Sample offset of the note-offs inside the block
+        @returns number of note-offs emitted
+    */
+    int releaseAllExcept(const ActiveNotes& notesToKeep, juce::MidiBuffer& destination, int samplePosition) noexcept;
+
+    /** Forget all notes without emitting anything */
+    void clear() noexcept;
+
+private:
+    //==============================================================================
+    juce::uint64 notes[16][2] = {};
+
+    //==============================================================================
+    JUCE_LEAK_DETECTOR (ActiveNotes)
+};
@@ -0,0 +1,61 @@
+#include "CommandQueue.h"
+
+//==============================================================================
+CommandQueue::CommandQueue()
+{
+    for (size_t i = 0; i < slots.size(); ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+CommandQueue::~CommandQueue()
+{
+}
+
+//==============================================================================
+bool CommandQueue::push(const Command& command) noexcept
+{
+    auto position = writePosition.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto& slot = slots[position & indexMask];
+        auto sequence = slot.sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+        if (difference == 0)
+        {
+            // The slot is free for this position; claim it, unless another
+            // producer got there first (then position holds the new value)
+            if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                slot.command = command;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The consumer has not freed this slot yet, one lap ago
+            return false;
+        }
+        else
+        {
+            position = writePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool CommandQueue::pop(Command& command) noexcept
+{
+    auto& slot = slots[readPosition & indexMask];
+
+    if (slot.sequence.load(std::memory_order_acquire) != readPosition + 1)
+        return false;
+
+    command = slot.command;
+
+    // Hand the slot to the producer one lap ahead
+    slot.sequence.store(readPosition + static_cast<size_t>(capacity), std::memory_order_release);
+    ++readPosition;
+    return true;
+}
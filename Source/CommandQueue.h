@@ -0,0 +1,95 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+    Command Queue for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    A fixed-capacity, lock-free queue carrying control changes (transport,
+    tempo, track mix) to the audio thread. The audio thread is the only
+    consumer and drains the queue at the start of each block, so every change
+    takes effect at a block boundary, in the order it was made, and the
+    audio thread is the only one that ever touches the playback state.
+
+    The editor, the host (state restore) and network callbacks can all
+    send commands, so pushing is safe from any number of threads: a producer
+    claims a slot with a compare-and-swap and publishes it through the slot's
+    sequence number. Neither side ever locks, waits or allocates; a slot that
+    is claimed but not yet published simply ends the drain until the next
+    block.
+*/
+class CommandQueue
+{
+public:
+    //==============================================================================
+    /** A control change for the audio thread */
+    struct Command
+    {
+        enum Type
+        {
+            start,                  /**< Start playing from value (beats) */
+            stop,                   /**< Stop and release the sounding notes */
+            seek,                   /**< Move the playhead to value (beats) */
+            setTempo,               /**< Internal tempo value (BPM), ramped over secondValue seconds */
+            setTrackMuted,          /**< Mute trackIndex (value != 0) */
+            setTrackSoloed,         /**< Solo trackIndex (value != 0) */
+            setTrackTimingOffset,   /**< Timing offset of trackIndex in milliseconds */
+            setHandoffBars          /**< Bars new tracks wait for while playing */
+        };
+
+        Type type = stop;
+        int trackIndex = 0;
+        double value = 0.0;
+        double secondValue = 0.0;
+    };
+
+    /** Largest number of commands waiting at once (a power of two) */
+    static constexpr int capacity = 1024;
+
+    //==============================================================================
+    CommandQueue();
+    ~CommandQueue();
+
+    //==============================================================================
+    /** Add a command (any thread, lock-free)
+        @returns false if the queue is full and the command was dropped
+    */
+    bool push(const Command& command) noexcept;
+
+    /** Take the oldest command (audio thread only, wait-free)
+        @returns false if there is no command ready
+    */
+    bool pop(Command& command) noexcept;
+
+private:
+    //==============================================================================
+    /** A queue entry; its sequence number tells whose turn it is:
+        position = free for the producer at that position,
+        position + 1 = holds a command for the consumer
+    */
+    struct Slot
+    {
+        std::atomic<size_t> sequence { 0 };
+        Command command;
+    };
+
+    static constexpr size_t indexMask = static_cast<size_t>(capacity) - 1;
+    static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
+    std::array<Slot, static_cast<size_t>(capacity)> slots;
+
+    // Kept on separate cache lines, since producers and consumer write them
+    alignas(64) std::atomic<size_t> writePosition { 0 };
+    alignas(64) size_t readPosition = 0;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CommandQueue)
+};
@@ -0,0 +1,258 @@
+#include "CompiledTrackCache.h"
+
+// The arrays are stored as they are in memory, so their layout is part of the format
+static_assert(sizeof(TempoMap::Segment) == 24 && sizeof(TempoMap::Meter) == 32, "Tempo map layout changed");
+static_assert(sizeof(NoteIntervalIndex::Interval) == 16, "Note index layout changed");
+static_assert(sizeof(MidiTimeline::Event) == 8, "Event layout changed");
+
+namespace
+{
+    /** Write the elements of an array as they are in memory */
+    template <typename Element>
+    bool writeArray(juce::OutputStream& stream, const std::vector<Element>& elements)
+    {
+        return elements.empty() || stream.write(elements.data(), elements.size() * sizeof(Element));
+    }
+}
+
+//==============================================================================
+CompiledTrackCache::CompiledTrackCache(const juce::File& cacheFolder)
+    : folder(cacheFolder)
+{
+}
+
+CompiledTrackCache::~CompiledTrackCache()
+{
+}
+
+//==============================================================================
+std::shared_ptr<const MidiTimeline> CompiledTrackCache::load(juce::uint64 contentHash, size_t sourceSize) const
+{
+    juce::MemoryMappedFile mappedFile(getFileFor(contentHash, sourceSize), juce::MemoryMappedFile::readOnly);
+    auto* data = static_cast<const juce::uint8*>(mappedFile.getData());
+
+    if (data == nullptr || mappedFile.getSize() < sizeof(Header))
+        return nullptr;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+
+    if (validateHeader(header, contentHash, sourceSize) != static_cast<juce::uint64>(mappedFile.getSize()))
+        return nullptr;
+
+    // The arrays follow the header in this order; the mapping is page
+    // aligned and every array before one of doubles is too, so all of
+    // them can be read in place
+    auto* segments = reinterpret_cast<const TempoMap::Segment*>(data + sizeof(Header));
+    auto* meters = reinterpret_cast<const TempoMap::Meter*>(segments + header.numSegments);
+    auto* intervals = reinterpret_cast<const NoteIntervalIndex::Interval*>(meters + header.numMeters);
+    auto* events = reinterpret_cast<const MidiTimeline::Event*>(intervals + header.numIntervals);
+    auto* longMessages = reinterpret_cast<const MidiTimeline::LongMessage*>(events + header.numEvents);
+    auto* extendedData = reinterpret_cast<const juce::uint8*>(longMessages + header.numLongMessages);
+
+    // Everything playback indexes with must stay in range, even for a damaged file
+    for (juce::uint32 i = 0; i < header.numSegments; ++i)
+        if (!(segments[i].secondsPerBeat > 0.0))
+            return nullptr;
+
+    for (juce::uint32 i = 0; i < header.numMeters; ++i)
+        if (!(meters[i].beatsPerBar > 0.0))
+            return nullptr;
+
+    for (juce::uint32 i = 0; i < header.numIntervals; ++i)
+        if (intervals[i].eventIndex < 0 || static_cast<juce::uint32>(intervals[i].eventIndex) >= header.numEvents)
+            return nullptr;
+
+    for (juce::uint32 i = 0; i < header.numLongMessages; ++i)
+        if (static_cast<juce::uint64>(longMessages[i].offset) + longMessages[i].size > header.extendedDataSize)
+            return nullptr;
+
+    for (juce::uint32 i = 0; i < header.numEvents; ++i)
+    {
+        const auto& event = events[i];
+
+        if (i > 0 && event.position < events[i - 1].position)
+            return nullptr;
+
+        if (event.numBytes > 3)
+            return nullptr;
+
+        if (event.numBytes == MidiTimeline::longMessage
+            && static_cast<juce::uint32>(event.bytes[0] | (event.bytes[1] << 8) | (event.bytes[2] << 16)) >= header.numLongMessages)
+            return nullptr;
+    }
+
+    auto timeline = std::make_shared<MidiTimeline>();
+    timeline->setTicksPerQuarterNote(header.ticksPerQuarterNote);
+    timeline->events.assign(events, events + header.numEvents);
+    timeline->longMessages.assign(longMessages, longMessages + header.numLongMessages);
+    timeline->extendedData.assign(extendedData, extendedData + header.extendedDataSize);
+    timeline->noteIndex.intervals.assign(intervals, intervals + header.numIntervals);
+    timeline->noteIndex.rootLevel = header.intervalRootLevel;
+
+    if (header.tempoTicksPerQuarterNote > 0)
+    {
+        auto tempoMap = std::make_shared<TempoMap>(TempoMap::defaultTempoBpm, header.tempoTicksPerQuarterNote);
+        tempoMap->segments.assign(segments, segments + header.numSegments);
+        tempoMap->meters.assign(meters, meters + header.numMeters);
+        timeline->setTempoMap(std::move(tempoMap));
+    }
+
+    return timeline;
+}
+
+bool CompiledTrackCache::store(juce::uint64 contentHash, size_t sourceSize, const MidiTimeline& timeline) const
+{
+    jassert(!timeline.needsSorting);
+
+    if (!folder.isDirectory() && !folder.createDirectory().wasOk())
+        return false;
+
+    const auto* tempoMap = timeline.getTempoMap().get();
+
+    Header header {};
+    header.magic = magicNumber;
+    header.version = formatVersion;
+    header.contentHash = contentHash;
+    header.sourceSize = static_cast<juce::uint64>(sourceSize);
+    header.ticksPerQuarterNote = timeline.getTicksPerQuarterNote();
+    header.tempoTicksPerQuarterNote = tempoMap != nullptr ? tempoMap->getTicksPerQuarterNote() : 0;
+    header.numSegments = tempoMap != nullptr ? static_cast<juce::uint32>(tempoMap->segments.size()) : 0;
+    header.numMeters = tempoMap != nullptr ? static_cast<juce::uint32>(tempoMap->meters.size()) : 0;
+    header.numIntervals = static_cast<juce::uint32>(timeline.noteIndex.intervals.size());
+    header.intervalRootLevel = timeline.noteIndex.rootLevel;
+    header.numEvents = static_cast<juce::uint32>(timeline.events.size());
+    header.numLongMessages = static_cast<juce::uint32>(timeline.longMessages.size());
+    header.extendedDataSize = static_cast<juce::uint32>(timeline.extendedData.size());
+
+    // Written next to the entry and moved over it once complete
+    juce::TemporaryFile temporaryFile(getFileFor(contentHash, sourceSize));
+
+    {
+        juce::FileOutputStream stream(temporaryFile.getFile());
+        if (stream.failedToOpen())
+            return false;
+
+        bool written = stream.write(&header, sizeof(Header));
+
+        if (tempoMap != nullptr)
+            written = written && writeArray(stream, tempoMap->segments) && writeArray(stream, tempoMap->meters);
+
+        written = written && writeArray(stream, timeline.noteIndex.intervals)
+                          && writeArray(stream, timeline.events)
+                          && writeArray(stream, timeline.longMessages)
+                          && writeArray(stream, timeline.extendedData);
+
+        stream.flush();
+
+        if (!written || stream.getStatus().failed())
+            return false;
+    }
+
+    if (!temporaryFile.overwriteTargetFileWithTemporary())
+        return false;
+
+    removeOldEntries(getFileFor(contentHash, sourceSize));
+    return true;
+}
+
+juce::File CompiledTrackCache::getFileFor(juce::uint64 contentHash, size_t sourceSize) const
+{
+    return folder.getChildFile(juce::String::toHexString(static_cast<juce::int64>(contentHash)).paddedLeft('0', 16)
+                               + "-" + juce::String(static_cast<juce::int64>(sourceSize)) + fileExtension);
+}
+
+void CompiledTrackCache::setLimits(int maxNumEntries, juce::int64 maxNumBytes) noexcept
+{
+    maxEntries = juce::jmax(1, maxNumEntries);
+    maxBytes = juce::jmax(static_cast<juce::int64>(0), maxNumBytes);
+}
+
+void CompiledTrackCache::removeOldEntries(const juce::File& newEntry) const
+{
+    struct Entry
+    {
+        juce::File file;
+        juce::int64 modified;
+        juce::int64 size;
+    };
+
+    std::vector<Entry> entries;
+
+    for (const auto& file : folder.findChildFiles(juce::File::findFiles, false, juce::String("*") + fileExtension))
+        entries.push_back({ file, file.getLastModificationTime().toMilliseconds(), file.getSize() });
+
+    // Newest first; the new entry is kept and counted whatever its time stamp
+    std::sort(entries.begin(), entries.end(), [&newEntry](const Entry& a, const Entry& b)
+    {
+        if ((a.file == newEntry) != (b.file == newEntry))
+            return a.file == newEntry;
+
+        return a.modified > b.modified;
+    });
+
+    int numKept = 0;
+    juce::int64 bytesKept = 0;
+    bool full = false;
+
+    for (const auto& entry : entries)
+    {
+        if (entry.file != newEntry)
+        {
+            full = full || numKept >= maxEntries || bytesKept + entry.size > maxBytes;
+
+            if (full)
+            {
+                // May fail while another instance has the file mapped; it goes next time
+                entry.file.deleteFile();
+                continue;
+            }
+        }
+
+        ++numKept;
+        bytesKept += entry.size;
+    }
+}
+
+//==============================================================================
+juce::File CompiledTrackCache::getFolderFor(const juce::File& sourceFolder)
+{
+    return sourceFolder.getSiblingFile(sourceFolder.getFileName() + "-aibc");
+}
+
+//==============================================================================
+juce::uint64 CompiledTrackCache::validateHeader(const Header& header, juce::uint64 contentHash, size_t sourceSize) noexcept
+{
+    if (header.magic != magicNumber || header.version != formatVersion
+        || header.contentHash != contentHash || header.sourceSize != static_cast<juce::uint64>(sourceSize))
+        return 0;
+
+    if (header.ticksPerQuarterNote <= 0 || header.tempoTicksPerQuarterNote < 0)
+        return 0;
+
+    // A tempo map always has a segment and a meter; no tempo map has neither
+    bool hasTempoMap = header.tempoTicksPerQuarterNote > 0;
+    if (hasTempoMap ? (header.numSegments == 0 || header.numMeters == 0)
+                    : (header.numSegments != 0 || header.numMeters != 0))
+        return 0;
+
+    // Indices are ints in memory, and the tree's root level follows from its size
+    if (header.numEvents > static_cast<juce::uint32>(std::numeric_limits<int>::max())
+        || header.numIntervals > header.numEvents)
+        return 0;
+
+    auto expectedRootLevel = 0;
+    while ((static_cast<juce::uint64>(2) << expectedRootLevel) <= header.numIntervals)
+        ++expectedRootLevel;
+
+    if (header.intervalRootLevel != expectedRootLevel)
+        return 0;
+
+    return sizeof(Header)
+         + static_cast<juce::uint64>(header.numSegments) * sizeof(TempoMap::Segment)
+         + static_cast<juce::uint64>(header.numMeters) * sizeof(TempoMap::Meter)
+         + static_cast<juce::uint64>(header.numIntervals) * sizeof(NoteIntervalIndex::Interval)
+         + static_cast<juce::uint64>(header.numEvents) * sizeof(MidiTimeline::Event)
+         + static_cast<juce::uint64>(header.numLongMessages) * sizeof(MidiTimeline::LongMessage)
+         + header.extendedDataSize;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include "MidiTimeline.h"
+#include "TempoMap.h"
+
+//==============================================================================
+/**
+    Compiled Track Cache for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    Folder of compiled timelines (.aibc files), so a session reload or a
+    rescan of the backend folder does not parse MIDI files again. Each file
+    holds one timeline exactly as it is in memory: the packed events and
+    their long message data, the note interval index and the tempo map.
+
+    Entries are keyed by the content hash and size of the source file, so
+    a renamed or copied file still hits and a rewritten one misses. A warm
+    load maps the file, validates it and copies the arrays into a timeline;
+    nothing is parsed, sorted or indexed. Files written by another format
+    version, for another source, or that are damaged are rejected and
+    simply rewritten by the next store().
+
+    Files are written to a temporary file and moved into place, so readers
+    (other plugin instances included) never see a partly written entry.
+    The backend keeps generating new takes, so after each store() the
+    oldest entries beyond a count and size limit are removed.
+*/
+class CompiledTrackCache
+{
+public:
+    //==============================================================================
+    /** Create a cache that keeps its files in a folder (created on the first store) */
+    explicit CompiledTrackCache(const juce::File& cacheFolder);
+    ~CompiledTrackCache();
+
+    //==============================================================================
+    /** Load the compiled timeline of a source file's content
+        @param contentHash  TimelineCache::hashContent() of the source file
+        @param sourceSize   Size of the source file in bytes
+        @returns the timeline, or nullptr if there is no valid entry for it
+    */
+    std::shared_ptr<const MidiTimeline> load(juce::uint64 contentHash, size_t sourceSize) const;
+
+    /** Write the compiled timeline of a source file's content
+        @param contentHash  TimelineCache::hashContent() of the source file
+        @param sourceSize   Size of the source file in bytes
+        @param timeline     Compiled timeline (finishCompiling() already called)
+        @returns true if the entry was written
+    */
+    bool store(juce::uint64 contentHash, size_t sourceSize, const MidiTimeline& timeline) const;
+
+    /** Get the file an entry is stored in */
+    juce::File getFileFor(juce::uint64 contentHash, size_t sourceSize) const;
+
+    /** Get the folder the entries are stored in */
+    const juce::File& getFolder() const noexcept { return folder; }
+
+    /** Set how many entries, and how many bytes of them, the folder keeps;
+        store() removes the least recently written entries beyond either
+    */
+    void setLimits(int maxNumEntries, juce::int64 maxNumBytes) noexcept;
+
+    //==============================================================================
+    /** Get the cache folder for MIDI files in a folder: a sibling folder
+        named after it ("output" -> "output-aibc")
+    */
+    static juce::File getFolderFor(const juce::File& sourceFolder);
+
+    /** Version of the file layout; entries of any other version are rejected */
+    static constexpr juce::uint32 formatVersion = 1;
+
+    /** Extension of the cache files */
+    static constexpr const char* fileExtension = ".aibc";
+
+    /** Entries a cache folder keeps unless setLimits() says otherwise */
+    static constexpr int defaultMaxEntries = 512;
+
+    /** Bytes of entries a cache folder keeps unless setLimits() says otherwise */
+    static constexpr juce::int64 defaultMaxBytes = 256 * 1024 * 1024;
+
+private:
+    //==============================================================================
+    /** Start of every cache file, followed by the tempo segments, meters,
+        note intervals, events, long messages and long message data
+    */
+    struct Header
+    {
+        juce::uint32 magic;                 /**< Also rejects files of the other byte order */
+        juce::uint32 version;
+        juce::uint64 contentHash;
+        juce::uint64 sourceSize;
+        juce::int32 ticksPerQuarterNote;
+        juce::int32 tempoTicksPerQuarterNote;   /**< 0 if the timeline has no tempo map */
+        juce::uint32 numSegments;
+        juce::uint32 numMeters;
+        juce::uint32 numIntervals;
+        juce::int32 intervalRootLevel;
+        juce::uint32 numEvents;
+        juce::uint32 numLongMessages;
+        juce::uint32 extendedDataSize;
+        juce::uint32 reserved;
+    };
+
+    static_assert(sizeof(Header) == 64, "Header layout is part of the file format");
+
+    static constexpr juce::uint32 magicNumber = 0x43424941;    // "AIBC"
+
+    /** Check that a header belongs to an entry for a source and describes consistent arrays
+        @returns the file size the header describes, or 0 if it is invalid
+    */
+    static juce::uint64 validateHeader(const Header& header, juce::uint64 contentHash, size_t sourceSize) noexcept;
+
+    /** Remove the oldest entries beyond the limits, never the one just written */
+    void removeOldEntries(const juce::File& newEntry) const;
+
+    //==============================================================================
+    juce::File folder;
+    int maxEntries = defaultMaxEntries;
+    juce::int64 maxBytes = defaultMaxBytes;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompiledTrackCache)
+};
@@ -0,0 +1,158 @@
+#include "EventTransform.h"
+
+//==============================================================================
+EventTransform::EventTransform()
+{
+    for (size_t i = 0; i < noteTable.size(); ++i)
+    {
+        noteTable[i] = static_cast<juce::uint8>(i);
+        velocityTable[i] = static_cast<juce::uint8>(i);
+    }
+
+    for (size_t i = 0; i < channelTable.size(); ++i)
+        channelTable[i] = static_cast<juce::uint8>(i);
+}
+
+//==============================================================================
+EventTransform& EventTransform::scaleVelocity(float scale)
+{
+    // Velocity 0 is a note-off and stays one
+    for (size_t i = 1; i < velocityTable.size(); ++i)
+        velocityTable[i] = static_cast<juce::uint8>(juce::jlimit(1, 127, juce::roundToInt(velocityTable[i] * juce::jmax(0.0f, scale))));
+
+    return *this;
+}
+
+EventTransform& EventTransform::applyVelocityCurve(float exponent)
+{
+    exponent = juce::jmax(0.01f, exponent);
+
+    for (size_t i = 1; i < velocityTable.size(); ++i)
+    {
+        auto curved = 127.0 * std::pow(velocityTable[i] / 127.0, static_cast<double>(exponent));
+        velocityTable[i] = static_cast<juce::uint8>(juce::jlimit(1, 127, juce::roundToInt(curved)));
+    }
+
+    return *this;
+}
+
+EventTransform& EventTransform::transpose(int semitones)
+{
+    for (auto& note : noteTable)
+        if (note != dropNote)
+            note = juce::isPositiveAndBelow(note + semitones, 128) ? static_cast<juce::uint8>(note + semitones) : dropNote;
+
+    return *this;
+}
+
+EventTransform& EventTransform::remapNote(int fromNote, int toNote)
+{
+    if (!juce::isPositiveAndBelow(fromNote, 128) || !(juce::isPositiveAndBelow(toNote, 128) || toNote == dropNote))
+        return *this;
+
+    for (auto& note : noteTable)
+        if (note == fromNote)
+            note = static_cast<juce::uint8>(toNote);
+
+    return *this;
+}
+
+EventTransform& EventTransform::remapNotes(const std::array<juce::uint8, 128>& noteMap)
+{
+    for (auto& note : noteTable)
+        if (note != dropNote)
+            note = noteMap[note] < 128 ? noteMap[note] : dropNote;
+
+    return *this;
+}
+
+EventTransform& EventTransform::remapChannel(int fromChannel, int toChannel)
+{
+    if (!juce::isPositiveAndBelow(fromChannel - 1, 16) || !juce::isPositiveAndBelow(toChannel - 1, 16))
+        return *this;
+
+    for (auto& channel : channelTable)
+        if (channel == fromChannel - 1)
+            channel = static_cast<juce::uint8>(toChannel - 1);
+
+    return *this;
+}
+
+EventTransform& EventTransform::setChannel(int channel)
+{
+    if (juce::isPositiveAndBelow(channel - 1, 16))
+        channelTable.fill(static_cast<juce::uint8>(channel - 1));
+
+    return *this;
+}
+
+//==============================================================================
+bool EventTransform::isIdentity() const noexcept
+{
+    return *this == EventTransform();
+}
+
+bool EventTransform::operator== (const EventTransform& other) const noexcept
+{
+    return noteTable == other.noteTable
+        && velocityTable == other.velocityTable
+        && channelTable == other.channelTable;
+}
+
+//==============================================================================
+bool EventTransform::apply(juce::uint8* data, int numBytes) const noexcept
+{
+    auto type = data[0] & 0xf0;
+
+    // Only channel messages are transformed; system messages pass unchanged
+    if (type < 0x80 || type == 0xf0)
+        return true;
+
+    data[0] = static_cast<juce::uint8>(type | channelTable[data[0] & 0x0f]);
+
+    // Note-on, note-off and polyphonic aftertouch carry a note number
+    if ((type == 0x80 || type == 0x90 || type == 0xa0) && numBytes >= 2)
+    {
+        auto note = noteTable[data[1] & 0x7f];
+
+        if (note == dropNote)
+            return false;
+
+        data[1] = note;
+
+        if (type == 0x90 && numBytes >= 3)
+            data[2] = velocityTable[data[2] & 0x7f];
+    }
+
+    return true;
+}
+
+void EventTransform::bake(const MidiTimeline& source, MidiTimeline& destination) const
+{
+    destination.clear();
+    destination.setTicksPerQuarterNote(source.getTicksPerQuarterNote());
+    destination.setTempoMap(source.getTempoMap());
+
+    for (int i = 0; i < source.getNumEvents(); ++i)
+    {
+        const auto& event = source.getEvent(i);
+        const auto* data = source.getEventData(event);
+        auto numBytes = source.getEventSize(event);
+
+        // Sysex and other long messages are copied as they are
+        if (event.numBytes == MidiTimeline::longMessage)
+        {
+            destination.addEvent(data, numBytes, event.position);
+            continue;
+        }
+
+        juce::uint8 bytes[sizeof(event.bytes)] = {};
+        std::memcpy(bytes, data, static_cast<size_t>(numBytes));
+
+        if (apply(bytes, numBytes))
+            destination.addEvent(bytes, numBytes, event.position);
+    }
+
+    // Already in order, so this only rebuilds the note index
+    destination.finishCompiling();
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "MidiTimeline.h"
+
+//==============================================================================
+/**
+    Event Transform for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    A pipeline of per-event changes (velocity scale and curve, transposition,
+    note remapping for drum kits, channel remapping) that is baked into a
+    track when it is published, so the audio thread only ever plays events
+    that are already transformed.
+
+    Stages are added in order and composed on the spot into three lookup
+    tables: note number, note-on velocity and channel. However many stages
+    there are, transforming an event costs three table reads, and two
+    transforms compare equal when they have the same effect.
+*/
+class EventTransform
+{
+public:
+    //==============================================================================
+    /** Create a transform that leaves every event as it is */
+    EventTransform();
+
+    //==============================================================================
+    // Stages; each applies to the result of the ones added before it
+
+    /** Multiply note-on velocities (results stay within 1-127) */
+    EventTransform& scaleVelocity(float scale);
+
+    /** Bend note-on velocities along a power curve: below 1 lifts soft
+        notes, above 1 makes them softer; 127 stays 127
+    */
+    EventTransform& applyVelocityCurve(float exponent);
+
+    /** Shift notes by semitones; notes pushed outside 0-127 are dropped */
+    EventTransform& transpose(int semitones);
+
+    /** Replace one note number with another, e.g. to fit a drum kit;
+        a toNote of dropNote removes the note
+    */
+    EventTransform& remapNote(int fromNote, int toNote);
+
+    /** Apply a full 128-entry note map; entries of dropNote remove the note */
+    EventTransform& remapNotes(const std::array<juce::uint8, 128>& noteMap);
+
+    /** Move events from one MIDI channel (1-16) to another */
+    EventTransform& remapChannel(int fromChannel, int toChannel);
+
+    /** Move events on every channel to one MIDI channel (1-16) */
+    EventTransform& setChannel(int channel);
+
+    /** Note map entry that removes the note */
+    static constexpr juce::uint8 dropNote = 0xff;
+
+    //==============================================================================
+    /** Check if the transform changes nothing */
+    bool isIdentity() const noexcept;
+
+    bool operator== (const EventTransform& other) const noexcept;
+    bool operator!= (const EventTransform& other) const noexcept { return !operator== (other); }
+
+    //==============================================================================
+    /** Transform one short message in place
+        @returns false if the message is dropped
+    */
+    bool apply(juce::uint8* data, int numBytes) const noexcept;
+
+    /** Build a transformed copy of a timeline (loader threads)
+        Tick resolution and tempo map are kept; the note index is rebuilt.
+        @param source       Timeline to read
+        @param destination  Timeline to fill (cleared first)
+    */
+    void bake(const MidiTimeline& source, MidiTimeline& destination) const;
+
+private:
+    //==============================================================================
+    std::array<juce::uint8, 128> noteTable;
+    std::array<juce::uint8, 128> velocityTable;
+    std::array<juce::uint8, 16> channelTable;
+
+    //==============================================================================
+    JUCE_LEAK_DETECTOR (EventTransform)
+};
@@ -0,0 +1,522 @@
+#include "MidiFileParser.h"
+
+namespace
+{
+    juce::uint32 readBigEndian(const juce::uint8* data, int numBytes) noexcept
+    {
+        juce::uint32 value = 0;
+
+        for (int i = 0; i < numBytes; ++i)
+            value = (value << 8) | data[i];
+
+        return value;
+    }
+
+    bool hasChunkType(const juce::uint8* data, const char* type) noexcept
+    {
+        return std::memcmp(data, type, 4) == 0;
+    }
+
+    /** Read a variable-length quantity (at most 4 bytes)
+        @returns false if the data ends inside it
+    */
+    bool readVariableLength(const juce::uint8*& data, const juce::uint8* end, juce::uint32& value) noexcept
+    {
+        value = 0;
+
+        for (int i = 0; i < 4 && data < end; ++i)
+        {
+            auto byte = *data++;
+            value = (value << 7) | (byte & 0x7f);
+
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    /** Length of a channel or system common message from its status byte */
+    int getMessageLength(juce::uint8 status) noexcept
+    {
+        switch (status & 0xf0)
+        {
+            case 0xc0:
+            case 0xd0:  return 2;
+            case 0xf0:  break;
+            default:    return 3;
+        }
+
+        switch (status)
+        {
+            case 0xf1:
+            case 0xf3:  return 2;
+            case 0xf2:  return 3;
+            default:    return 1;
+        }
+    }
+
+    /** Run task(0) to task(numTasks - 1) on the caller's thread and on a
+        pool's threads, returning once all of them have finished. Tasks are
+        handed out in order to whichever thread is free first. The caller
+        only waits for pool threads that joined in while it was still
+        working; jobs that start later, e.g. on a busy pool, do nothing.
+    */
+    template <typename Task>
+    void runOnAllThreads(juce::ThreadPool* pool, int numTasks, Task&& task)
+    {
+        // Kept alive by the pool's jobs, which may start or signal once the caller has returned
+        struct Progress
+        {
+            std::atomic<int> nextTask { 0 };
+            std::atomic<int> helperState { 0 };    // Helpers running tasks, plus closedFlag
+            juce::WaitableEvent helpersFinished;
+        };
+
+        // Set by the caller once it has run out of tasks; no helper joins after that
+        constexpr int closedFlag = 1 << 30;
+
+        auto progress = std::make_shared<Progress>();
+
+        auto runTasks = [&task, numTasks](Progress& state)
+        {
+            for (int index = state.nextTask++; index < numTasks; index = state.nextTask++)
+                task(index);
+        };
+
+        auto numHelpers = pool != nullptr ? juce::jmin(pool->getNumThreads(), numTasks - 1) : 0;
+
+        for (int i = 0; i < numHelpers; ++i)
+        {
+            pool->addJob([progress, &runTasks, numTasks]
+            {
+                // The tasks and runTasks live on the caller's stack, so they are
+                // only touched after joining, which fails once the caller is done
+                auto state = progress->helperState.load();
+
+                do
+                {
+                    if ((state & closedFlag) != 0 || progress->nextTask.load() >= numTasks)
+                        return;
+                }
+                while (!progress->helperState.compare_exchange_weak(state, state + 1));
+
+                runTasks(*progress);
+
+                if (progress->helperState.fetch_sub(1) == (closedFlag | 1))
+                    progress->helpersFinished.signal();
+            });
+        }
+
+        runTasks(*progress);
+
+        if ((progress->helperState.fetch_or(closedFlag) & ~closedFlag) > 0)
+            progress->helpersFinished.wait();
+    }
+
+    juce::uint32 getLongMessageIndex(const MidiTimeline::Event& event) noexcept
+    {
+        return static_cast<juce::uint32>(event.bytes[0] | (event.bytes[1] << 8) | (event.bytes[2] << 16));
+    }
+}
+
+//==============================================================================
+MidiFileParser::MidiFileParser()
+{
+}
+
+MidiFileParser::~MidiFileParser()
+{
+}
+
+//==============================================================================
+bool MidiFileParser::parse(const void* data, size_t size, MidiTimeline& timeline)
+{
+    if (data == nullptr || size < 14)
+        return false;
+
+    auto* bytes = static_cast<const juce::uint8*>(data);
+    auto* end = bytes + size;
+
+    // RIFF-wrapped files (.rmi) carry the standard file a few chunks in
+    if (hasChunkType(bytes, "RIFF"))
+    {
+        for (int i = 0; i < 8 && !hasChunkType(bytes, "MThd") && bytes + 18 <= end; ++i)
+            bytes += 4;
+    }
+
+    if (end - bytes < 14 || !hasChunkType(bytes, "MThd"))
+        return false;
+
+    auto headerSize = readBigEndian(bytes + 4, 4);
+    if (headerSize < 6 || headerSize > static_cast<size_t>(end - bytes - 8))
+        return false;
+
+    auto format = readBigEndian(bytes + 8, 2);
+    auto numTracks = static_cast<int>(readBigEndian(bytes + 10, 2));
+    auto timeFormat = static_cast<juce::int16>(readBigEndian(bytes + 12, 2));
+
+    if (format > 2)
+        return false;
+
+    // Only a file that is going to be read replaces the timeline's content
+    timeline.clear();
+
+    auto ticks = timeFormat > 0 ? static_cast<int>(timeFormat) : defaultTicksPerQuarterNote;
+    timeline.setTicksPerQuarterNote(ticks);
+
+    decoder.tempoChanges.clear();
+    decoder.timeSignatures.clear();
+    trackChunks.clear();
+
+    // Chunks that are not tracks still count towards the header's number of tracks
+    auto* chunk = bytes + 8 + headerSize;
+
+    for (int track = 0; track < numTracks && end - chunk >= 8; ++track)
+    {
+        auto chunkSize = readBigEndian(chunk + 4, 4);
+        auto* chunkData = chunk + 8;
+
+        if (chunkSize == 0 || chunkSize > static_cast<size_t>(end - chunkData))
+            break;
+
+        if (hasChunkType(chunk, "MTrk"))
+            trackChunks.push_back({ chunkData, chunkSize });
+
+        chunk = chunkData + chunkSize;
+    }
+
+    if (pool != nullptr && trackChunks.size() > 1 && size >= minSizeForThreads)
+    {
+        parseTracksInParallel(ticks, timeline);
+    }
+    else
+    {
+        for (const auto& track : trackChunks)
+            parseTrack(track.data, track.size, ticks, decoder, timeline);
+    }
+
+    timeline.setTempoMap(std::make_shared<const TempoMap>(decoder.tempoChanges, ticks, decoder.timeSignatures));
+
+    // Tracks added one after the other are merged here, so restore global time order
+    timeline.finishCompiling();
+    return true;
+}
+
+//==============================================================================
+void MidiFileParser::parseTracksInParallel(int ticks, MidiTimeline& timeline)
+{
+    auto numTracks = trackChunks.size();
+
+    while (decodedTracks.size() < numTracks)
+        decodedTracks.push_back(std::make_unique<DecodedTrack>());
+
+    runOnAllThreads(pool, static_cast<int>(numTracks), [this, ticks](int index)
+    {
+        auto& track = *decodedTracks[static_cast<size_t>(index)];
+        const auto& chunk = trackChunks[static_cast<size_t>(index)];
+
+        track.timeline.clear();
+        track.decoder.tempoChanges.clear();
+        track.decoder.timeSignatures.clear();
+        parseTrack(chunk.data, chunk.size, ticks, track.decoder, track.timeline);
+    });
+
+    // Tempo and meter changes in track order, as decoding in turn collects them
+    for (size_t i = 0; i < numTracks; ++i)
+    {
+        const auto& trackDecoder = decodedTracks[i]->decoder;
+        decoder.tempoChanges.insert(decoder.tempoChanges.end(), trackDecoder.tempoChanges.begin(), trackDecoder.tempoChanges.end());
+        decoder.timeSignatures.insert(decoder.timeSignatures.end(), trackDecoder.timeSignatures.begin(), trackDecoder.timeSignatures.end());
+    }
+
+    mergeTracks(timeline);
+}
+
+void MidiFileParser::mergeTracks(MidiTimeline& timeline)
+{
+    auto numTracks = trackChunks.size();
+    size_t numEvents = 0;
+    size_t longestTrack = 0;
+
+    // Long messages are numbered across the tracks in track order, the
+    // same as adding the tracks to one timeline in turn
+    std::vector<juce::uint32> firstLongMessage(numTracks);
+
+    for (size_t i = 0; i < numTracks; ++i)
+    {
+        const auto& track = decodedTracks[i]->timeline;
+        jassert(!track.needsSorting);
+
+        firstLongMessage[i] = static_cast<juce::uint32>(timeline.longMessages.size());
+
+        for (const auto& longMessage : track.longMessages)
+            timeline.longMessages.push_back({ longMessage.offset + static_cast<juce::uint32>(timeline.extendedData.size()), longMessage.size });
+
+        timeline.extendedData.insert(timeline.extendedData.end(), track.extendedData.begin(), track.extendedData.end());
+
+        numEvents += track.events.size();
+
+        if (track.events.size() > decodedTracks[longestTrack]->timeline.events.size())
+            longestTrack = i;
+    }
+
+    jassert(timeline.longMessages.size() < (1u << 24));
+
+    runOnAllThreads(pool, static_cast<int>(numTracks), [this, &firstLongMessage](int index)
+    {
+        auto firstIndex = firstLongMessage[static_cast<size_t>(index)];
+        auto& track = decodedTracks[static_cast<size_t>(index)]->timeline;
+
+        if (firstIndex == 0 || track.longMessages.empty())
+            return;
+
+        for (auto& event : track.events)
+        {
+            if (event.numBytes == MidiTimeline::longMessage)
+            {
+                auto longMessageIndex = getLongMessageIndex(event) + firstIndex;
+                event.bytes[0] = static_cast<juce::uint8>(longMessageIndex);
+                event.bytes[1] = static_cast<juce::uint8>(longMessageIndex >> 8);
+                event.bytes[2] = static_cast<juce::uint8>(longMessageIndex >> 16);
+            }
+        }
+    });
+
+    // The positions are split into ranges at events of the longest track,
+    // and each range is merged on its own. Every track is in time order, so
+    // where a range starts in the output only depends on how many events of
+    // each track come before it.
+    const size_t eventsPerRange = 16384;
+    auto numRanges = juce::jlimit<size_t>(1, 256, numEvents / eventsPerRange);
+
+    const auto& longestEvents = decodedTracks[longestTrack]->timeline.events;
+    std::vector<juce::uint32> rangeStarts(numRanges, 0);
+
+    for (size_t range = 1; range < numRanges; ++range)
+        rangeStarts[range] = longestEvents[range * longestEvents.size() / numRanges].position;
+
+    timeline.events.resize(numEvents);
+
+    runOnAllThreads(pool, static_cast<int>(numRanges), [&](int index)
+    {
+        using Event = MidiTimeline::Event;
+        using Run = std::pair<const Event*, const Event*>;
+
+        auto range = static_cast<size_t>(index);
+        auto isBefore = [](const Event& event, juce::uint32 position) { return event.position < position; };
+        auto isEarlier = [](const Event& a, const Event& b) { return a.position < b.position; };
+
+        std::vector<Run> runs;
+        size_t outputIndex = 0;
+        size_t numRangeEvents = 0;
+
+        for (size_t t = 0; t < numTracks; ++t)
+        {
+            const auto* events = decodedTracks[t]->timeline.events.data();
+            const auto* eventsEnd = events + decodedTracks[t]->timeline.events.size();
+
+            auto* begin = range == 0 ? events : std::lower_bound(events, eventsEnd, rangeStarts[range], isBefore);
+            auto* end = range == numRanges - 1 ? eventsEnd : std::lower_bound(events, eventsEnd, rangeStarts[range + 1], isBefore);
+
+            outputIndex += static_cast<size_t>(begin - events);
+            numRangeEvents += static_cast<size_t>(end - begin);
+
+            if (begin != end)
+                runs.push_back({ begin, end });
+        }
+
+        // Neighbouring runs are merged in pairs, level by level. std::merge
+        // takes the first run's event of two at the same position, so the
+        // earlier track's events stay first.
+        std::vector<Event> buffers[2];
+        std::vector<Run> mergedRuns;
+
+        for (int level = 0; runs.size() > 2; ++level)
+        {
+            auto& buffer = buffers[level % 2];
+            buffer.resize(numRangeEvents);
+            auto* output = buffer.data();
+            mergedRuns.clear();
+
+            for (size_t i = 0; i < runs.size(); i += 2)
+            {
+                auto* start = output;
+                output = i + 1 < runs.size() ? std::merge(runs[i].first, runs[i].second, runs[i + 1].first, runs[i + 1].second, output, isEarlier)
+                                             : std::copy(runs[i].first, runs[i].second, output);
+                mergedRuns.push_back({ start, output });
+            }
+
+            runs.swap(mergedRuns);
+        }
+
+        auto* output = timeline.events.data() + outputIndex;
+
+        if (runs.size() == 2)
+            std::merge(runs[0].first, runs[0].second, runs[1].first, runs[1].second, output, isEarlier);
+        else if (runs.size() == 1)
+            std::copy(runs[0].first, runs[0].second, output);
+    });
+}
+
+//==============================================================================
+void MidiFileParser::parseTrack(const juce::uint8* data, size_t size, int ticks, TrackDecoder& decoder, MidiTimeline& timeline)
+{
+    auto* end = data + size;
+    juce::int64 tick = 0;
+    juce::uint8 runningStatus = 0;
+
+    decoder.pendingNoteOns.clear();
+    decoder.heldNotes.clear();
+
+    while (data < end)
+    {
+        juce::uint32 delta;
+        if (!readVariableLength(data, end, delta) || data >= end)
+            break;
+
+        if (delta > 0)
+        {
+            flushNoteOns(tick, decoder, timeline);
+            tick += delta;
+
+            // Past the timeline's range the events could not be placed
+            if (tick > MidiTimeline::maxPosition)
+                break;
+        }
+
+        auto status = *data;
+
+        if (status == 0xff)
+        {
+            // Meta event: only the tempo map takes anything from these.
+            // Like sysex, it cancels the running status
+            juce::uint32 length;
+            runningStatus = 0;
+
+            if (end - data < 2)
+                break;
+
+            auto type = data[1];
+            data += 2;
+
+            if (!readVariableLength(data, end, length) || length > static_cast<size_t>(end - data))
+                break;
+
+            flushNoteOns(tick, decoder, timeline);
+
+            if (type == 0x51 && length >= 3)
+            {
+                // Same arithmetic as TempoMap::createFromMidiFile(), so both paths agree to the bit
+                auto secondsPerQuarterNote = readBigEndian(data, 3) / 1000000.0;
+                if (secondsPerQuarterNote > 0.0)
+                    decoder.tempoChanges.push_back({ static_cast<double>(tick) / ticks, 60.0 / secondsPerQuarterNote });
+            }
+            else if (type == 0x58 && length >= 2)
+            {
+                decoder.timeSignatures.push_back({ static_cast<double>(tick) / ticks, data[0], 1 << juce::jmin(30, static_cast<int>(data[1])) });
+            }
+
+            data += length;
+        }
+        else if (status == 0xf0 || status == 0xf7)
+        {
+            // Sysex is stored as F0 and its data; F7 escape packets only
+            // continue a message split across events and cannot be played alone
+            juce::uint32 length;
+            runningStatus = 0;
+            ++data;
+
+            if (!readVariableLength(data, end, length) || length > static_cast<size_t>(end - data))
+                break;
+
+            flushNoteOns(tick, decoder, timeline);
+
+            if (status == 0xf0)
+            {
+                decoder.sysexData.assign(1, 0xf0);
+                decoder.sysexData.insert(decoder.sysexData.end(), data, data + length);
+                timeline.addEvent(decoder.sysexData.data(), static_cast<int>(decoder.sysexData.size()), tick);
+            }
+
+            data += length;
+        }
+        else
+        {
+            // Channel messages may leave out a status byte repeated from the previous one
+            if (status < 0x80)
+            {
+                if (runningStatus == 0)
+                    break;
+
+                status = runningStatus;
+            }
+            else
+            {
+                ++data;
+
+                if (status < 0xf0)
+                    runningStatus = status;
+            }
+
+            juce::uint8 message[3] = { status, 0, 0 };
+            auto numBytes = getMessageLength(status);
+
+            if (numBytes - 1 > end - data)
+                break;
+
+            for (int i = 1; i < numBytes; ++i)
+                message[i] = *data++;
+
+            addChannelMessage(message, numBytes, tick, decoder, timeline);
+        }
+    }
+
+    flushNoteOns(tick, decoder, timeline);
+}
+
+void MidiFileParser::addChannelMessage(const juce::uint8* message, int numBytes, juce::int64 tick, TrackDecoder& decoder, MidiTimeline& timeline)
+{
+    auto type = message[0] & 0xf0;
+    bool isNoteOn = type == 0x90 && numBytes == 3 && message[2] > 0;
+    bool isNoteOff = numBytes == 3 && (type == 0x80 || (type == 0x90 && message[2] == 0));
+
+    // Note-ons wait for the end of the tick, so the note-offs that follow
+    // them at the same tick can go first
+    if (isNoteOn)
+    {
+        decoder.pendingNoteOns.push_back({ message[0], message[1], message[2] });
+        return;
+    }
+
+    if (isNoteOff)
+    {
+        decoder.heldNotes.noteOff((message[0] & 0x0f) + 1, message[1] & 0x7f);
+        timeline.addEvent(message, numBytes, tick);
+        return;
+    }
+
+    flushNoteOns(tick, decoder, timeline);
+    timeline.addEvent(message, numBytes, tick);
+}
+
+void MidiFileParser::flushNoteOns(juce::int64 tick, TrackDecoder& decoder, MidiTimeline& timeline)
+{
+    for (const auto& noteOn : decoder.pendingNoteOns)
+    {
+        auto channel = (noteOn[0] & 0x0f) + 1;
+        auto noteNumber = noteOn[1] & 0x7f;
+
+        // A key struck again while held is released first
+        if (decoder.heldNotes.isNoteOn(channel, noteNumber))
+        {
+            const juce::uint8 noteOff[3] = { static_cast<juce::uint8>(0x80 | (channel - 1)), static_cast<juce::uint8>(noteNumber), 0 };
+            timeline.addEvent(noteOff, 3, tick);
+        }
+
+        decoder.heldNotes.noteOn(channel, noteNumber);
+        timeline.addEvent(noteOn.data(), 3, tick);
+    }
+
+    decoder.pendingNoteOns.clear();
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "ActiveNotes.h"
+#include "MidiTimeline.h"
+#include "TempoMap.h"
+
+//==============================================================================
+/**
+    MIDI File Parser for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    Single-pass Standard MIDI File reader that decodes the raw bytes (usually
+    a memory-mapped file) straight into a MidiTimeline. Short messages are
+    copied from the file into the packed events and nothing else is
+    allocated per event: there is no juce::MidiFile, no MidiMessageSequence
+    and no MidiMessage on the way.
+
+    The timeline comes out the same as going through juce::MidiFile:
+    - events keep their tick positions; meta events are left out, and the
+      tempo and time signature changes of every track form the TempoMap
+    - within a track, note-offs are moved ahead of note-ons at the same tick
+      that directly precede them
+    - a note-on for a key the track already holds gets a note-off first
+    - a malformed event, or one beyond MidiTimeline::maxPosition, ends its
+      track; the tracks before it are kept
+
+    Given a thread pool, the tracks of a large multi-track file are decoded
+    side by side, each into its own timeline, and then merged by position
+    ranges in parallel. Events at the same position keep the order of
+    their tracks, so the result is identical, byte for byte, to decoding
+    the tracks one after the other.
+*/
+class MidiFileParser
+{
+public:
+    //==============================================================================
+    MidiFileParser();
+    ~MidiFileParser();
+
+    //==============================================================================
+    /** Parse a Standard MIDI File (format 0, 1 or 2) into a tick-based timeline
+        @param data         File content, e.g. a juce::MemoryMappedFile
+        @param size         Size of the content in bytes
+        @param timeline     Timeline to fill; left untouched if the data is
+                            not a MIDI file
+        @returns false if the data is not a MIDI file
+    */
+    bool parse(const void* data, size_t size, MidiTimeline& timeline);
+
+    /** Decode and merge the tracks of large multi-track files on a pool's
+        threads as well as the caller's
+        @param threadPool   Pool to use, or nullptr (the default) to parse
+                            on the caller's thread only
+    */
+    void setThreadPool(juce::ThreadPool* threadPool) noexcept { pool = threadPool; }
+
+    /** Resolution used for SMPTE-timed files, which are not supported */
+    static constexpr int defaultTicksPerQuarterNote = 480;
+
+    /** Files smaller than this are parsed on the caller's thread, as handing
+        their tracks to other threads would cost more than it saves
+    */
+    static constexpr size_t minSizeForThreads = 64 * 1024;
+
+private:
+    //==============================================================================
+    /** State of decoding tracks, reused between tracks and files so parsing
+        does not allocate per event
+    */
+    struct TrackDecoder
+    {
+        std::vector<std::array<juce::uint8, 3>> pendingNoteOns;
+        std::vector<juce::uint8> sysexData;
+        std::vector<TempoMap::TempoChange> tempoChanges;
+        std::vector<TempoMap::TimeSignatureChange> timeSignatures;
+        ActiveNotes heldNotes;
+    };
+
+    /** A track decoded on its own, before merging */
+    struct DecodedTrack
+    {
+        TrackDecoder decoder;
+        MidiTimeline timeline;
+    };
+
+    /** Location of an MTrk chunk's data */
+    struct TrackChunk
+    {
+        const juce::uint8* data;
+        size_t size;
+    };
+
+    //==============================================================================
+    /** Decode the tracks into their own timelines on all threads, then merge them */
+    void parseTracksInParallel(int ticks, MidiTimeline& timeline);
+
+    /** Merge the decoded tracks into the timeline in time order */
+    void mergeTracks(MidiTimeline& timeline);
+
+    /** Decode one MTrk chunk into the timeline */
+    static void parseTrack(const juce::uint8* data, size_t size, int ticks, TrackDecoder& decoder, MidiTimeline& timeline);
+
+    /** Add a channel message, inserting the note-off of a repeated note-on */
+    static void addChannelMessage(const juce::uint8* message, int numBytes, juce::int64 tick, TrackDecoder& decoder, MidiTimeline& timeline);
+
+    /** Add the note-ons held back at the current tick */
+    static void flushNoteOns(juce::int64 tick, TrackDecoder& decoder, MidiTimeline& timeline);
+
+    //==============================================================================
+    juce::ThreadPool* pool = nullptr;
+    TrackDecoder decoder;
+    std::vector<TrackChunk> trackChunks;
+    std::vector<std::unique_ptr<DecodedTrack>> decodedTracks;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiFileParser)
+};
@@ -0,0 +1,330 @@
+#include "MidiFolderWatcher.h"
+
+#if JUCE_LINUX
+ #include <sys/inotify.h>
+ #include <sys/eventfd.h>
+ #include <poll.h>
+ #include <unistd.h>
+ #include <cerrno>
+
+//==============================================================================
+/** inotify backend: reacts to files that finished being written or were moved in */
+class MidiFolderWatcher::InotifyNotifier : public MidiFolderWatcher::ChangeNotifier
+{
+public:
+    InotifyNotifier()
+        : inotifyFd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+          wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    {
+    }
+
+    ~InotifyNotifier() override
+    {
+        if (inotifyFd >= 0)
+            close(inotifyFd);
+
+        if (wakeFd >= 0)
+            close(wakeFd);
+    }
+
+    bool isValid() const { return inotifyFd >= 0 && wakeFd >= 0; }
+
+    bool watch(const juce::File& folder) override
+    {
+        if (watchDescriptor >= 0)
+        {
+            inotify_rm_watch(inotifyFd, watchDescriptor);
+            watchDescriptor = -1;
+        }
+
+        watchDescriptor = inotify_add_watch(inotifyFd, folder.getFullPathName().toRawUTF8(),
+                                            IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM);
+        return watchDescriptor >= 0;
+    }
+
+    bool waitForChange(int timeoutMs) override
+    {
+        pollfd fds[2] = { { inotifyFd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+
+        if (poll(fds, 2, timeoutMs) <= 0)
+            return false;
+
+        if ((fds[1].revents & POLLIN) != 0)
+        {
+            uint64_t value;
+            juce::ignoreUnused(read(wakeFd, &value, sizeof(value)));
+        }
+
+        return (fds[0].revents & POLLIN) != 0 && readEvents();
+    }
+
+    void wake() override
+    {
+        uint64_t value = 1;
+        juce::ignoreUnused(write(wakeFd, &value, sizeof(value)));
+    }
+
+private:
+    /** Drain pending events and report whether any of them concerns a MIDI file */
+    bool readEvents()
+    {
+        alignas(inotify_event) char buffer[4096];
+        bool relevant = false;
+
+        for (;;)
+        {
+            auto numRead = read(inotifyFd, buffer, sizeof(buffer));
+            if (numRead <= 0)
+                break;
+
+            for (char* ptr = buffer; ptr < buffer + numRead;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+
+                if ((event->mask & IN_Q_OVERFLOW) != 0)
+                    relevant = true; // Events were lost, rescan to be safe
+                else if ((event->mask & IN_ISDIR) == 0 && event->len > 0)
+                    relevant |= isMidiFileName(event->name);
+
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        return relevant;
+    }
+
+    static bool isMidiFileName(const char* name)
+    {
+        // The same files scanFolder() lists
+        for (const auto& wildcard : juce::StringArray::fromTokens(midiFileWildcard, ";", {}))
+            if (juce::String(name).matchesWildcard(wildcard, false))
+                return true;
+
+        return false;
+    }
+
+    int inotifyFd;
+    int wakeFd;
+    int watchDescriptor = -1;
+};
+#endif
+
+//==============================================================================
+MidiFolderWatcher::MidiFolderWatcher(TrackExchange& exchange)
+    : juce::Thread("AI Band Folder Watcher"),
+      trackExchange(exchange),
+      changeNotifier(createChangeNotifier())
+{
+    midiManager.initialize();
+}
+
+MidiFolderWatcher::~MidiFolderWatcher()
+{
+    stop();
+}
+
+//==============================================================================
+void MidiFolderWatcher::setFolder(const juce::String& folderPath)
+{
+    {
+        const juce::ScopedLock lock(folderLock);
+        monitoredFolder = folderPath;
+    }
+
+    if (folderPath.isEmpty())
+        return;
+
+    if (!isThreadRunning())
+        startThread();
+    else
+        wakeUp(); // Watch and scan the new folder straight away
+}
+
+juce::String MidiFolderWatcher::getFolder() const
+{
+    const juce::ScopedLock lock(folderLock);
+    return monitoredFolder;
+}
+
+void MidiFolderWatcher::stop()
+{
+    signalThreadShouldExit();
+    wakeUp();
+    stopThread(2000);
+}
+
+//==============================================================================
+MidiFolderWatcher::ReloadStatistics MidiFolderWatcher::getReloadStatistics() const noexcept
+{
+    ReloadStatistics statistics;
+    statistics.performed = numReloadsPerformed.load();
+    statistics.skipped = numReloadsSkipped.load();
+    return statistics;
+}
+
+//==============================================================================
+// Private methods
+
+std::unique_ptr<MidiFolderWatcher::ChangeNotifier> MidiFolderWatcher::createChangeNotifier()
+{
+   #if JUCE_LINUX
+    auto notifier = std::make_unique<InotifyNotifier>();
+    if (notifier->isValid())
+        return notifier;
+   #endif
+
+    return nullptr;
+}
+
+void MidiFolderWatcher::run()
+{
+    juce::String watchedFolder;
+    bool needsScan = true;
+
+    while (!threadShouldExit())
+    {
+        trackExchange.collectGarbage();
+
+        // (Re)attach notifications whenever the monitored folder changes
+        auto folderPath = getFolder();
+        if (folderPath != watchedFolder)
+        {
+            watchedFolder = folderPath;
+            notificationsActive = changeNotifier != nullptr
+                                  && folderPath.isNotEmpty()
+                                  && changeNotifier->watch(juce::File(folderPath));
+            needsScan = true;
+        }
+
+        if (needsScan)
+            scanFolder();
+
+        if (notificationsActive)
+        {
+            // Sleep until a MIDI file is written or moved into the folder;
+            // the timeout only bounds how long retired snapshots stay around
+            needsScan = changeNotifier->waitForChange(pollIntervalMs);
+        }
+        else
+        {
+            wait(pollIntervalMs);
+            needsScan = true;
+        }
+    }
+}
+
+void MidiFolderWatcher::wakeUp()
+{
+    notify();
+
+    if (changeNotifier != nullptr)
+        changeNotifier->wake();
+}
+
+void MidiFolderWatcher::scanFolder()
+{
+    auto folderPath = getFolder();
+    if (folderPath.isEmpty())
+        return;
+
+    juce::File folder(folderPath);
+    if (!folder.exists() || !folder.isDirectory())
+        return;
+
+    // Look for one MIDI file per instrument; the name says which
+    // ("bass_line.mid", "drum_pattern.mid", "keys.mid", "guitar_solo.mid")
+    static const char* const fileKeywords[TrackExchange::numNamedTracks] = { "bass", "drum", "key", "guitar" };
+
+    auto files = folder.findChildFiles(juce::File::findFiles, false, midiFileWildcard);
+    pruneSnapshots(files);
+
+    juce::File trackFiles[TrackExchange::numNamedTracks];
+    for (auto& file : files)
+    {
+        auto filename = file.getFileName().toLowerCase();
+
+        for (int track = 0; track < TrackExchange::numNamedTracks; ++track)
+        {
+            if (filename.contains(fileKeywords[track]))
+            {
+                trackFiles[track] = file;
+                break;
+            }
+        }
+    }
+
+    // Parse only what changed; unchanged tracks stay shared with the playing snapshot
+    TrackExchange::SharedTrackList newTracks(TrackExchange::numNamedTracks);
+    CompiledTrackCache compiledTracks(CompiledTrackCache::getFolderFor(folder));
+    bool anyLoaded = false;
+
+    for (int track = 0; track < TrackExchange::numNamedTracks; ++track)
+    {
+        if (trackFiles[track] != juce::File())
+            anyLoaded |= loadIfChanged(trackFiles[track], loadedPaths[track], compiledTracks,
+                                       newTracks[static_cast<size_t>(track)]);
+    }
+
+    if (anyLoaded)
+    {
+        trackExchange.publish(std::move(newTracks));
+        ++numLoads;
+    }
+}
+
+bool MidiFolderWatcher::loadIfChanged(const juce::File& file, juce::String& loadedPath,
+                                      const CompiledTrackCache& compiledTracks,
+                                      std::shared_ptr<const MidiTimeline>& timeline)
+{
+    auto path = file.getFullPathName();
+
+    FileSnapshot snapshot;
+    snapshot.size = file.getSize();
+    snapshot.modificationTime = file.getLastModificationTime().toMilliseconds();
+
+    auto existing = snapshotIndex.find(path);
+    bool isLoaded = path == loadedPath && existing != snapshotIndex.end();
+
+    // Cheap check first: same size and timestamp means the file was not touched
+    if (isLoaded && existing->second.size == snapshot.size
+                 && existing->second.modificationTime == snapshot.modificationTime)
+    {
+        ++numReloadsSkipped;
+        return false;
+    }
+
+    juce::MemoryBlock data;
+    if (!file.loadFileAsData(data))
+        return false;
+
+    // Rewritten with identical content (e.g. the backend regenerated the same part)
+    snapshot.contentHash = TimelineCache::hashContent(data.getData(), data.getSize());
+    if (isLoaded && existing->second.contentHash == snapshot.contentHash)
+    {
+        existing->second = snapshot;
+        ++numReloadsSkipped;
+        return false;
+    }
+
+    // A file that fails to parse is not indexed, so it is retried on the next scan
+    timeline = timelineCache->getTimeline(data.getData(), data.getSize(), midiManager, &compiledTracks);
+    if (timeline == nullptr)
+        return false;
+
+    snapshotIndex[path] = snapshot;
+    loadedPath = path;
+    ++numReloadsPerformed;
+    return true;
+}
+
+void MidiFolderWatcher::pruneSnapshots(const juce::Array<juce::File>& files)
+{
+    for (auto it = snapshotIndex.begin(); it != snapshotIndex.end();)
+    {
+        bool stillPresent = false;
+        for (auto& file : files)
+            stillPresent |= file.getFullPathName() == it->first;
+
+        it = stillPresent ? std::next(it) : snapshotIndex.erase(it);
+    }
+}
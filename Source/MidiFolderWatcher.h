@@ -0,0 +1,165 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <map>
+#include "MidiManager.h"
+#include "TimelineCache.h"
+#include "TrackExchange.h"
+
+//==============================================================================
+/**
+    MIDI Folder Watcher for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    Background service that monitors the ai-band-backend output folder and
+    loads new bass, drum, keys and guitar files on its own thread (the
+    instrument is taken from the file name). Loaded tracks are
+    published through a TrackExchange, so the audio thread never blocks,
+    never touches the file system and never frees memory; the watcher also
+    reclaims the snapshots the audio thread has finished with.
+
+    On Linux the folder is watched with inotify (IN_CLOSE_WRITE / IN_MOVED_TO),
+    so a finished file is picked up within milliseconds and nothing is scanned
+    while the folder is idle. Other platforms, or folders where inotify is not
+    available, fall back to scanning every pollIntervalMs.
+
+    Every scan is checked against a snapshot index of the folder (size,
+    modification time and content hash per path). A file is only parsed and
+    published when it is new or its content really changed, so rescans and
+    files rewritten with identical data never restart playback.
+
+    Parsed files come from the process-wide TimelineCache, so watchers of
+    several plugin instances on the same folder parse each file once.
+    Compiled tracks are also kept on disk in a CompiledTrackCache folder
+    next to the monitored one, so a new session starts without parsing the
+    files it has seen before.
+*/
+class MidiFolderWatcher : private juce::Thread
+{
+public:
+    //==============================================================================
+    /** Counters of the reload decisions taken by the change detection */
+    struct ReloadStatistics
+    {
+        int performed = 0;  /**< Files parsed because they were new or modified */
+        int skipped = 0;    /**< Files left alone because they were unchanged */
+    };
+
+    //==============================================================================
+    /** Create a watcher that publishes the tracks it loads to an exchange */
+    explicit MidiFolderWatcher(TrackExchange& exchange);
+    ~MidiFolderWatcher() override;
+
+    //==============================================================================
+    /** Set the folder to monitor and start watching it
+        @param folderPath   Folder to monitor, or an empty string to stop
+    */
+    void setFolder(const juce::String& folderPath);
+
+    /** Get the folder currently being monitored */
+    juce::String getFolder() const;
+
+    /** Stop the background thread */
+    void stop();
+
+    //==============================================================================
+    /** Get the number of track sets loaded since construction */
+    int getNumLoads() const noexcept { return numLoads.load(); }
+
+    /** Get the number of file reloads performed and skipped since construction */
+    ReloadStatistics getReloadStatistics() const noexcept;
+
+    /** Check if the folder is watched with change notifications rather than polling */
+    bool usesFileNotifications() const noexcept { return notificationsActive.load(); }
+
+    /** Interval between folder scans in milliseconds when polling */
+    static constexpr int pollIntervalMs = 500;
+
+    /** Files the folder is scanned and watched for */
+    static constexpr const char* midiFileWildcard = "*.mid;*.midi";
+
+private:
+    //==============================================================================
+    /** Platform file change notification backend */
+    class ChangeNotifier
+    {
+    public:
+        virtual ~ChangeNotifier() = default;
+
+        /** Start watching a folder (replacing any previous one)
+            @returns false if notifications are not available for it
+        */
+        virtual bool watch(const juce::File& folder) = 0;
+
+        /** Block until a MIDI file in the folder changes, wake() is called or the timeout expires
+            @returns true if the folder needs to be rescanned
+        */
+        virtual bool waitForChange(int timeoutMs) = 0;
+
+        /** Interrupt waitForChange() from another thread */
+        virtual void wake() = 0;
+    };
+
+    class InotifyNotifier;
+
+    /** What the snapshot index remembers about a file */
+    struct FileSnapshot
+    {
+        juce::int64 size = 0;
+        juce::int64 modificationTime = 0;
+        juce::uint64 contentHash = 0;
+    };
+
+    /** Create the notifier for this platform, or nullptr to poll */
+    static std::unique_ptr<ChangeNotifier> createChangeNotifier();
+
+    //==============================================================================
+    void run() override;
+
+    /** Interrupt the thread's wait so it re-reads the folder or exits */
+    void wakeUp();
+
+    /** Scan the folder and publish any instrument files found */
+    void scanFolder();
+
+    /** Get a file's timeline unless it is the one already loaded and unchanged
+        @param file             File chosen for the track
+        @param loadedPath       Path of the file currently loaded for the track; updated on success
+        @param compiledTracks   On-disk cache of the folder's compiled tracks
+        @param timeline         Receives the parsed (or cached) timeline
+        @returns true if the timeline was loaded and should be published
+    */
+    bool loadIfChanged(const juce::File& file, juce::String& loadedPath,
+                       const CompiledTrackCache& compiledTracks,
+                       std::shared_ptr<const MidiTimeline>& timeline);
+
+    /** Drop index entries for files that are no longer in the folder */
+    void pruneSnapshots(const juce::Array<juce::File>& files);
+
+    //==============================================================================
+    TrackExchange& trackExchange;
+    MidiManager midiManager;
+    juce::SharedResourcePointer<TimelineCache> timelineCache;
+
+    juce::CriticalSection folderLock;
+    juce::String monitoredFolder;
+
+    std::unique_ptr<ChangeNotifier> changeNotifier;
+    std::atomic<bool> notificationsActive { false };
+
+    std::atomic<int> numLoads { 0 };
+
+    // Change detection (watcher thread only, except for the counters)
+    std::map<juce::String, FileSnapshot> snapshotIndex;
+    juce::String loadedPaths[TrackExchange::numNamedTracks];
+    std::atomic<int> numReloadsPerformed { 0 };
+    std::atomic<int> numReloadsSkipped { 0 };
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiFolderWatcher)
+};
@@ -5,6 +5,7 @@ MidiManager::MidiManager()
     : currentSampleRate(44100.0),
       currentBlockSize(512)
 {
+    parser.setThreadPool(parsingThreads.get());
 }
 
 MidiManager::~MidiManager()
@@ -31,9 +32,45 @@ void MidiManager::releaseResources()
 //==============================================================================
 bool MidiManager::loadMidiFile(const juce::String& filePath, juce::MidiBuffer& buffer)
 {
-    juce::File midiFile(filePath);
+    juce::MidiFile loadedMidiFile;
+    if (!readMidiFile(filePath, loadedMidiFile))
+        return false;
+    
+    // Convert MidiFile to MidiBuffer
+    buffer.clear();
+    convertMidiFileToBuffer(loadedMidiFile, buffer);
+    
+    DBG("Successfully loaded MIDI file: " << filePath << 
+        " Duration: " << getMidiDurationInBeats(buffer) << " beats");
+    
+    return true;
+}
+
+bool MidiManager::loadMidiFromMemory(const void* data, size_t size, juce::MidiBuffer& buffer)
+{
+    if (data == nullptr || size == 0)
+        return false;
+    
+    juce::MemoryInputStream stream(data, size, false);
+    juce::MidiFile midiFile;
+    
+    if (!midiFile.readFrom(stream))
+    {
+        DBG("Failed to read MIDI data from memory");
+        return false;
+    }
+    
+    buffer.clear();
+    convertMidiFileToBuffer(midiFile, buffer);
+    
+    return true;
+}
+
+bool MidiManager::loadMidiFile(const juce::String& filePath, MidiTimeline& timeline)
+{
+    juce::File file(filePath);
     
-    if (!midiFile.exists())
+    if (!file.exists())
     {
         DBG("MIDI file does not exist: " << filePath);
         return false;
@@ -45,65 +82,80 @@ bool MidiManager::loadMidiFile(const juce::String& filePath, juce::MidiBuffer& b
         return false;
     }
     
-    juce::FileInputStream stream(midiFile);
-    if (stream.failedToOpen())
+    // Parsed in place from the page cache; nothing is copied before decoding
+    juce::MemoryMappedFile mappedFile(file, juce::MemoryMappedFile::readOnly);
+    
+    if (mappedFile.getData() == nullptr)
     {
-        DBG("Failed to open MIDI file: " << filePath);
+        DBG("Failed to map MIDI file: " << filePath);
         return false;
     }
     
-    juce::MidiFile loadedMidiFile;
-    if (!loadedMidiFile.readFrom(stream))
+    const juce::ScopedLock lock(parserLock);
+    
+    if (!parser.parse(mappedFile.getData(), mappedFile.getSize(), timeline))
     {
         DBG("Failed to read MIDI file: " << filePath);
         return false;
     }
     
-    // Convert MidiFile to MidiBuffer
-    buffer.clear();
-    convertMidiFileToBuffer(loadedMidiFile, buffer);
-    
     DBG("Successfully loaded MIDI file: " << filePath << 
-        " Duration: " << getMidiDurationInBeats(buffer) << " beats");
+        " Duration: " << timeline.getLengthInBeats() << " beats");
     
     return true;
 }
 
-bool MidiManager::loadMidiFromMemory(const void* data, size_t size, juce::MidiBuffer& buffer)
+bool MidiManager::loadMidiFromMemory(const void* data, size_t size, MidiTimeline& timeline)
 {
     if (data == nullptr || size == 0)
         return false;
     
-    juce::MemoryInputStream stream(data, size, false);
-    juce::MidiFile midiFile;
+    const juce::ScopedLock lock(parserLock);
     
-    if (!midiFile.readFrom(stream))
+    if (!parser.parse(data, size, timeline))
     {
         DBG("Failed to read MIDI data from memory");
         return false;
     }
     
-    buffer.clear();
-    convertMidiFileToBuffer(midiFile, buffer);
-    
     return true;
 }
 
 bool MidiManager::saveMidiFile(const juce::MidiBuffer& buffer, const juce::String& filePath)
 {
+    return saveMidiFile(buffer, filePath, TempoMap());
+}
+
+bool MidiManager::saveMidiFile(const juce::MidiBuffer& buffer, const juce::String& filePath, const TempoMap& tempoMap)
+{
+    const auto ticks = tempoMap.getTicksPerQuarterNote();
+    
     juce::MidiFile midiFile;
-    midiFile.setTicksPerQuarterNote(480); // Standard MIDI resolution
+    midiFile.setTicksPerQuarterNote(ticks);
     
-    // Create a single track from the buffer
+    // Create a single track from the buffer, starting with the tempo changes
+    // so the ticks map back to the same times when the file is read
     juce::MidiMessageSequence track;
     
+    for (int i = 0; i < tempoMap.getNumSegments(); ++i)
+    {
+        const auto& segment = tempoMap.getSegment(i);
+        track.addEvent(juce::MidiMessage::tempoMetaEvent(juce::roundToInt(segment.secondsPerBeat * 1.0e6)),
+                       segment.startBeat * ticks);
+    }
+    
+    // The buffer is in time order, so the cursor makes each conversion O(1)
+    TempoMap::Cursor cursor;
+    
     for (auto it = buffer.cbegin(); it != buffer.cend(); ++it)
     {
         auto metadata = (*it);
-        double timeInSeconds = metadata.samplePosition / currentSampleRate;
-        track.addEvent(metadata.getMessage(), timeInSeconds);
+        auto message = metadata.getMessage();   // time stamped with the sample position
+        message.setTimeStamp(tempoMap.samplesToBeats(metadata.samplePosition, currentSampleRate, cursor) * ticks);
+        track.addEvent(message);
     }
     
+    track.updateMatchedPairs();
     midiFile.addTrack(track);
     
     // Save to file
@@ -192,6 +244,16 @@ double MidiManager::samplesToBeats(int samples, double tempo) const
     return timeInSeconds / secondsPerBeat;
 }
 
+int MidiManager::beatsToSamples(double beats, const TempoMap& tempoMap) const
+{
+    return static_cast<int>(tempoMap.beatsToSamples(beats, currentSampleRate));
+}
+
+double MidiManager::samplesToBeats(int samples, const TempoMap& tempoMap) const
+{
+    return tempoMap.samplesToBeats(samples, currentSampleRate);
+}
+
 //==============================================================================
 bool MidiManager::isValidMidiFile(const juce::String& filePath)
 {
@@ -216,9 +278,9 @@ void MidiManager::convertMidiFileToBuffer(const juce::MidiFile& midiFile, juce::
 {
     buffer.clear();
     
-    int ticksPerBeat = midiFile.getTimeFormat();
-    if (ticksPerBeat <= 0)
-        ticksPerBeat = 480; // Default resolution
+    // One map for the whole file: in type 1 files the tempo events are
+    // usually only in track 0, but they time the note tracks as well
+    auto tempoMap = TempoMap::createFromMidiFile(midiFile);
     
     // Process each track
     for (int trackIndex = 0; trackIndex < midiFile.getNumTracks(); ++trackIndex)
@@ -227,8 +289,9 @@ void MidiManager::convertMidiFileToBuffer(const juce::MidiFile& midiFile, juce::
         if (track == nullptr)
             continue;
         
-        // Build tempo map for this file
-        auto tempoMap = buildTempoMap(*track, ticksPerBeat);
+        // Events of a track are in time order, so its cursor only ever moves
+        // forward through the map
+        TempoMap::Cursor tempoCursor;
         
         // Convert each event in the track
         for (int eventIndex = 0; eventIndex < track->getNumEvents(); ++eventIndex)
@@ -244,7 +307,7 @@ void MidiManager::convertMidiFileToBuffer(const juce::MidiFile& midiFile, juce::
                 continue;
             
             // Convert tick time to seconds, then to samples
-            double timeInSeconds = ticksToSeconds(message.getTimeStamp(), tempoMap, ticksPerBeat);
+            double timeInSeconds = tempoMap->ticksToSeconds(message.getTimeStamp(), tempoCursor);
             timeInSeconds *= tempoScale; // Apply tempo scaling
             
             int samplePosition = static_cast<int>(timeInSeconds * currentSampleRate);
@@ -255,73 +318,78 @@ void MidiManager::convertMidiFileToBuffer(const juce::MidiFile& midiFile, juce::
     }
 }
 
-std::vector<MidiManager::TempoEvent> MidiManager::buildTempoMap(const juce::MidiMessageSequence& track, int ticksPerBeat)
+void MidiManager::convertMidiFileToTimeline(const juce::MidiFile& midiFile, MidiTimeline& timeline)
 {
-    std::vector<TempoEvent> tempoMap;
-    
-    // Add default tempo at start
-    TempoEvent defaultTempo;
-    defaultTempo.tick = 0;
-    defaultTempo.tempo = 120.0; // Default 120 BPM
-    defaultTempo.timeInSeconds = 0.0;
-    tempoMap.push_back(defaultTempo);
+    timeline.clear();
+    timeline.setTicksPerQuarterNote(getTicksPerQuarterNote(midiFile));
+    timeline.setTempoMap(TempoMap::createFromMidiFile(midiFile));
     
-    // Scan for tempo change events
-    for (int i = 0; i < track.getNumEvents(); ++i)
+    // Event timestamps are still in ticks straight after MidiFile::readFrom,
+    // so they are copied as-is; no tempo or sample rate is involved here
+    for (int trackIndex = 0; trackIndex < midiFile.getNumTracks(); ++trackIndex)
     {
-        auto* event = track.getEventPointer(i);
-        if (event == nullptr)
+        const auto* track = midiFile.getTrack(trackIndex);
+        if (track == nullptr)
             continue;
         
-        auto message = event->message;
-        if (message.isTempoMetaEvent())
+        for (int eventIndex = 0; eventIndex < track->getNumEvents(); ++eventIndex)
         {
-            TempoEvent tempoEvent;
-            tempoEvent.tick = message.getTimeStamp();
-            tempoEvent.tempo = message.getTempoSecondsPerQuarterNote() > 0 ? 
-                              60.0 / message.getTempoSecondsPerQuarterNote() : 120.0;
+            auto* event = track->getEventPointer(eventIndex);
+            if (event == nullptr)
+                continue;
             
-            // Calculate time in seconds based on previous tempo
-            if (!tempoMap.empty())
-            {
-                auto& lastTempo = tempoMap.back();
-                int tickDelta = tempoEvent.tick - lastTempo.tick;
-                double beatDelta = static_cast<double>(tickDelta) / ticksPerBeat;
-                double timeDelta = beatDelta * (60.0 / lastTempo.tempo);
-                tempoEvent.timeInSeconds = lastTempo.timeInSeconds + timeDelta;
-            }
-            else
-            {
-                tempoEvent.timeInSeconds = 0.0;
-            }
+            const auto& message = event->message;
             
-            tempoMap.push_back(tempoEvent);
+            // Meta events (tempo, time signature, track names) are not sent to the output
+            if (message.isMetaEvent())
+                continue;
+            
+            auto tick = static_cast<juce::int64>(std::llround(message.getTimeStamp()));
+            timeline.addEvent(message.getRawData(), message.getRawDataSize(), juce::jmax((juce::int64) 0, tick));
         }
     }
     
-    return tempoMap;
+    // Tracks are merged here, so restore global time order
+    timeline.finishCompiling();
 }
 
-double MidiManager::ticksToSeconds(int ticks, const std::vector<TempoEvent>& tempoMap, int ticksPerBeat) const
+bool MidiManager::readMidiFile(const juce::String& filePath, juce::MidiFile& midiFile)
 {
-    if (tempoMap.empty())
-        return 0.0;
+    juce::File file(filePath);
     
-    // Find the tempo event that applies to this tick position
-    TempoEvent currentTempo = tempoMap[0];
+    if (!file.exists())
+    {
+        DBG("MIDI file does not exist: " << filePath);
+        return false;
+    }
     
-    for (const auto& tempoEvent : tempoMap)
+    if (!isValidMidiFile(filePath))
     {
-        if (tempoEvent.tick <= ticks)
-            currentTempo = tempoEvent;
-        else
-            break;
+        DBG("Invalid MIDI file: " << filePath);
+        return false;
     }
     
-    // Calculate time based on the current tempo
-    int tickDelta = ticks - currentTempo.tick;
-    double beatDelta = static_cast<double>(tickDelta) / ticksPerBeat;
-    double timeDelta = beatDelta * (60.0 / currentTempo.tempo);
+    juce::FileInputStream stream(file);
+    if (stream.failedToOpen())
+    {
+        DBG("Failed to open MIDI file: " << filePath);
+        return false;
+    }
+    
+    if (!midiFile.readFrom(stream))
+    {
+        DBG("Failed to read MIDI file: " << filePath);
+        return false;
+    }
+    
+    return true;
+}
+
+int MidiManager::getTicksPerQuarterNote(const juce::MidiFile& midiFile)
+{
+    int ticksPerBeat = midiFile.getTimeFormat();
+    if (ticksPerBeat <= 0)
+        ticksPerBeat = 480; // Default resolution (SMPTE timing is not supported)
     
-    return currentTempo.timeInSeconds + timeDelta;
+    return ticksPerBeat;
 }
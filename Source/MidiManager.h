@@ -1,6 +1,9 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MidiFileParser.h"
+#include "MidiTimeline.h"
+#include "TempoMap.h"
 
 //==============================================================================
 /**
@@ -13,7 +16,15 @@
     
     This class handles loading, parsing, and managing MIDI files generated by
     the ai-band-backend. It provides functionality to load MIDI files into
-    MidiBuffer objects for real-time playback.
+    MidiBuffer objects, or into tick-based MidiTimeline objects for real-time
+    playback. Timelines keep the file's TempoMap so the tempo changes of a
+    track stay available after loading.
+    
+    Timelines are decoded by a MidiFileParser straight from the file's bytes:
+    a memory-mapped file when loading from disk, the caller's buffer when
+    loading from memory. One parser is kept for every load, so its decoding
+    buffers are reused. The tracks of large multi-track files are decoded
+    on a thread pool shared by every MidiManager in the process.
 */
 class MidiManager
 {
@@ -48,13 +59,51 @@ public:
     */
     bool loadMidiFromMemory(const void* data, size_t size, juce::MidiBuffer& buffer);
     
+    /** Load a MIDI file into a playback timeline in musical time
+        Event positions are kept as MIDI ticks, so the result does not depend
+        on the sample rate or on any tempo assumed at load time. The file is
+        memory-mapped and parsed in place.
+        @param filePath     Path to the MIDI file
+        @param timeline     Timeline to store the compiled events
+        @returns true if successful
+    */
+    bool loadMidiFile(const juce::String& filePath, MidiTimeline& timeline);
+    
+    /** Load MIDI data from memory into a playback timeline in musical time
+        @param data         MIDI file data in memory
+        @param size         Size of the data in bytes
+        @param timeline     Timeline to store the compiled events
+        @returns true if successful
+    */
+    bool loadMidiFromMemory(const void* data, size_t size, MidiTimeline& timeline);
+    
+    /** Convert an already parsed juce::MidiFile (e.g. one built in memory) to
+        a playback timeline in musical time
+        @param midiFile     Source MIDI file, with timestamps still in ticks
+        @param timeline     Destination timeline
+    */
+    void convertMidiFileToTimeline(const juce::MidiFile& midiFile, MidiTimeline& timeline);
+    
     /** Save a MidiBuffer to a MIDI file
+        Sample positions are converted at the current sample rate and the
+        default tempo of 120 BPM.
         @param buffer       Buffer containing MIDI data
         @param filePath     Output file path
         @returns true if successful
     */
     bool saveMidiFile(const juce::MidiBuffer& buffer, const juce::String& filePath);
     
+    /** Save a MidiBuffer to a MIDI file, following the tempo it was played at
+        Sample positions are converted to ticks through the tempo map, whose
+        tempo changes are written to the file as well.
+        @param buffer       Buffer containing MIDI data
+        @param filePath     Output file path
+        @param tempoMap     Tempo of the buffer from its first sample; its tick
+                            resolution is used for the file
+        @returns true if successful
+    */
+    bool saveMidiFile(const juce::MidiBuffer& buffer, const juce::String& filePath, const TempoMap& tempoMap);
+    
     //==============================================================================
     /** Get the duration of loaded MIDI data in beats
         @param buffer       Buffer to analyze
@@ -91,6 +140,20 @@ public:
     */
     double samplesToBeats(int samples, double tempo) const;
     
+    /** Convert beats to samples following the tempo changes of a track
+        @param beats        Beat position
+        @param tempoMap     Tempo map, e.g. from MidiTimeline::getTempoMap()
+        @returns sample position
+    */
+    int beatsToSamples(double beats, const TempoMap& tempoMap) const;
+    
+    /** Convert samples to beats following the tempo changes of a track
+        @param samples      Sample position
+        @param tempoMap     Tempo map, e.g. from MidiTimeline::getTempoMap()
+        @returns beat position
+    */
+    double samplesToBeats(int samples, const TempoMap& tempoMap) const;
+    
     //==============================================================================
     /** Check if a file is a valid MIDI file
         @param filePath     Path to check
@@ -106,30 +169,33 @@ private:
     double currentSampleRate;
     int currentBlockSize;
     
+    // One thread per core, shared by every MidiManager in the process
+    juce::SharedResourcePointer<juce::ThreadPool> parsingThreads;
+    
+    // Kept between loads so its decoding buffers are reused; the lock
+    // serialises loads from different threads
+    MidiFileParser parser;
+    juce::CriticalSection parserLock;
+    
     //==============================================================================
     /** Convert a MidiFile to a MidiBuffer with proper timing
+        Every track is timed by one tempo map built from the tempo events of
+        the whole file.
         @param midiFile     Source MIDI file
         @param buffer       Destination buffer
         @param tempoScale   Tempo scaling factor (1.0 = normal speed)
     */
     void convertMidiFileToBuffer(const juce::MidiFile& midiFile, juce::MidiBuffer& buffer, double tempoScale = 1.0);
     
-    /** Process tempo events and calculate timing
-        @param track        MIDI track to process
-        @param ticksPerBeat MIDI ticks per quarter note
-        @returns tempo map for timing calculations
+    /** Open and parse a MIDI file from disk
+        @param filePath     Path to the MIDI file
+        @param midiFile     Parsed result
+        @returns true if successful
     */
-    struct TempoEvent
-    {
-        int tick;
-        double tempo;
-        double timeInSeconds;
-    };
-    
-    std::vector<TempoEvent> buildTempoMap(const juce::MidiMessageSequence& track, int ticksPerBeat);
+    bool readMidiFile(const juce::String& filePath, juce::MidiFile& midiFile);
     
-    /** Convert MIDI tick time to seconds using tempo map */
-    double ticksToSeconds(int ticks, const std::vector<TempoEvent>& tempoMap, int ticksPerBeat) const;
+    /** Get the tick resolution of a MIDI file, falling back to 480 */
+    static int getTicksPerQuarterNote(const juce::MidiFile& midiFile);
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiManager)
@@ -0,0 +1,450 @@
+#include "MidiTimeline.h"
+#include "ActiveNotes.h"
+
+namespace
+{
+    // MidiBuffer stores each event as [int32 sample][uint16 size][bytes]
+    void appendInMidiBufferLayout(juce::MidiBuffer& destination, const juce::uint8* data, int numBytes, int samplePosition)
+    {
+        juce::uint8 header[sizeof(juce::int32) + sizeof(juce::uint16)];
+        auto sample = static_cast<juce::int32>(samplePosition);
+        auto size = static_cast<juce::uint16>(numBytes);
+
+        std::memcpy(header, &sample, sizeof(sample));
+        std::memcpy(header + sizeof(sample), &size, sizeof(size));
+
+        destination.data.addArray(header, static_cast<int>(sizeof(header)));
+        destination.data.addArray(data, numBytes);
+    }
+
+    /** The layout is not part of JUCE's API, so it is checked once at startup
+        by reading events written that way back through the buffer's iterator
+    */
+    bool checkMidiBufferLayout()
+    {
+        const juce::uint8 noteOn[] = { 0x90, 0x3c, 0x64 };
+        const juce::uint8 sysex[] = { 0xf0, 0x7e, 0x7f, 0x09, 0x01, 0xf7 };
+
+        juce::MidiBuffer buffer;
+        appendInMidiBufferLayout(buffer, noteOn, (int) sizeof(noteOn), 7);
+        appendInMidiBufferLayout(buffer, sysex, (int) sizeof(sysex), 300);
+
+        int numEvents = 0;
+        bool matches = true;
+
+        for (const auto metadata : buffer)
+        {
+            const auto* expected = numEvents == 0 ? noteOn : sysex;
+            auto expectedSize = numEvents == 0 ? (int) sizeof(noteOn) : (int) sizeof(sysex);
+
+            matches &= metadata.samplePosition == (numEvents == 0 ? 7 : 300) && metadata.numBytes == expectedSize
+                       && std::memcmp(metadata.data, expected, static_cast<size_t>(expectedSize)) == 0;
+            ++numEvents;
+        }
+
+        // A new MidiBuffer layout: appendEvent() falls back to addEvent()
+        jassert(matches && numEvents == 2);
+        return matches && numEvents == 2;
+    }
+
+    const bool midiBufferLayoutMatches = checkMidiBufferLayout();
+}
+
+//==============================================================================
+MidiTimeline::MidiTimeline()
+{
+}
+
+MidiTimeline::~MidiTimeline()
+{
+}
+
+//==============================================================================
+bool MidiTimeline::addEvent(const juce::uint8* data, int numBytes, juce::int64 position)
+{
+    // Clamping would pile every later event onto the last position
+    if (data == nullptr || numBytes <= 0 || position < 0 || position > maxPosition)
+        return false;
+
+    Event event;
+    event.position = static_cast<juce::uint32>(position);
+    std::memset(event.bytes, 0, sizeof(event.bytes));
+
+    if (numBytes <= static_cast<int>(sizeof(event.bytes)))
+    {
+        event.numBytes = static_cast<juce::uint8>(numBytes);
+        std::memcpy(event.bytes, data, static_cast<size_t>(numBytes));
+    }
+    else
+    {
+        auto index = static_cast<juce::uint32>(longMessages.size());
+        jassert(index < (1u << 24));
+
+        event.numBytes = longMessage;
+        event.bytes[0] = static_cast<juce::uint8>(index);
+        event.bytes[1] = static_cast<juce::uint8>(index >> 8);
+        event.bytes[2] = static_cast<juce::uint8>(index >> 16);
+
+        longMessages.push_back({ static_cast<juce::uint32>(extendedData.size()), static_cast<juce::uint32>(numBytes) });
+        extendedData.insert(extendedData.end(), data, data + numBytes);
+    }
+
+    if (!events.empty() && position < events.back().position)
+        needsSorting = true;
+
+    events.push_back(event);
+    return true;
+}
+
+void MidiTimeline::finishCompiling()
+{
+    if (needsSorting)
+    {
+        std::stable_sort(events.begin(), events.end(),
+                         [](const Event& a, const Event& b) { return a.position < b.position; });
+        needsSorting = false;
+    }
+
+    // A compiled timeline is kept for as long as it plays, so the slack
+    // left by growing the arrays is given back
+    events.shrink_to_fit();
+    longMessages.shrink_to_fit();
+    extendedData.shrink_to_fit();
+
+    buildNoteIndex();
+}
+
+void MidiTimeline::clear()
+{
+    events.clear();
+    longMessages.clear();
+    extendedData.clear();
+    needsSorting = false;
+    noteIndex.clear();
+    tempoMap.reset();
+}
+
+void MidiTimeline::swapWith(MidiTimeline& other) noexcept
+{
+    events.swap(other.events);
+    longMessages.swap(other.longMessages);
+    extendedData.swap(other.extendedData);
+    std::swap(ticksPerQuarterNote, other.ticksPerQuarterNote);
+    std::swap(needsSorting, other.needsSorting);
+    noteIndex.swapWith(other.noteIndex);
+    tempoMap.swap(other.tempoMap);
+}
+
+juce::int64 MidiTimeline::getEndPosition() const
+{
+    return events.empty() ? 0 : events.back().position;
+}
+
+double MidiTimeline::getLengthInBeats() const
+{
+    return static_cast<double>(getEndPosition()) / ticksPerQuarterNote;
+}
+
+const juce::uint8* MidiTimeline::getEventData(const Event& event) const
+{
+    if (event.numBytes != longMessage)
+        return event.bytes;
+
+    return extendedData.data() + getLongMessage(event).offset;
+}
+
+int MidiTimeline::getEventSize(const Event& event) const
+{
+    if (event.numBytes != longMessage)
+        return event.numBytes;
+
+    return static_cast<int>(getLongMessage(event).size);
+}
+
+size_t MidiTimeline::getMemoryUsage() const noexcept
+{
+    return sizeof(MidiTimeline)
+         + events.capacity() * sizeof(Event)
+         + longMessages.capacity() * sizeof(LongMessage)
+         + extendedData.capacity()
+         + noteIndex.getMemoryUsage();
+}
+
+double MidiTimeline::getMemoryPerEvent() const noexcept
+{
+    return events.empty() ? 0.0 : static_cast<double>(getMemoryUsage()) / static_cast<double>(events.size());
+}
+
+int MidiTimeline::getMaxEventsInSpan(juce::int64 span) const
+{
+    jassert(!needsSorting);
+
+    // Sliding window over the sorted events
+    size_t first = 0;
+    size_t maxEvents = 0;
+
+    for (size_t last = 0; last < events.size(); ++last)
+    {
+        while (events[last].position - events[first].position >= span && first < last)
+            ++first;
+
+        maxEvents = juce::jmax(maxEvents, last - first + 1);
+    }
+
+    return static_cast<int>(maxEvents);
+}
+
+void MidiTimeline::buildNoteIndex()
+{
+    noteIndex.clear();
+
+    // Index of the open span for each channel/note, or -1
+    std::vector<int> openSpans(16 * 128, -1);
+    std::vector<juce::int64> spanEnds;
+    std::vector<int> spanStarts;
+
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const auto& event = events[i];
+
+        if (event.numBytes != 3)
+            continue;
+
+        auto type = event.bytes[0] & 0xf0;
+
+        if (type != 0x90 && type != 0x80)
+            continue;
+
+        auto& open = openSpans[static_cast<size_t>((event.bytes[0] & 0x0f) * 128 + (event.bytes[1] & 0x7f))];
+
+        // A note-off, or a repeated note-on for a key that is still held, ends the open span
+        if (open >= 0)
+        {
+            spanEnds[static_cast<size_t>(open)] = event.position;
+            open = -1;
+        }
+
+        if (type == 0x90 && event.bytes[2] > 0)
+        {
+            open = static_cast<int>(spanStarts.size());
+            spanStarts.push_back(static_cast<int>(i));
+            spanEnds.push_back(-1);
+        }
+    }
+
+    // Notes never released sound until just past the last event
+    auto unreleasedEnd = juce::jmin(getEndPosition() + 1, maxPosition);
+
+    for (size_t span = 0; span < spanStarts.size(); ++span)
+    {
+        auto eventIndex = spanStarts[span];
+        auto end = spanEnds[span] >= 0 ? spanEnds[span] : unreleasedEnd;
+        noteIndex.add(events[static_cast<size_t>(eventIndex)].position, end, eventIndex);
+    }
+
+    noteIndex.build();
+}
+
+//==============================================================================
+size_t MidiTimeline::findFirstEventAtOrAfter(juce::int64 position) const
+{
+    auto it = std::lower_bound(events.begin(), events.end(), position,
+                               [](const Event& event, juce::int64 value) { return event.position < value; });
+
+    return static_cast<size_t>(it - events.begin());
+}
+
+int MidiTimeline::renderMergedBeatWindows(const MergeSource* sources,
+                                          int numSources,
+                                          double samplesPerBeat,
+                                          juce::MidiBuffer& destination,
+                                          int destinationOffset,
+                                          int numSamples)
+{
+    jassert(numSources <= maxMergeSources);
+    jassert(destination.isEmpty() || destination.getLastEventTime() <= destinationOffset);
+
+    struct Stream
+    {
+        const MergeSource* source;
+        size_t nextIndex;
+        size_t endIndex;
+        double samplesPerTick;
+        double firstSample;
+        int offset;
+    };
+
+    Stream streams[maxMergeSources];
+    int heap[maxMergeSources];
+    int heapSize = 0;
+
+    auto lastOffset = destinationOffset + juce::jmax(1, numSamples) - 1;
+
+    // Ticks map to sample offsets with the tempo of the current block, at each source's resolution
+    auto updateOffset = [&](Stream& stream)
+    {
+        auto position = stream.source->timeline->events[stream.nextIndex].position;
+        auto offset = destinationOffset + juce::roundToInt(static_cast<double>(position) * stream.samplesPerTick - stream.firstSample);
+        stream.offset = juce::jlimit(destinationOffset, lastOffset, offset);
+    };
+
+    for (int i = 0; i < juce::jmin(numSources, maxMergeSources); ++i)
+    {
+        auto& source = sources[i];
+        jassert(source.timeline != nullptr && source.cursor != nullptr);
+
+        // An event at tick t belongs to the window when startBeat <= t / tpq < endBeat,
+        // i.e. ceil(startBeat * tpq) <= t < ceil(endBeat * tpq). Using the same
+        // rounding on both edges keeps consecutive windows contiguous for the cursor.
+        auto tpq = source.timeline->ticksPerQuarterNote;
+        auto startTick = static_cast<juce::int64>(std::ceil(source.startBeat * tpq));
+        auto endTick = static_cast<juce::int64>(std::ceil(source.endBeat * tpq));
+        auto range = source.timeline->seekWindow(*source.cursor, startTick, endTick);
+
+        if (range.first == range.second)
+            continue;
+
+        auto& stream = streams[heapSize];
+        stream = { &source, range.first, range.second, samplesPerBeat / tpq, source.startBeat * samplesPerBeat, 0 };
+        updateOffset(stream);
+        heap[heapSize] = heapSize;
+        ++heapSize;
+    }
+
+    // Min-heap on (offset, source order); streams were numbered in source order
+    auto comesBefore = [&](int a, int b)
+    {
+        return streams[a].offset < streams[b].offset || (streams[a].offset == streams[b].offset && a < b);
+    };
+
+    auto siftDown = [&](int node)
+    {
+        for (;;)
+        {
+            auto smallest = node;
+            auto left = 2 * node + 1;
+            auto right = left + 1;
+
+            if (left < heapSize && comesBefore(heap[left], heap[smallest]))
+                smallest = left;
+
+            if (right < heapSize && comesBefore(heap[right], heap[smallest]))
+                smallest = right;
+
+            if (smallest == node)
+                return;
+
+            std::swap(heap[node], heap[smallest]);
+            node = smallest;
+        }
+    };
+
+    for (int node = heapSize / 2 - 1; node >= 0; --node)
+        siftDown(node);
+
+    int numEmitted = 0;
+
+    while (heapSize > 0)
+    {
+        auto& stream = streams[heap[0]];
+        auto* timeline = stream.source->timeline;
+
+        timeline->emitEvent(timeline->events[stream.nextIndex], destination, stream.offset,
+                            stream.source->activeNotes, true);
+        ++numEmitted;
+
+        if (++stream.nextIndex < stream.endIndex)
+            updateOffset(stream);
+        else
+            heap[0] = heap[--heapSize];
+
+        siftDown(0);
+    }
+
+    return numEmitted;
+}
+
+int MidiTimeline::chaseNotes(juce::int64 position,
+                             juce::MidiBuffer& destination,
+                             int destinationOffset,
+                             ActiveNotes* activeNotes) const
+{
+    return noteIndex.forEachNoteSoundingAt(position, [&](const NoteIntervalIndex::Interval& note)
+    {
+        emitEvent(events[static_cast<size_t>(note.eventIndex)], destination, destinationOffset, activeNotes);
+    });
+}
+
+int MidiTimeline::chaseNotesAtBeat(double beat,
+                                   juce::MidiBuffer& destination,
+                                   int destinationOffset,
+                                   ActiveNotes* activeNotes) const
+{
+    auto tick = static_cast<juce::int64>(std::ceil(beat * ticksPerQuarterNote));
+    return chaseNotes(tick, destination, destinationOffset, activeNotes);
+}
+
+int MidiTimeline::handOffNotesAtBeat(double beat,
+                                     juce::MidiBuffer& destination,
+                                     int destinationOffset,
+                                     ActiveNotes& activeNotes) const
+{
+    auto tick = static_cast<juce::int64>(std::ceil(beat * ticksPerQuarterNote));
+    auto channelOf = [](const juce::uint8* data) { return (data[0] & 0x0f) + 1; };
+
+    // The notes held here
+    ActiveNotes heldNotes;
+
+    noteIndex.forEachNoteSoundingAt(tick, [&](const NoteIntervalIndex::Interval& note)
+    {
+        const auto* data = getEventData(events[static_cast<size_t>(note.eventIndex)]);
+        heldNotes.noteOn(channelOf(data), data[1]);
+    });
+
+    // Releases come first, so a note moving between the two never overlaps itself
+    activeNotes.releaseAllExcept(heldNotes, destination, destinationOffset);
+
+    int numChased = 0;
+
+    noteIndex.forEachNoteSoundingAt(tick, [&](const NoteIntervalIndex::Interval& note)
+    {
+        const auto& event = events[static_cast<size_t>(note.eventIndex)];
+        const auto* data = getEventData(event);
+
+        if (!activeNotes.isNoteOn(channelOf(data), data[1]))
+        {
+            emitEvent(event, destination, destinationOffset, &activeNotes);
+            ++numChased;
+        }
+    });
+
+    return numChased;
+}
+
+void MidiTimeline::emitEvent(const Event& event,
+                             juce::MidiBuffer& destination,
+                             int samplePosition,
+                             ActiveNotes* activeNotes,
+                             bool append) const noexcept
+{
+    auto numBytes = getEventSize(event);
+    auto* data = getEventData(event);
+
+    if (append)
+        appendEvent(destination, data, numBytes, samplePosition);
+    else
+        destination.addEvent(data, numBytes, samplePosition);
+
+    if (activeNotes != nullptr)
+        activeNotes->handleMidiEvent(data, numBytes);
+}
+
+void MidiTimeline::appendEvent(juce::MidiBuffer& destination, const juce::uint8* data, int numBytes, int samplePosition)
+{
+    // addEvent() scans from the start to find the insertion point, which the
+    // merge never needs
+    if (midiBufferLayoutMatches)
+        appendInMidiBufferLayout(destination, data, numBytes, samplePosition);
+    else
+        destination.addEvent(data, numBytes, samplePosition);
+}
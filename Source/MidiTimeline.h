@@ -0,0 +1,324 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "NoteIntervalIndex.h"
+#include "TempoMap.h"
+
+class ActiveNotes;
+
+//==============================================================================
+/**
+    Compiled MIDI Timeline for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    An immutable, time-sorted and contiguous array of MIDI events built once
+    when a track is loaded. Playback reads it through a Cursor that remembers
+    where the previous audio block stopped, so rendering a block only touches
+    the events that fall inside it. A binary search is only needed when the
+    playhead jumps (seek, loop, restart). A NoteIntervalIndex built alongside
+    the events lets a jump re-trigger the notes that are held across it.
+
+    Tracks loaded by MidiManager are stored in musical time: positions are
+    MIDI ticks at getTicksPerQuarterNote() resolution. They are mapped to
+    sample offsets per block from the host tempo, so tempo and sample-rate
+    changes never require a reload. The tempo changes recorded in the file
+    are kept alongside as a shared TempoMap.
+*/
+class MidiTimeline
+{
+public:
+    //==============================================================================
+    /** A single compiled event, packed into 8 bytes.
+        Channel messages (anything of up to 3 bytes) are stored inline; longer
+        ones (sysex, most meta events) live in a side table and the event only
+        keeps their index in it. Use getEventSize() and getEventData() rather
+        than reading numBytes and bytes directly.
+
+        Positions are absolute, so a seek stays a binary search. 32 bits
+        cover more than 600 hours at 960 ticks per quarter note and 120 BPM,
+        or 24 hours of sample positions at 48 kHz.
+    */
+    struct Event
+    {
+        juce::uint32 position;
+        juce::uint8 numBytes;       /**< 1-3 for inline messages, longMessage for the side table */
+        juce::uint8 bytes[3];       /**< The message, or its side table index (24-bit, little-endian) */
+    };
+
+    static_assert(sizeof(Event) == 8, "Events must stay packed");
+
+    /** Event::numBytes of a message stored in the side table */
+    static constexpr juce::uint8 longMessage = 0;
+
+    /** Largest position an event can have */
+    static constexpr juce::int64 maxPosition = 0xffffffff;
+
+    //==============================================================================
+    /** Playback cursor into a timeline.
+        Each playing track keeps one of these across audio blocks. It holds no
+        reference to the timeline, so it stays valid (and cheap to reset) when
+        the timeline is recompiled.
+    */
+    class Cursor
+    {
+    public:
+        /** Forget the current position so the next render seeks */
+        void reset() noexcept { valid = false; }
+
+    private:
+        friend class MidiTimeline;
+
+        size_t nextIndex = 0;
+        juce::int64 expectedPosition = 0;
+        bool valid = false;
+    };
+
+    //==============================================================================
+    /** One track taking part in renderMergedBeatWindows() */
+    struct MergeSource
+    {
+        const MidiTimeline* timeline = nullptr;
+        Cursor* cursor = nullptr;
+        ActiveNotes* activeNotes = nullptr;     /**< Optional set updated with the notes this track leaves sounding */
+        double startBeat = 0.0;                 /**< Window of this source for renderMergedBeatWindows() */
+        double endBeat = 0.0;
+    };
+
+    /** Largest number of sources one merged render can take */
+    static constexpr int maxMergeSources = 64;
+
+    //==============================================================================
+    MidiTimeline();
+    ~MidiTimeline();
+
+    MidiTimeline(MidiTimeline&&) noexcept = default;
+    MidiTimeline& operator=(MidiTimeline&&) noexcept = default;
+
+    //==============================================================================
+    /** Append a single event
+        Events may be added in any order; call finishCompiling() afterwards.
+        @param data         Raw MIDI bytes
+        @param numBytes     Number of bytes in the message
+        @param position     Timeline position of the event, 0 to maxPosition
+        @returns false if the event is empty or its position is out of range;
+                 nothing is added then
+    */
+    bool addEvent(const juce::uint8* data, int numBytes, juce::int64 position);
+
+    /** Sort events added with addEvent() and index their notes so the
+        timeline can be rendered (stable, so events sharing a position keep
+        their insertion order)
+    */
+    void finishCompiling();
+
+    /** Remove all events */
+    void clear();
+
+    /** Exchange contents with another timeline (no allocation, safe on the audio thread) */
+    void swapWith(MidiTimeline& other) noexcept;
+
+    /** Set the resolution of event positions in ticks per quarter note */
+    void setTicksPerQuarterNote(int ticks) { ticksPerQuarterNote = juce::jmax(1, ticks); }
+
+    /** Get the resolution of event positions in ticks per quarter note */
+    int getTicksPerQuarterNote() const { return ticksPerQuarterNote; }
+
+    /** Attach the tempo map of the file the events came from */
+    void setTempoMap(std::shared_ptr<const TempoMap> newTempoMap) { tempoMap = std::move(newTempoMap); }
+
+    /** Get the tempo map of the file the events came from, or nullptr
+        if the timeline was not loaded from a file
+    */
+    const std::shared_ptr<const TempoMap>& getTempoMap() const { return tempoMap; }
+
+    /** Get the number of compiled events */
+    int getNumEvents() const { return static_cast<int>(events.size()); }
+
+    /** Check if the timeline has any events */
+    bool isEmpty() const { return events.empty(); }
+
+    /** Get the position of the last event, or 0 if empty */
+    juce::int64 getEndPosition() const;
+
+    /** Get the position of the last event in quarter notes */
+    double getLengthInBeats() const;
+
+    /** Get direct access to a compiled event */
+    const Event& getEvent(int index) const { return events[static_cast<size_t>(index)]; }
+
+    /** Get the raw MIDI bytes of a compiled event */
+    const juce::uint8* getEventData(const Event& event) const;
+
+    /** Get the number of raw MIDI bytes of a compiled event */
+    int getEventSize(const Event& event) const;
+
+    /** Get the largest number of events inside any window of a given length
+        Used to size render buffers up front; O(n), so call it off the audio thread.
+        @param span     Window length in timeline positions
+    */
+    int getMaxEventsInSpan(juce::int64 span) const;
+
+    /** Get the index of note spans built when the timeline was compiled */
+    const NoteIntervalIndex& getNoteIndex() const { return noteIndex; }
+
+    /** Get the memory the timeline holds (events, long message data and
+        note index), in bytes; the shared tempo map is not counted
+    */
+    size_t getMemoryUsage() const noexcept;
+
+    /** Get getMemoryUsage() divided by the number of events, or 0 if empty */
+    double getMemoryPerEvent() const noexcept;
+
+    //==============================================================================
+    /** Find the index of the first event at or after a position (binary search)
+        @param position     Position to search for
+        @returns index in [0, getNumEvents()]
+    */
+    size_t findFirstEventAtOrAfter(juce::int64 position) const;
+
+    /** Merge several timelines that each play their own musical window into one block
+        Events are appended to the destination in sample order by a k-way merge
+        over the source cursors, instead of each track inserting into a shared
+        buffer. Events landing on the same sample keep source order, so the
+        result matches rendering each source in turn. Every source's startBeat
+        lands on destinationOffset, so tracks that are offset in time can still
+        be merged in a single pass. Events are kept inside
+        [destinationOffset, destinationOffset + numSamples), and the destination
+        must hold no events later than destinationOffset.
+        @param sources          Tracks to render, with startBeat and endBeat set
+        @param numSources       Number of entries in sources; at most maxMergeSources
+        @param samplesPerBeat   Current tempo expressed in samples per quarter note
+        @param destination      Buffer receiving the events
+        @param destinationOffset Sample offset of every source's startBeat inside the block
+        @param numSamples       Length of the block range being rendered
+        @returns number of events emitted
+    */
+    static int renderMergedBeatWindows(const MergeSource* sources,
+                                       int numSources,
+                                       double samplesPerBeat,
+                                       juce::MidiBuffer& destination,
+                                       int destinationOffset,
+                                       int numSamples);
+
+    /** Emit a note-on for every note that started before a position and is
+        still held at it, so playback resuming there sounds as if it had
+        played through. O(log n + k) in the number of notes; never allocates.
+        @param position         Timeline position playback resumes from
+        @param destination      Buffer receiving the note-ons
+        @param destinationOffset Sample offset of the note-ons
+        @param activeNotes      Optional set updated with the chased notes
+        @returns number of notes chased
+    */
+    int chaseNotes(juce::int64 position,
+                   juce::MidiBuffer& destination,
+                   int destinationOffset = 0,
+                   ActiveNotes* activeNotes = nullptr) const;
+
+    /** Chase the notes held at a musical position
+        Uses the same tick rounding as renderMergedBeatWindows(), so a note starting
+        exactly at startBeat is left to the render and not chased twice.
+    */
+    int chaseNotesAtBeat(double beat,
+                         juce::MidiBuffer& destination,
+                         int destinationOffset = 0,
+                         ActiveNotes* activeNotes = nullptr) const;
+
+    /** Take over the notes another track left sounding, at a musical position
+        Notes this timeline also holds there carry on untouched; the others
+        are released, then the notes only this timeline holds are chased.
+        @param beat                 Position the timeline starts playing from
+        @param destination          Buffer receiving the note-offs and note-ons
+        @param destinationOffset    Sample offset of the events
+        @param activeNotes          Notes sounding now; updated to this timeline's
+        @returns number of notes chased
+    */
+    int handOffNotesAtBeat(double beat,
+                           juce::MidiBuffer& destination,
+                           int destinationOffset,
+                           ActiveNotes& activeNotes) const;
+
+    //==============================================================================
+    /** Write one event at the end of a buffer's storage, in MidiBuffer's own layout
+        Unlike MidiBuffer::addEvent() this never searches, so it is only valid
+        when no event in the buffer is later than samplePosition. The layout
+        is checked at startup; if JUCE changes it, addEvent() is used instead.
+    */
+    static void appendEvent(juce::MidiBuffer& destination, const juce::uint8* data, int numBytes, int samplePosition);
+
+private:
+    //==============================================================================
+    /** Where a message that does not fit in an Event lives in extendedData */
+    struct LongMessage
+    {
+        juce::uint32 offset;
+        juce::uint32 size;
+    };
+
+    std::vector<Event> events;
+    std::vector<LongMessage> longMessages;
+    std::vector<juce::uint8> extendedData;
+    int ticksPerQuarterNote = 960;
+    bool needsSorting = false;
+    NoteIntervalIndex noteIndex;
+    std::shared_ptr<const TempoMap> tempoMap;
+
+    // Stores and restores the arrays above as they are
+    friend class CompiledTrackCache;
+
+    // Merges tracks decoded on several threads straight into the arrays
+    friend class MidiFileParser;
+
+    //==============================================================================
+    /** Get the side table entry of an event with numBytes == longMessage */
+    const LongMessage& getLongMessage(const Event& event) const noexcept
+    {
+        return longMessages[static_cast<size_t>(event.bytes[0] | (event.bytes[1] << 8) | (event.bytes[2] << 16))];
+    }
+
+    /** Pair note-ons with their note-offs and build the interval index */
+    void buildNoteIndex();
+
+    /** Add an event to a buffer and to the set of sounding notes
+        @param append   Write the event at the end of the buffer without searching;
+                        only valid when no event in it is later than samplePosition
+    */
+    void emitEvent(const Event& event,
+                   juce::MidiBuffer& destination,
+                   int samplePosition,
+                   ActiveNotes* activeNotes,
+                   bool append = false) const noexcept;
+
+    /** Move the cursor to the events in [startPosition, endPosition) and return
+        their index range, leaving the cursor ready for the following window
+    */
+    std::pair<size_t, size_t> seekWindow(Cursor& cursor, juce::int64 startPosition, juce::int64 endPosition) const noexcept
+    {
+        jassert(!needsSorting);
+
+        // Only search when the playhead did not continue from the previous block
+        if (!cursor.valid || cursor.expectedPosition != startPosition || cursor.nextIndex > events.size())
+            cursor.nextIndex = findFirstEventAtOrAfter(startPosition);
+
+        auto firstIndex = cursor.nextIndex;
+        auto index = firstIndex;
+
+        while (index < events.size() && events[index].position < endPosition)
+            ++index;
+
+        cursor.nextIndex = index;
+        cursor.expectedPosition = endPosition;
+        cursor.valid = true;
+
+        return { firstIndex, index };
+    }
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiTimeline)
+};
@@ -0,0 +1,69 @@
+#include "NoteIntervalIndex.h"
+
+//==============================================================================
+void NoteIntervalIndex::clear()
+{
+    intervals.clear();
+    rootLevel = 0;
+}
+
+void NoteIntervalIndex::add(juce::int64 start, juce::int64 end, int eventIndex)
+{
+    jassert(intervals.empty() || start >= intervals.back().start);
+    jassert(start >= 0 && end <= 0xffffffff);
+
+    auto spanEnd = static_cast<juce::uint32>(juce::jlimit((juce::int64) 0, (juce::int64) 0xffffffff, end));
+    intervals.push_back({ static_cast<juce::uint32>(juce::jmax((juce::int64) 0, start)), spanEnd, spanEnd, eventIndex });
+}
+
+void NoteIntervalIndex::build()
+{
+    intervals.shrink_to_fit();
+
+    const auto n = intervals.size();
+    rootLevel = 0;
+
+    if (n == 0)
+        return;
+
+    // Leaves (even indices) only cover themselves
+    size_t lastIndex = 0;
+    juce::uint32 lastMaxEnd = 0;
+
+    for (size_t i = 0; i < n; i += 2)
+    {
+        lastIndex = i;
+        lastMaxEnd = intervals[i].maxEnd = intervals[i].end;
+    }
+
+    // Each level up combines a node with its children; children missing past
+    // the end of the array are stood in for by the rightmost existing subtree
+    int level = 1;
+
+    for (; ((size_t) 1 << level) <= n; ++level)
+    {
+        const size_t half = (size_t) 1 << (level - 1);
+        const size_t firstNode = (half << 1) - 1;
+        const size_t step = half << 2;
+
+        for (size_t i = firstNode; i < n; i += step)
+        {
+            auto leftEnd = intervals[i - half].maxEnd;
+            auto rightEnd = i + half < n ? intervals[i + half].maxEnd : lastMaxEnd;
+            intervals[i].maxEnd = juce::jmax(intervals[i].end, leftEnd, rightEnd);
+        }
+
+        lastIndex = ((lastIndex >> level) & 1) != 0 ? lastIndex - half : lastIndex + half;
+
+        if (lastIndex < n && intervals[lastIndex].maxEnd > lastMaxEnd)
+            lastMaxEnd = intervals[lastIndex].maxEnd;
+    }
+
+    rootLevel = level - 1;
+}
+
+void NoteIntervalIndex::swapWith(NoteIntervalIndex& other) noexcept
+{
+    intervals.swap(other.intervals);
+    std::swap(rootLevel, other.rootLevel);
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+    Note Interval Index for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    The notes of a track as [noteOn, noteOff) spans, stored as an implicit
+    augmented interval tree (the layout used by cgranges): spans are sorted by
+    start, the array itself is a complete binary tree where node i sits at
+    level "number of trailing 1 bits of i", and every node keeps the largest
+    end position of its subtree. Finding the notes sounding at a position
+    costs O(log n + k) with no allocation, so a seek or loop restart can chase
+    held notes on the audio thread without scanning the track.
+
+    Built once when a MidiTimeline is compiled; immutable afterwards.
+*/
+class NoteIntervalIndex
+{
+public:
+    //==============================================================================
+    /** A note span; eventIndex refers to the note-on in the owning timeline.
+        Positions are 32-bit like MidiTimeline::Event, so a span takes 16 bytes.
+    */
+    struct Interval
+    {
+        juce::uint32 start;
+        juce::uint32 end;
+        juce::uint32 maxEnd;    /**< Largest end in this node's subtree */
+        int eventIndex;
+    };
+
+    //==============================================================================
+    NoteIntervalIndex() = default;
+
+    //==============================================================================
+    /** Remove all intervals */
+    void clear();
+
+    /** Add a span; spans must be added in order of their start position */
+    void add(juce::int64 start, juce::int64 end, int eventIndex);
+
+    /** Build the tree after all spans were added */
+    void build();
+
+    /** Exchange contents with another index (no allocation) */
+    void swapWith(NoteIntervalIndex& other) noexcept;
+
+    //==============================================================================
+    /** Get the number of indexed notes */
+    int getNumIntervals() const { return static_cast<int>(intervals.size()); }
+
+    /** Get an indexed note */
+    const Interval& getInterval(int index) const { return intervals[static_cast<size_t>(index)]; }
+
+    /** Get the heap memory the index holds, in bytes */
+    size_t getMemoryUsage() const noexcept { return intervals.capacity() * sizeof(Interval); }
+
+    //==============================================================================
+    /** Call visit(interval) for every note with start < position < end,
+        i.e. notes that started earlier and are still held at position.
+        Notes are visited in order of their start position.
+        @returns number of notes visited
+    */
+    template <typename VisitFunction>
+    int forEachNoteSoundingAt(juce::int64 position, VisitFunction&& visit) const
+    {
+        if (intervals.empty())
+            return 0;
+
+        // Half-open overlap test against the empty query [position, position)
+        const auto n = static_cast<juce::int64>(intervals.size());
+        int numVisited = 0;
+
+        struct StackEntry { juce::int64 node; int level; bool leftDone; };
+        StackEntry stack[64];
+        int top = 0;
+
+        stack[top++] = { ((juce::int64) 1 << rootLevel) - 1, rootLevel, false };
+
+        while (top > 0)
+        {
+            auto entry = stack[--top];
+
+            if (entry.level <= 3)
+            {
+                // Small subtree: a linear scan beats further descent
+                auto first = entry.node >> entry.level << entry.level;
+                auto last = juce::jmin(n, first + ((juce::int64) 1 << (entry.level + 1)) - 1);
+
+                for (auto i = first; i < last && intervals[(size_t) i].start < position; ++i)
+                {
+                    if (position < intervals[(size_t) i].end)
+                    {
+                        visit(intervals[(size_t) i]);
+                        ++numVisited;
+                    }
+                }
+            }
+            else if (!entry.leftDone)
+            {
+                // Revisit this node after its left subtree; skip the subtree
+                // when none of its notes reaches the position
+                auto left = entry.node - ((juce::int64) 1 << (entry.level - 1));
+                stack[top++] = { entry.node, entry.level, true };
+
+                if (left >= n || intervals[(size_t) left].maxEnd > position)
+                    stack[top++] = { left, entry.level - 1, false };
+            }
+            else if (entry.node < n && intervals[(size_t) entry.node].start < position)
+            {
+                if (position < intervals[(size_t) entry.node].end)
+                {
+                    visit(intervals[(size_t) entry.node]);
+                    ++numVisited;
+                }
+
+                stack[top++] = { entry.node + ((juce::int64) 1 << (entry.level - 1)), entry.level - 1, false };
+            }
+        }
+
+        return numVisited;
+    }
+
+private:
+    //==============================================================================
+    std::vector<Interval> intervals;
+    int rootLevel = 0;
+
+    // Stores and restores the built tree as it is
+    friend class CompiledTrackCache;
+
+    //==============================================================================
+    JUCE_LEAK_DETECTOR (NoteIntervalIndex)
+};
@@ -266,6 +266,11 @@ void AIBandAudioProcessorEditor::updateDisplay()
     positionLabel.setText("Position: " + juce::String(currentBeat, 1) + " beats", 
                          juce::dontSendNotification);
     
+    // Show the tempo the loaded tracks were written at, once one is known
+    auto trackTempo = audioProcessor.getTrackTempo();
+    if (trackTempo > 0.0)
+        tempoLabel.setText("Tempo: " + juce::String(trackTempo, 1) + " BPM", juce::dontSendNotification);
+    
     // Update play/stop button states
     bool isPlaying = audioProcessor.isPlaying();
     playButton.setEnabled(!isPlaying);
@@ -13,13 +13,26 @@ AIBandAudioProcessor::AIBandAudioProcessor()
                      #endif
                        ),
 #endif
+       folderWatcher(trackExchange),
        isPlayingTracks(false),
        currentBeat(0.0),
        beatsPerSecond(2.0), // Default 120 BPM = 2 beats per second
-       samplesSinceLastBeat(0),
+       nextBlockStartBeat(-1.0),
+       hostLooping(false),
+       loopStartBeat(0.0),
+       loopEndBeat(0.0),
+       numJumps(0),
+       renderedSamples(0),
        hostSampleRate(44100.0),
-       hostBlockSize(512)
+       hostBlockSize(512),
+       reservedEventsPerBeat(0)
 {
+    trackPlayback[TrackExchange::drumTrack].chasesNotes = false;
+    
+    // Render buffers for the default setup, grown ahead of denser tracks
+    reserveEventBuffers();
+    trackExchange.setPeakCallback([this](int peakEventsPerBeat) { growEventBuffers(peakEventsPerBeat); });
+    
     // Initialize MIDI manager and network client
     midiManager.initialize();
     networkClient.initialize();
@@ -27,6 +40,12 @@ AIBandAudioProcessor::AIBandAudioProcessor()
 
 AIBandAudioProcessor::~AIBandAudioProcessor()
 {
+    folderWatcher.stop();
+    transformBaker.removeAllJobs(true, 5000);
+    trackExchange.setPeakCallback(nullptr);
+    
+    delete grownEventBuffers.exchange(nullptr);
+    delete retiredEventBuffers.exchange(nullptr);
 }
 
 //==============================================================================
@@ -116,9 +135,18 @@ void AIBandAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock
     // Prepare MIDI manager
     midiManager.prepareToPlay(sampleRate, samplesPerBlock);
     
-    // Reset playback state
+    // Size the render buffers now, so processBlock never has to grow them
+    reserveEventBuffers();
+    
+    // Timing offsets are reported in samples, so they change with the rate
+    setLatencySamples(calculateLatencySamples());
+    
+    // Reset playback state; the internal transport starts at the host tempo
+    internalClock.setSampleRate(sampleRate);
+    internalClock.setTempo(beatsPerSecond * 60.0);
+    internalClock.reset();
     currentBeat = 0.0;
-    samplesSinceLastBeat = 0;
+    nextBlockStartBeat = -1.0;
 }
 
 void AIBandAudioProcessor::releaseResources()
@@ -149,6 +177,14 @@ bool AIBandAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) c
 }
 #endif
 
+void AIBandAudioProcessor::copyEvents(const juce::MidiBuffer& source, juce::MidiBuffer& destination) noexcept
+{
+    // Both are in time order already, so the bytes are copied as they are;
+    // nothing is allocated while the destination has the room
+    destination.clear();
+    destination.data.addArray(source.data.data(), source.data.size());
+}
+
 void AIBandAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
@@ -159,16 +195,49 @@ void AIBandAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce:
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
+    // Buffers grown for denser tracks take over between blocks
+    takeGrownEventBuffers();
+    auto& buffers = *eventBuffers;
+    
+    // Incoming MIDI and the tracks are merged in a reserved buffer that is
+    // never given away, whatever the host's buffer has room for
+    auto& output = buffers.output;
+    copyEvents(midiMessages, output);
+    
+    // Apply the controls sent since the previous block, in order
+    handleCommands(output);
+    
+    // Switch to newly published tracks at the block boundary
+    applyPendingTracks();
+    
     // Update playback position and tempo
     updatePlaybackPosition(buffer.getNumSamples());
+    displayedBeat.store(currentBeat);
     
-    // Check for new MIDI files periodically
-    checkForNewMidiFiles();
+    // Follow the tempo written in the loaded files for the editor; the
+    // cursor makes this a constant-time lookup while playing
+    if (playingTempoMap != nullptr)
+        trackTempoBpm.store(playingTempoMap->getTempoAt(currentBeat, tempoCursor));
     
     // Process MIDI events if we're playing
     if (isPlayingTracks)
     {
-        processMidiEvents(midiMessages, buffer.getNumSamples());
+        processMidiEvents(output, buffer.getNumSamples());
+    }
+    
+    // The host's buffer takes a copy when it has the room, as one the host
+    // sized does. A smaller one is swapped for a reserved spare holding the
+    // copy instead of being grown, and keeps that storage for the next blocks;
+    // only a host handing over more small buffers than that has one grown.
+    if (midiMessages.data.getNumAllocated() < output.data.size() && buffers.numSpares > 0)
+    {
+        auto& spare = buffers.spares[static_cast<size_t>(--buffers.numSpares)];
+        copyEvents(output, spare);
+        midiMessages.swapWith(spare);
+    }
+    else
+    {
+        copyEvents(output, midiMessages);
     }
     
     // Pass through input audio (if any)
@@ -196,9 +265,29 @@ void AIBandAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     // Save plugin state
     juce::ValueTree state("AIBandPlugin");
-    state.setProperty("isPlaying", isPlayingTracks, nullptr);
-    state.setProperty("currentBeat", currentBeat, nullptr);
+    state.setProperty("isPlaying", playing.load(), nullptr);
+    state.setProperty("currentBeat", displayedBeat.load(), nullptr);
     state.setProperty("monitoredFolder", monitoredFolder, nullptr);
+    state.setProperty("handoffBars", handoffBars.load(), nullptr);
+    
+    // Only tracks whose mix differs from the defaults are stored
+    for (int i = 0; i < TrackExchange::maxTracks; ++i)
+    {
+        auto& controls = trackControls[static_cast<size_t>(i)];
+        
+        if (controls.channel.load() == 0 && controls.gain.load() == 1.0f
+             && !controls.muted.load() && !controls.soloed.load() && controls.timingOffsetMs.load() == 0.0)
+            continue;
+        
+        juce::ValueTree track("Track");
+        track.setProperty("index", i, nullptr);
+        track.setProperty("channel", controls.channel.load(), nullptr);
+        track.setProperty("gain", controls.gain.load(), nullptr);
+        track.setProperty("muted", controls.muted.load(), nullptr);
+        track.setProperty("soloed", controls.soloed.load(), nullptr);
+        track.setProperty("timingOffset", controls.timingOffsetMs.load(), nullptr);
+        state.appendChild(track, nullptr);
+    }
     
     juce::MemoryOutputStream stream(destData, false);
     state.writeToStream(stream);
@@ -211,9 +300,51 @@ void AIBandAudioProcessor::setStateInformation (const void* data, int sizeInByte
     
     if (state.isValid() && state.hasType("AIBandPlugin"))
     {
-        isPlayingTracks = state.getProperty("isPlaying", false);
-        currentBeat = state.getProperty("currentBeat", 0.0);
-        monitoredFolder = state.getProperty("monitoredFolder", "");
+        double beat = state.getProperty("currentBeat", 0.0);
+        
+        if (state.getProperty("isPlaying", false))
+        {
+            playing = true;
+            displayedBeat = beat;
+            requestedBeat = beat;
+            sendCommand(CommandQueue::Command::start, 0, beat);
+        }
+        else
+        {
+            stopPlayback();
+            setPlaybackPosition(beat);
+        }
+        
+        setMidiFolder(state.getProperty("monitoredFolder", "").toString());
+        setHandoffBars(state.getProperty("handoffBars", 1));
+        
+        for (int i = 0; i < TrackExchange::maxTracks; ++i)
+        {
+            setTrackChannel(i, 0);
+            setTrackGain(i, 1.0f);
+            setTrackMuted(i, false);
+            setTrackSoloed(i, false);
+            setTrackTimingOffset(i, 0.0);
+        }
+        
+        for (int child = 0; child < state.getNumChildren(); ++child)
+        {
+            auto track = state.getChild(child);
+            
+            if (!track.hasType("Track"))
+                continue;
+            
+            int index = track.getProperty("index", -1);
+            
+            if (index < 0 || index >= TrackExchange::maxTracks)
+                continue;
+            
+            setTrackChannel(index, track.getProperty("channel", 0));
+            setTrackGain(index, static_cast<float>(static_cast<double>(track.getProperty("gain", 1.0))));
+            setTrackMuted(index, track.getProperty("muted", false));
+            setTrackSoloed(index, track.getProperty("soloed", false));
+            setTrackTimingOffset(index, track.getProperty("timingOffset", 0.0));
+        }
     }
 }
 
@@ -222,78 +353,834 @@ void AIBandAudioProcessor::setStateInformation (const void* data, int sizeInByte
 
 bool AIBandAudioProcessor::loadMidiFiles(const juce::String& bassFilePath, const juce::String& drumFilePath)
 {
-    bool success = true;
+    juce::StringArray filePaths;
+    filePaths.add(bassFilePath);
+    filePaths.add(drumFilePath);
     
-    // Load bass MIDI file
-    if (bassFilePath.isNotEmpty())
-    {
-        success &= midiManager.loadMidiFile(bassFilePath, bassMidiData);
-    }
+    return loadTrackFiles(filePaths);
+}
+
+bool AIBandAudioProcessor::loadTrackFiles(const juce::StringArray& filePaths)
+{
+    bool success = true;
+    TrackExchange::SharedTrackList newTracks(static_cast<size_t>(juce::jmin(filePaths.size(), TrackExchange::maxTracks)));
     
-    // Load drum MIDI file  
-    if (drumFilePath.isNotEmpty())
+    // Get each file's tick-based playback timeline from the shared cache,
+    // parsing only content no instance has loaded yet and no earlier session
+    // compiled to disk; the tracks being played are never touched from this thread
+    for (size_t i = 0; i < newTracks.size(); ++i)
     {
-        success &= midiManager.loadMidiFile(drumFilePath, drumMidiData);
+        auto filePath = filePaths[static_cast<int>(i)];
+        
+        if (filePath.isNotEmpty())
+        {
+            juce::File file(filePath);
+            juce::MemoryBlock data;
+            
+            if (MidiManager::isValidMidiFile(filePath) && file.loadFileAsData(data))
+            {
+                CompiledTrackCache compiledTracks(CompiledTrackCache::getFolderFor(file.getParentDirectory()));
+                newTracks[i] = timelineCache->getTimeline(data.getData(), data.getSize(), midiManager, &compiledTracks);
+            }
+            
+            if (newTracks[i] == nullptr)
+            {
+                DBG("Failed to load MIDI file: " << filePath);
+                success = false;
+            }
+        }
     }
     
     if (success)
     {
-        // Reset playback position when new files are loaded
-        resetPlayback();
+        // Goes live at the next block boundary, which also resets playback
+        trackExchange.publish(std::move(newTracks));
     }
     
     return success;
 }
 
-void AIBandAudioProcessor::startPlayback()
+// Only settings that change are sent, so restoring a state with mostly
+// default tracks queues a handful of commands
+
+void AIBandAudioProcessor::setTrackChannel(int trackIndex, int channel)
 {
-    isPlayingTracks = true;
-    resetPlayback();
+    if (!juce::isPositiveAndBelow(trackIndex, TrackExchange::maxTracks))
+        return;
+    
+    channel = juce::jlimit(0, 16, channel);
+    
+    if (trackControls[static_cast<size_t>(trackIndex)].channel.exchange(channel) != channel)
+        updateTrackTransform(trackIndex);
 }
 
-void AIBandAudioProcessor::stopPlayback()
+void AIBandAudioProcessor::setTrackGain(int trackIndex, float gain)
+{
+    if (!juce::isPositiveAndBelow(trackIndex, TrackExchange::maxTracks))
+        return;
+    
+    gain = juce::jmax(0.0f, gain);
+    
+    if (trackControls[static_cast<size_t>(trackIndex)].gain.exchange(gain) != gain)
+        updateTrackTransform(trackIndex);
+}
+
+void AIBandAudioProcessor::setTrackMuted(int trackIndex, bool shouldBeMuted)
+{
+    if (!juce::isPositiveAndBelow(trackIndex, TrackExchange::maxTracks))
+        return;
+    
+    if (trackControls[static_cast<size_t>(trackIndex)].muted.exchange(shouldBeMuted) != shouldBeMuted)
+        sendCommand(CommandQueue::Command::setTrackMuted, trackIndex, shouldBeMuted ? 1.0 : 0.0);
+}
+
+void AIBandAudioProcessor::setTrackSoloed(int trackIndex, bool shouldBeSoloed)
+{
+    if (!juce::isPositiveAndBelow(trackIndex, TrackExchange::maxTracks))
+        return;
+    
+    if (trackControls[static_cast<size_t>(trackIndex)].soloed.exchange(shouldBeSoloed) != shouldBeSoloed)
+        sendCommand(CommandQueue::Command::setTrackSoloed, trackIndex, shouldBeSoloed ? 1.0 : 0.0);
+}
+
+void AIBandAudioProcessor::setTrackTimingOffset(int trackIndex, double milliseconds)
+{
+    if (!juce::isPositiveAndBelow(trackIndex, TrackExchange::maxTracks))
+        return;
+    
+    milliseconds = juce::jlimit(-maxTimingOffsetMs, maxTimingOffsetMs, milliseconds);
+    
+    if (trackControls[static_cast<size_t>(trackIndex)].timingOffsetMs.exchange(milliseconds) == milliseconds)
+        return;
+    
+    sendCommand(CommandQueue::Command::setTrackTimingOffset, trackIndex, milliseconds);
+    
+    // The host delays everything else by the earliest offset, which lines
+    // the tracks up again with that one sent ahead
+    setLatencySamples(calculateLatencySamples());
+}
+
+void AIBandAudioProcessor::setTrackTransform(int trackIndex, const EventTransform& transform)
+{
+    if (!juce::isPositiveAndBelow(trackIndex, TrackExchange::maxTracks))
+        return;
+    
+    const juce::ScopedLock lock(transformLock);
+    trackTransforms[static_cast<size_t>(trackIndex)] = transform;
+    updateTrackTransform(trackIndex);
+}
+
+EventTransform AIBandAudioProcessor::getTrackTransform(int trackIndex) const
+{
+    if (!juce::isPositiveAndBelow(trackIndex, TrackExchange::maxTracks))
+        return {};
+    
+    const juce::ScopedLock lock(transformLock);
+    return trackTransforms[static_cast<size_t>(trackIndex)];
+}
+
+bool AIBandAudioProcessor::waitForTransforms(int timeoutMs)
+{
+    // The baker runs its jobs one at a time and in order, so every bake
+    // queued before this job has finished once it runs
+    auto baked = std::make_shared<juce::WaitableEvent>();
+    transformBaker.addJob([baked] { baked->signal(); });
+    
+    return baked->wait(timeoutMs);
+}
+
+void AIBandAudioProcessor::updateTrackTransform(int trackIndex)
 {
-    isPlayingTracks = false;
+    // Channel and gain are the last stages of what is baked; the lock keeps
+    // a slower caller from publishing controls older than the latest ones
+    const juce::ScopedLock lock(transformLock);
+    const auto& controls = trackControls[static_cast<size_t>(trackIndex)];
+    auto baked = trackTransforms[static_cast<size_t>(trackIndex)];
+    auto gain = controls.gain.load();
+    auto channel = controls.channel.load();
+    
+    if (gain != 1.0f)
+        baked.scaleVelocity(gain);
+    
+    if (channel > 0)
+        baked.setChannel(channel);
     
-    // Send all-notes-off MIDI messages
-    juce::MidiBuffer allNotesOff;
-    for (int channel = 1; channel <= 16; ++channel)
+    if (!trackExchange.setTransform(trackIndex, baked))
+        return;
+    
+    // One queued bake picks up every transform changed before it runs
+    if (!bakeQueued.exchange(true))
     {
-        allNotesOff.addEvent(juce::MidiMessage::allNotesOff(channel), 0);
+        transformBaker.addJob([this]
+        {
+            bakeQueued = false;
+            trackExchange.bakeTransforms();
+        });
     }
+}
+
+void AIBandAudioProcessor::setHandoffBars(int numBars)
+{
+    numBars = juce::jlimit(0, maxHandoffBars, numBars);
     
-    // This will be sent in the next processBlock call
-    currentMidiBuffer.swapWith(allNotesOff);
+    if (handoffBars.exchange(numBars) == numBars)
+        return;
+    
+    sendCommand(CommandQueue::Command::setHandoffBars, 0, numBars);
+}
+
+void AIBandAudioProcessor::startPlayback()
+{
+    playing = true;
+    displayedBeat = 0.0;
+    requestedBeat = 0.0;
+    sendCommand(CommandQueue::Command::start);
+}
+
+void AIBandAudioProcessor::stopPlayback()
+{
+    // Note-offs for the notes still sounding are sent when the audio thread
+    // takes the command; nothing is built here, so no buffer is touched
+    playing = false;
+    sendCommand(CommandQueue::Command::stop);
 }
 
 void AIBandAudioProcessor::setMidiFolder(const juce::String& folderPath)
 {
     monitoredFolder = folderPath;
-    lastFolderCheck = juce::Time::getCurrentTime();
+    folderWatcher.setFolder(folderPath);
+}
+
+void AIBandAudioProcessor::setInternalTempo(double bpm, double rampSeconds)
+{
+    bpm = juce::jlimit(TransportClock::minTempoBpm, TransportClock::maxTempoBpm, bpm);
+    rampSeconds = juce::jmax(0.0, rampSeconds);
+    
+    requestedTempoBpm = bpm;
+    requestedTempoRamp = rampSeconds;
+    sendCommand(CommandQueue::Command::setTempo, 0, bpm, rampSeconds);
 }
 
 void AIBandAudioProcessor::resetPlayback()
 {
-    currentBeat = 0.0;
-    samplesSinceLastBeat = 0;
+    setPlaybackPosition(0.0);
+}
+
+void AIBandAudioProcessor::setPlaybackPosition(double beat)
+{
+    beat = juce::jmax(0.0, beat);
+    displayedBeat = beat;
+    requestedBeat = beat;
+    sendCommand(CommandQueue::Command::seek, 0, beat);
+}
+
+//==============================================================================
+// Offline rendering
+
+class AIBandAudioProcessor::OfflinePlayHead : public juce::AudioPlayHead
+{
+public:
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo info;
+        info.setIsPlaying(playing);
+        info.setBpm(bpm);
+        info.setPpqPosition(ppqPosition);
+        info.setTimeInSamples(timeInSamples);
+        info.setIsLooping(looping);
+        info.setLoopPoints(juce::AudioPlayHead::LoopPoints { loopStartBeat, loopEndBeat });
+        return info;
+    }
+    
+    /** Move on by one block, wrapping at the loop end like a host */
+    void advance(int numSamples, double sampleRate)
+    {
+        ppqPosition += numSamples / sampleRate * (bpm / 60.0);
+        timeInSamples += numSamples;
+        
+        if (looping && ppqPosition >= loopEndBeat)
+            ppqPosition = loopStartBeat + std::fmod(ppqPosition - loopStartBeat, loopEndBeat - loopStartBeat);
+    }
+    
+    bool playing = false;
+    double bpm = TempoMap::defaultTempoBpm;
+    double ppqPosition = 0.0;
+    juce::int64 timeInSamples = 0;
+    bool looping = false;
+    double loopStartBeat = 0.0;
+    double loopEndBeat = 0.0;
+};
+
+bool AIBandAudioProcessor::renderToMidiFile(const juce::String& filePath, const OfflineRenderOptions& options,
+                                            OfflineRenderStatistics* statistics)
+{
+    if (filePath.isEmpty() || !(options.sampleRate > 0.0) || options.blockSize <= 0)
+        return false;
+    
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    
+    // A processor of its own plays the render, so this one and the host's
+    // callback carry on untouched. Transforms still waiting for the worker
+    // thread are baked right here; the snapshot then goes over as it is,
+    // with the mix settings the audio thread gets as commands.
+    trackExchange.bakeTransforms();
+    
+    AIBandAudioProcessor renderer;
+    renderer.trackExchange.publish(trackExchange.getPublishedTracks());
+    
+    for (int i = 0; i < TrackExchange::maxTracks; ++i)
+    {
+        const auto& controls = trackControls[static_cast<size_t>(i)];
+        renderer.setTrackMuted(i, controls.muted.load());
+        renderer.setTrackSoloed(i, controls.soloed.load());
+        renderer.setTrackTimingOffset(i, controls.timingOffsetMs.load());
+    }
+    
+    auto saved = renderer.playOfflineRender(filePath, options, statistics);
+    
+    if (statistics != nullptr)
+        statistics->elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    
+    return saved;
+}
+
+bool AIBandAudioProcessor::playOfflineRender(const juce::String& filePath, const OfflineRenderOptions& options,
+                                             OfflineRenderStatistics* statistics)
+{
+    OfflinePlayHead playHead;
+    playHead.ppqPosition = juce::jmax(0.0, options.startBeat);
+    playHead.looping = options.loopEndBeat > options.loopStartBeat && options.loopStartBeat >= 0.0;
+    playHead.loopStartBeat = options.loopStartBeat;
+    playHead.loopEndBeat = options.loopEndBeat;
+    
+    setNonRealtime(true);
+    setPlayHead(&playHead);
+    prepareToPlay(options.sampleRate, options.blockSize);
+    
+    juce::AudioBuffer<float> audioBuffer(juce::jmax(1, getTotalNumInputChannels(), getTotalNumOutputChannels()), options.blockSize);
+    juce::MidiBuffer blockEvents, rendered;
+    int numEvents = 0;
+    
+    // Blocks come in time order, so their events are appended without the
+    // search addEvent() makes for each one. The host delays everything by
+    // the reported latency, which is taken out.
+    const auto latency = getLatencySamples();
+    juce::int64 samplePosition = 0;
+    
+    auto appendBlock = [&]
+    {
+        for (const auto metadata : blockEvents)
+        {
+            auto position = juce::jmax(static_cast<juce::int64>(0), samplePosition + metadata.samplePosition - latency);
+            MidiTimeline::appendEvent(rendered, metadata.data, metadata.numBytes, static_cast<int>(position));
+            ++numEvents;
+        }
+    };
+    
+    // A stopped block first takes the tracks and controls
+    processBlock(audioBuffer, blockEvents);
+    
+    auto lengthInBeats = options.lengthInBeats;
+    const auto& tracks = trackExchange.getCurrent();
+    
+    if (lengthInBeats <= 0.0)
+        for (int i = 0; i < tracks.getNumTracks(); ++i)
+            lengthInBeats = juce::jmax(lengthInBeats, tracks.getTrack(i).getLengthInBeats());
+    
+    // Tempo of the render as played, loops unrolled, for the file
+    std::vector<TempoMap::TempoChange> playedTempo;
+    TempoMap::Cursor renderTempoCursor;
+    double beatsPlayed = 0.0;
+    juce::int64 endSample = -1;
+    
+    startPlayback();
+    playHead.playing = true;
+    
+    while (true)
+    {
+        auto bpm = options.tempoBpm > 0.0 ? options.tempoBpm
+                 : playingTempoMap != nullptr ? playingTempoMap->getTempoAt(playHead.ppqPosition, renderTempoCursor)
+                 : TempoMap::defaultTempoBpm;
+        
+        // The block reaching the end stops on it; delayed tracks then run on
+        // by their delay to finish their part, while the others fall silent
+        auto numSamples = options.blockSize;
+        
+        if (endSample < 0)
+        {
+            auto samplesLeft = static_cast<juce::int64>(std::ceil((lengthInBeats - beatsPlayed) * 60.0 / bpm * options.sampleRate - 1.0e-6));
+            
+            if (samplesLeft <= numSamples)
+            {
+                samplesLeft = juce::jmax(static_cast<juce::int64>(0), samplesLeft);
+                endSample = samplePosition + samplesLeft;
+                renderEndSample = renderedSamples + samplesLeft;
+            }
+        }
+        
+        if (endSample >= 0)
+        {
+            auto samplesLeft = endSample + latency - samplePosition;
+            
+            if (samplesLeft <= 0)
+                break;
+            
+            numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(numSamples), samplesLeft));
+        }
+        
+        if (playedTempo.empty() || playedTempo.back().bpm != bpm)
+            playedTempo.push_back({ beatsPlayed, bpm });
+        
+        playHead.bpm = bpm;
+        audioBuffer.setSize(audioBuffer.getNumChannels(), numSamples, false, false, true);
+        blockEvents.clear();
+        processBlock(audioBuffer, blockEvents);
+        appendBlock();
+        
+        playHead.advance(numSamples, options.sampleRate);
+        samplePosition += numSamples;
+        beatsPlayed += numSamples / options.sampleRate * (bpm / 60.0);
+    }
+    
+    // Notes still sounding end with the render
+    stopPlayback();
+    playHead.playing = false;
+    blockEvents.clear();
+    processBlock(audioBuffer, blockEvents);
+    appendBlock();
+    renderEndSample = -1;
+    
+    TempoMap fileTempo(std::move(playedTempo), 480);
+    bool saved = midiManager.saveMidiFile(rendered, filePath, fileTempo);
+    setPlayHead(nullptr);
+    
+    if (statistics != nullptr)
+    {
+        statistics->numEvents = numEvents;
+        statistics->renderedSeconds = endSample / options.sampleRate;
+    }
+    
+    if (!saved)
+        DBG("Failed to write the offline render to " << filePath);
+    
+    return saved;
 }
 
 //==============================================================================
 // Internal methods
 
+void AIBandAudioProcessor::sendCommand(CommandQueue::Command::Type type, int trackIndex, double value, double secondValue)
+{
+    CommandQueue::Command command;
+    command.type = type;
+    command.trackIndex = trackIndex;
+    command.value = value;
+    command.secondValue = secondValue;
+    
+    // The queue only fills up if the host stops calling processBlock for a
+    // long time; the audio thread then catches up from the requested state
+    if (!commandQueue.push(command))
+    {
+        DBG("Command queue full, resynchronising at the next block");
+        
+        // Jumps and tempo changes are events rather than state, so the
+        // audio thread has to be told which of them it missed
+        if (type == CommandQueue::Command::start || type == CommandQueue::Command::seek)
+            seekDropped = true;
+        else if (type == CommandQueue::Command::setTempo)
+            tempoDropped = true;
+        
+        commandsDropped = true;
+    }
+}
+
+void AIBandAudioProcessor::handleCommands(juce::MidiBuffer& midiMessages)
+{
+    CommandQueue::Command command;
+    
+    while (commandQueue.pop(command))
+    {
+        auto& settings = trackPlayback[static_cast<size_t>(command.trackIndex)].settings;
+        
+        switch (command.type)
+        {
+            case CommandQueue::Command::start:
+                isPlayingTracks = true;
+                restartPlayback(command.value);
+                break;
+                
+            case CommandQueue::Command::stop:
+                // Release whatever was sounding, at the start of this block
+                isPlayingTracks = false;
+                releaseActiveNotes(midiMessages, 0);
+                break;
+                
+            case CommandQueue::Command::seek:
+                restartPlayback(command.value);
+                break;
+                
+            case CommandQueue::Command::setTempo:
+                internalClock.setTempo(command.value, static_cast<juce::int64>(std::llround(command.secondValue * hostSampleRate)));
+                break;
+                
+            case CommandQueue::Command::setTrackMuted:        settings.muted = command.value != 0.0; break;
+            case CommandQueue::Command::setTrackSoloed:       settings.soloed = command.value != 0.0; break;
+            case CommandQueue::Command::setTrackTimingOffset: settings.timingOffsetMs = command.value; break;
+            case CommandQueue::Command::setHandoffBars:       handoffBarsSetting = static_cast<int>(command.value); break;
+            
+            default:
+                jassertfalse;
+                break;
+        }
+    }
+    
+    if (commandsDropped.exchange(false))
+        resyncControls(midiMessages);
+}
+
+void AIBandAudioProcessor::resyncControls(juce::MidiBuffer& midiMessages)
+{
+    // Some commands were lost to a full queue: take the mix, the play state
+    // and any lost jump or tempo change straight from what was last requested
+    for (size_t i = 0; i < trackControls.size(); ++i)
+    {
+        auto& controls = trackControls[i];
+        auto& settings = trackPlayback[i].settings;
+        
+        settings.muted = controls.muted.load();
+        settings.soloed = controls.soloed.load();
+        settings.timingOffsetMs = controls.timingOffsetMs.load();
+    }
+    
+    handoffBarsSetting = handoffBars.load();
+    
+    if (tempoDropped.exchange(false))
+        internalClock.setTempo(requestedTempoBpm.load(),
+                               static_cast<juce::int64>(std::llround(requestedTempoRamp.load() * hostSampleRate)));
+    
+    auto restart = seekDropped.exchange(false);
+    
+    if (playing.load() != isPlayingTracks)
+    {
+        isPlayingTracks = !isPlayingTracks;
+        
+        if (isPlayingTracks)
+            restart = true;
+        else
+            releaseActiveNotes(midiMessages, 0);
+    }
+    
+    if (restart)
+        restartPlayback(requestedBeat.load());
+}
+
+void AIBandAudioProcessor::restartPlayback(double beat)
+{
+    currentBeat = beat;
+    internalClock.reset(beat);
+    nextBlockStartBeat = -1.0;
+    
+    for (auto& track : trackPlayback)
+        track.cursor.reset();
+}
+
 void AIBandAudioProcessor::processMidiEvents(juce::MidiBuffer& midiMessages, int numSamples)
 {
-    // Calculate the beat range for this audio block
+    // Calculate the beat range for this audio block from the current tempo
+    double samplesPerBeat = hostSampleRate / beatsPerSecond;
     double startBeat = currentBeat;
-    double endBeat = currentBeat + (numSamples / hostSampleRate) * beatsPerSecond;
     
-    // Load MIDI events for this time range
-    currentMidiBuffer.clear();
-    loadMidiFromBuffer(bassMidiData, currentMidiBuffer, startBeat, endBeat);
-    loadMidiFromBuffer(drumMidiData, currentMidiBuffer, startBeat, endBeat);
+    // Events are normally merged straight into the host's buffer. Incoming
+    // MIDI later than the block start would have to be interleaved, so then
+    // the tracks are rendered on the side and inserted afterwards.
+    bool renderInPlace = midiMessages.isEmpty() || midiMessages.getLastEventTime() <= 0;
+    auto& renderBuffer = eventBuffers->tracks;
+    auto& output = renderInPlace ? midiMessages : renderBuffer;
+    auto numTracks = static_cast<size_t>(trackExchange.getCurrent().getNumTracks());
+    
+    renderBuffer.clear();
+    
+    // After a restart no track has a position until it reaches the jump to
+    // the new one; tracks dropped from the table are released right away
+    if (nextBlockStartBeat < 0.0)
+    {
+        for (size_t i = 0; i < trackPlayback.size(); ++i)
+        {
+            auto& track = trackPlayback[i];
+            track.running = false;
+            track.nextJump = numJumps;
+            
+            if (i >= numTracks && !track.notes.isEmpty())
+                track.notes.releaseAll(output, 0);
+        }
+    }
+    
+    applyTrackControls(samplesPerBeat);
+    
+    // When the playhead simply moved on from the previous block, continue
+    // exactly where it ended so rounding noise does not make the cursors seek.
+    // Otherwise it jumped (seek, loop, restart, new tracks) and playback
+    // restarts from the new position.
+    int firstJumpSample = -1;
+    
+    if (std::abs(startBeat - nextBlockStartBeat) < 0.5 / samplesPerBeat)
+    {
+        startBeat = nextBlockStartBeat;
+    }
+    else
+    {
+        queueJump(renderedSamples, nextBlockStartBeat, startBeat, 0.0);
+        firstJumpSample = 0;
+    }
+    
+    // When the host loop end falls inside the block, playback wraps to the
+    // loop start at that sample. The beat arithmetic stays exact so the line
+    // after the last wrap meets the host's next position; a wrap rounding
+    // onto the block end is taken at the start of the next block. Loops
+    // shorter than a sample cannot be resolved and play straight through.
+    bool wraps = hostLooping && startBeat < loopEndBeat
+                 && (loopEndBeat - loopStartBeat) * samplesPerBeat >= 1.0;
+    
+    double beat = startBeat;
+    double beatsLeft = numSamples / samplesPerBeat;
+    double beatsDone = 0.0;
+    
+    while (wraps && beat + beatsLeft > loopEndBeat)
+    {
+        auto wrapTime = (beatsDone + loopEndBeat - beat) * samplesPerBeat;
+        auto wrapSample = juce::roundToInt(wrapTime);
+        
+        queueJump(renderedSamples + wrapSample, loopEndBeat, loopStartBeat, wrapSample - wrapTime);
+        
+        if (firstJumpSample < 0)
+            firstJumpSample = wrapSample;
+        
+        beatsLeft -= loopEndBeat - beat;
+        beatsDone += loopEndBeat - beat;
+        beat = loopStartBeat;
+    }
+    
+    nextBlockStartBeat = beat + beatsLeft;
+    
+    // New tracks waiting for a bar line take over at this sample, if any
+    int handoffSample = handoffQueued ? findHandoffSample(startBeat, numSamples, samplesPerBeat, firstJumpSample) : -1;
+    
+    // A track that was muted, unmuted or moved in time restarts the notes it
+    // holds with its new settings. Re-baked events only replace the notes
+    // that changed, so a new gain, like before, only affects new notes.
+    for (size_t i = 0; i < numTracks; ++i)
+    {
+        auto& track = trackPlayback[i];
+        bool eventsChanged = std::exchange(track.timelineChanged, false);
+        
+        if (!(track.controlsChanged || eventsChanged) || !track.running || getNextJumpOffset(track) <= 0)
+            continue;
+        
+        if (!track.controlsChanged && track.audible && track.chasesNotes && getRenderEndOffset(track) > 0)
+        {
+            trackExchange.getCurrent().getTrack(static_cast<int>(i)).handOffNotesAtBeat(track.nextBeat, output, 0, track.notes);
+        }
+        else
+        {
+            track.notes.releaseAll(output, 0);
+            chaseTrack(output, static_cast<int>(i), track.nextBeat, 0);
+        }
+    }
+    
+    // Each track takes the queued jumps when its own delayed playhead reaches
+    // them, so the block is rendered in ranges split at those points
+    int sampleOffset = 0;
+    
+    while (sampleOffset < numSamples)
+    {
+        if (sampleOffset == handoffSample)
+        {
+            handOffTracks(output, sampleOffset);
+            numTracks = static_cast<size_t>(trackExchange.getCurrent().getNumTracks());
+        }
+        
+        followJumps(output, sampleOffset);
+        
+        auto rangeEnd = static_cast<juce::int64>(numSamples);
+        
+        for (size_t i = 0; i < numTracks; ++i)
+        {
+            rangeEnd = juce::jmin(rangeEnd, getNextJumpOffset(trackPlayback[i]));
+            
+            auto endOffset = getRenderEndOffset(trackPlayback[i]);
+            
+            if (endOffset > sampleOffset)
+                rangeEnd = juce::jmin(rangeEnd, endOffset);
+        }
+        
+        if (handoffSample > sampleOffset)
+            rangeEnd = juce::jmin(rangeEnd, static_cast<juce::int64>(handoffSample));
+        
+        renderTracks(output, sampleOffset, static_cast<int>(rangeEnd), samplesPerBeat);
+        sampleOffset = static_cast<int>(rangeEnd);
+    }
+    
+    renderedSamples += numSamples;
     
     // Add the generated MIDI events to the output
-    midiMessages.addEvents(currentMidiBuffer, 0, numSamples, 0);
+    if (!renderInPlace)
+        midiMessages.addEvents(renderBuffer, 0, numSamples, 0);
+}
+
+void AIBandAudioProcessor::renderTracks(juce::MidiBuffer& output, int startSample, int endSample, double samplesPerBeat)
+{
+    // One merge over all audible tracks appends their events to the output in
+    // time order, with ticks mapped to samples
+    static_assert(TrackExchange::maxTracks <= MidiTimeline::maxMergeSources,
+                  "every track must fit in one merged render");
+    
+    const auto& tracks = trackExchange.getCurrent();
+    MidiTimeline::MergeSource sources[TrackExchange::maxTracks];
+    int numSources = 0;
+    
+    for (int i = 0; i < tracks.getNumTracks(); ++i)
+    {
+        auto& track = trackPlayback[static_cast<size_t>(i)];
+        
+        if (!track.running)
+            continue;
+        
+        // Muted tracks keep their position too, so unmuting lands in place
+        auto windowStart = track.nextBeat;
+        auto windowEnd = windowStart + (endSample - startSample + track.jumpLead) / samplesPerBeat;
+        
+        // A track reaching a jump stops exactly where the host's line did
+        if (getNextJumpOffset(track) == endSample)
+            windowEnd = juce::jmax(windowStart, pendingJumps[static_cast<size_t>(track.nextJump % maxPendingJumps)].fromBeat);
+        
+        track.nextBeat = windowEnd;
+        track.jumpLead = 0.0;
+        
+        if (track.audible && getRenderEndOffset(track) > startSample)
+            sources[numSources++] = { &tracks.getTrack(i), &track.cursor, &track.notes, windowStart, windowEnd };
+    }
+    
+    MidiTimeline::renderMergedBeatWindows(sources, numSources, samplesPerBeat, output, startSample, endSample - startSample);
+}
+
+void AIBandAudioProcessor::queueJump(juce::int64 samplePosition, double fromBeat, double toBeat, double lead)
+{
+    // The oldest entry is overwritten; only a loop of a few samples against
+    // a long delay wraps this often, and the tracks then skip to what is kept
+    pendingJumps[static_cast<size_t>(numJumps % maxPendingJumps)] = { samplePosition, fromBeat, toBeat, lead };
+    ++numJumps;
+}
+
+void AIBandAudioProcessor::followJumps(juce::MidiBuffer& output, int sampleOffset)
+{
+    // The notes started before a jump are released, and notes held across
+    // the new position are re-triggered so a sustained note is not lost.
+    // All releases at this sample come before the chased note-ons.
+    auto numTracks = static_cast<size_t>(trackExchange.getCurrent().getNumTracks());
+    std::array<bool, TrackExchange::maxTracks> jumped {};
+    
+    for (size_t i = 0; i < numTracks; ++i)
+    {
+        auto& track = trackPlayback[i];
+        track.nextJump = juce::jmax(track.nextJump, numJumps - maxPendingJumps);
+        
+        // Several jumps reached at once only leave the last position
+        while (getNextJumpOffset(track) <= sampleOffset)
+        {
+            const auto& jump = pendingJumps[static_cast<size_t>(track.nextJump++ % maxPendingJumps)];
+            track.nextBeat = jump.toBeat;
+            track.jumpLead = jump.lead;
+            track.running = true;
+            jumped[i] = true;
+        }
+        
+        if (jumped[i])
+            track.notes.releaseAll(output, sampleOffset);
+    }
+    
+    for (size_t i = 0; i < numTracks; ++i)
+        if (jumped[i])
+            chaseTrack(output, static_cast<int>(i), trackPlayback[i].nextBeat, sampleOffset);
+}
+
+juce::int64 AIBandAudioProcessor::getNextJumpOffset(const TrackPlayback& track) const
+{
+    // Sample of the current block at which the track reaches its next jump
+    if (track.nextJump >= numJumps)
+        return std::numeric_limits<juce::int64>::max();
+    
+    return pendingJumps[static_cast<size_t>(track.nextJump % maxPendingJumps)].samplePosition
+           + track.delaySamples - renderedSamples;
+}
+
+juce::int64 AIBandAudioProcessor::getRenderEndOffset(const TrackPlayback& track) const
+{
+    // Sample of the current block at which the track has played everything
+    // an offline render asked for; it then falls silent until the render ends
+    if (renderEndSample < 0)
+        return std::numeric_limits<juce::int64>::max();
+    
+    return renderEndSample + track.delaySamples - renderedSamples;
+}
+
+void AIBandAudioProcessor::chaseTrack(juce::MidiBuffer& output, int trackIndex, double beat, int sampleOffset)
+{
+    auto& track = trackPlayback[static_cast<size_t>(trackIndex)];
+    
+    if (track.audible && track.chasesNotes && getRenderEndOffset(track) > sampleOffset)
+        trackExchange.getCurrent().getTrack(trackIndex).chaseNotesAtBeat(beat, output, sampleOffset,
+                                                                         &track.notes);
+}
+
+void AIBandAudioProcessor::applyTrackControls(double samplesPerBeat)
+{
+    // The settings come from the command queue; here they are turned into
+    // what the render loop uses
+    auto numTracks = static_cast<size_t>(trackExchange.getCurrent().getNumTracks());
+    double earliestOffsetMs = 0.0;
+    bool anySoloed = false;
+    
+    // Every track, loaded or not, as for the latency reported to the host
+    for (const auto& track : trackPlayback)
+        earliestOffsetMs = juce::jmin(earliestOffsetMs, track.settings.timingOffsetMs);
+    
+    for (size_t i = 0; i < numTracks; ++i)
+        anySoloed |= trackPlayback[i].settings.soloed;
+    
+    auto latencySamples = juce::roundToInt(-earliestOffsetMs * hostSampleRate / 1000.0);
+    
+    for (size_t i = 0; i < numTracks; ++i)
+    {
+        auto& track = trackPlayback[i];
+        const auto& settings = track.settings;
+        
+        bool audible = !settings.muted && (!anySoloed || settings.soloed);
+        
+        // The earliest track plays right at the host playhead and the others
+        // follow it; a changed delay moves the track's position by the difference
+        auto offsetSamples = juce::roundToInt(settings.timingOffsetMs * hostSampleRate / 1000.0);
+        auto delaySamples = juce::jmax(0, latencySamples + offsetSamples);
+        bool delayChanged = delaySamples != track.delaySamples;
+        
+        if (delayChanged && track.running)
+            track.nextBeat -= (delaySamples - track.delaySamples) / samplesPerBeat;
+        
+        // A mute or timing change needs the held notes moved
+        track.controlsChanged = audible != track.audible || delayChanged;
+        track.audible = audible;
+        track.delaySamples = delaySamples;
+    }
+}
+
+int AIBandAudioProcessor::calculateLatencySamples() const
+{
+    // Every track, loaded or not, so the value only changes with the settings
+    double earliestOffsetMs = 0.0;
+    
+    for (const auto& controls : trackControls)
+        earliestOffsetMs = juce::jmin(earliestOffsetMs, controls.timingOffsetMs.load(std::memory_order_relaxed));
+    
+    return juce::roundToInt(-earliestOffsetMs * hostSampleRate / 1000.0);
 }
 
 void AIBandAudioProcessor::updatePlaybackPosition(int numSamples)
@@ -309,6 +1196,9 @@ void AIBandAudioProcessor::updatePlaybackPosition(int numSamples)
             if (positionInfo.isPlaying && positionInfo.ppqPosition >= 0)
             {
                 currentBeat = positionInfo.ppqPosition;
+                hostLooping = positionInfo.isLooping && positionInfo.ppqLoopEnd > positionInfo.ppqLoopStart;
+                loopStartBeat = positionInfo.ppqLoopStart;
+                loopEndBeat = positionInfo.ppqLoopEnd;
                 if (positionInfo.bpm > 0)
                     beatsPerSecond = positionInfo.bpm / 60.0;
                 return;
@@ -316,76 +1206,237 @@ void AIBandAudioProcessor::updatePlaybackPosition(int numSamples)
         }
     }
     
-    // Fall back to internal clock
-    samplesSinceLastBeat += numSamples;
-    double samplesPerBeat = hostSampleRate / beatsPerSecond;
+    // Fall back to the internal transport. The block is rendered at its
+    // average tempo, so the block ends exactly where the clock does even
+    // while the tempo ramps, and the next block continues without a seek.
+    hostLooping = false;
+    currentBeat = internalClock.getBeatPosition();
+    internalClock.advance(numSamples);
     
-    while (samplesSinceLastBeat >= samplesPerBeat)
-    {
-        currentBeat += 1.0;
-        samplesSinceLastBeat -= static_cast<int>(samplesPerBeat);
-    }
+    if (numSamples > 0)
+        beatsPerSecond = (internalClock.getBeatPosition() - currentBeat) * hostSampleRate / numSamples;
 }
 
-void AIBandAudioProcessor::checkForNewMidiFiles()
+void AIBandAudioProcessor::applyPendingTracks()
 {
-    // Check for new files every 500ms to avoid excessive file system calls
-    auto now = juce::Time::getCurrentTime();
-    if (now.toMilliseconds() - lastFolderCheck.toMilliseconds() < 500)
+    // Loader threads publish immutable snapshots; adopting one only moves a
+    // pointer, and the previous snapshot is freed on a loader thread
+    const auto* incoming = trackExchange.receive();
+    handoffQueued = false;
+    
+    if (incoming == nullptr)
+    {
+        handoffBeat = -1.0;
         return;
-        
-    lastFolderCheck = now;
+    }
     
-    if (monitoredFolder.isEmpty())
+    // Denser tracks come with grown buffers, taken at the start of a block;
+    // tracks published after that start wait in the queue for the next one
+    if (incoming->maxEventsPerBeat > eventBuffers->eventsPerBeat)
         return;
-        
-    juce::File folder(monitoredFolder);
-    if (!folder.exists() || !folder.isDirectory())
+    
+    // New files arriving while playing wait for a bar line, where
+    // handOffTracks() switches to them. A jump in this block (start, seek)
+    // is as clean a place to switch, so then they take over right away.
+    bool newFiles = incoming->loadGeneration != playingLoadGeneration;
+    bool handOff = isPlayingTracks && handoffBarsSetting > 0;
+    
+    if (newFiles && handOff && nextBlockStartBeat >= 0.0)
+    {
+        handoffQueued = true;
         return;
-        
-    // Look for bass and drum MIDI files
-    auto files = folder.findChildFiles(juce::File::findFiles, false, "*.mid");
+    }
+    
+    if (trackExchange.switchToQueued())
+        adoptSnapshot(newFiles && !handOff);
+}
+
+void AIBandAudioProcessor::adoptSnapshot(bool restart)
+{
+    // Tracks generated together share their tempo; use the first that has one
+    const auto& snapshot = trackExchange.getCurrent();
+    playingTempoMap = nullptr;
+    tempoCursor.reset();
+    
+    for (int i = 0; i < snapshot.getNumTracks() && playingTempoMap == nullptr; ++i)
+        playingTempoMap = snapshot.getTrack(i).getTempoMap().get();
     
-    juce::String bassFile, drumFile;
-    for (auto& file : files)
+    trackTempoBpm.store(playingTempoMap != nullptr ? playingTempoMap->getTempoAt(0.0) : 0.0);
+    playingLoadGeneration = snapshot.loadGeneration;
+    
+    // Without a restart, tracks that changed carry on where they are with
+    // their held notes moved over
+    for (int i = 0; i < snapshot.getNumTracks(); ++i)
     {
-        auto filename = file.getFileName().toLowerCase();
-        if (filename.contains("bass"))
-            bassFile = file.getFullPathName();
-        else if (filename.contains("drum"))
-            drumFile = file.getFullPathName();
+        auto& track = trackPlayback[static_cast<size_t>(i)];
+        const auto* timeline = &snapshot.getTrack(i);
+        
+        if (timeline != track.timeline && !restart)
+        {
+            track.cursor.reset();
+            track.timelineChanged = true;
+        }
+        
+        track.timeline = timeline;
     }
     
-    // Load new files if found
-    if (bassFile.isNotEmpty() || drumFile.isNotEmpty())
+    // Reset playback position when new files are loaded while stopped
+    if (restart)
+        restartPlayback(0.0);
+}
+
+int AIBandAudioProcessor::findHandoffSample(double startBeat, int numSamples, double samplesPerBeat, int firstJumpSample)
+{
+    // Scheduled on the bar lines of the tracks playing now, from the first
+    // block that plays while the new ones wait
+    if (handoffBeat < 0.0)
     {
-        loadMidiFiles(bassFile, drumFile);
+        const auto& tempoMap = playingTempoMap != nullptr ? *playingTempoMap : defaultTempoMap;
+        handoffBeat = tempoMap.getNextBarLine(startBeat, handoffBarsSetting);
     }
+    
+    // Rounded down, so the outgoing tracks stop short of the bar line and the
+    // incoming ones play an event right on it
+    auto barLineSample = juce::jmax(0.0, std::floor((handoffBeat - startBeat) * samplesPerBeat));
+    
+    // A seek or loop wrap before the bar line switches there instead
+    if (firstJumpSample >= 0 && firstJumpSample <= barLineSample)
+        return firstJumpSample < numSamples ? firstJumpSample : -1;
+    
+    return barLineSample < numSamples ? static_cast<int>(barLineSample) : -1;
 }
 
-void AIBandAudioProcessor::loadMidiFromBuffer(const juce::MidiBuffer& source, juce::MidiBuffer& destination, double startBeat, double endBeat)
+void AIBandAudioProcessor::handOffTracks(juce::MidiBuffer& output, int sampleOffset)
 {
-    // Convert beat positions to sample positions for this block
-    double samplesPerBeat = hostSampleRate / beatsPerSecond;
-    int startSample = static_cast<int>((startBeat) * samplesPerBeat);
-    int endSample = static_cast<int>((endBeat) * samplesPerBeat);
+    // If a loader thread has not yet collected the snapshot replaced by the
+    // previous switch, the next bar line is tried instead
+    auto previousNumTracks = trackExchange.getCurrent().getNumTracks();
+    handoffBeat = -1.0;
+    
+    if (!trackExchange.switchToQueued())
+        return;
+    
+    handoffQueued = false;
+    adoptSnapshot(false);
     
-    // Extract MIDI events within the time range
-    for (auto it = source.cbegin(); it != source.cend(); ++it)
+    const auto& snapshot = trackExchange.getCurrent();
+    
+    for (int i = 0; i < snapshot.getNumTracks(); ++i)
     {
-        auto metadata = (*it);
-        int eventSample = metadata.samplePosition;
+        auto& track = trackPlayback[static_cast<size_t>(i)];
         
-        // Check if event falls within our time range
-        if (eventSample >= startSample && eventSample < endSample)
+        // Slots new to the table start from the bass track's position; their
+        // own timing offset is applied at the next block
+        if (i >= previousNumTracks)
         {
-            // Calculate relative position within this audio block
-            int relativeSample = eventSample - startSample;
-            destination.addEvent(metadata.getMessage(), relativeSample);
+            const auto& reference = trackPlayback[TrackExchange::bassTrack];
+            track.nextBeat = reference.nextBeat;
+            track.jumpLead = reference.jumpLead;
+            track.nextJump = reference.nextJump;
+            track.running = reference.running;
+            track.delaySamples = reference.delaySamples;
         }
+        
+        if (!track.timelineChanged)
+            continue;
+        
+        track.timelineChanged = false;
+        
+        // A track taking a jump right here releases and chases the new notes anyway
+        if (!track.running || getNextJumpOffset(track) == sampleOffset)
+            continue;
+        
+        if (track.audible && track.chasesNotes)
+            snapshot.getTrack(i).handOffNotesAtBeat(track.nextBeat, output, sampleOffset, track.notes);
+        else
+            track.notes.releaseAll(output, sampleOffset);
+    }
+}
+
+void AIBandAudioProcessor::reserveEventBuffers()
+{
+    const juce::ScopedLock lock(eventBufferLock);
+    
+    reservedBeatsPerBlock = hostBlockSize * (maxReservedTempoBpm / 60.0) / hostSampleRate;
+    reservedEventsPerBeat = juce::jmax(minReservedEventsPerBeat, trackExchange.getPeakEventsPerBeat());
+    
+    // The audio thread is not running, so its buffers are replaced directly
+    eventBuffers = createEventBuffers(reservedEventsPerBeat);
+    delete grownEventBuffers.exchange(nullptr, std::memory_order_acq_rel);
+    delete retiredEventBuffers.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+void AIBandAudioProcessor::growEventBuffers(int peakEventsPerBeat)
+{
+    // Runs on the thread publishing denser tracks before they go out, so the
+    // audio thread never adopts them with buffers that would have to grow
+    const juce::ScopedLock lock(eventBufferLock);
+    
+    if (peakEventsPerBeat <= reservedEventsPerBeat)
+        return;
+    
+    reservedEventsPerBeat = peakEventsPerBeat;
+    delete grownEventBuffers.exchange(createEventBuffers(reservedEventsPerBeat).release(), std::memory_order_acq_rel);
+    
+    // Freed only once the new buffers are in place, so the audio thread is
+    // never left with outgrown ones it has nowhere to hand back
+    delete retiredEventBuffers.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+std::unique_ptr<AIBandAudioProcessor::EventBuffers> AIBandAudioProcessor::createEventBuffers(int eventsPerBeat) const
+{
+    // A block can span at most ceil(beatsPerBlock) quarter notes of the densest
+    // track, plus one for the tick rounding at each edge of the block and of
+    // one host loop wrap inside it
+    auto maxEventsPerBlock = eventsPerBeat * (static_cast<int>(std::ceil(reservedBeatsPerBlock)) + 2);
+    
+    // Plus, for a jump at the block start and a loop wrap, a note-off and a
+    // chased note-on for every note the tracks could be holding
+    maxEventsPerBlock += 2 * 2 * maxReservedHeldNotes;
+    
+    // MidiBuffer stores a 32-bit position and a 16-bit size in front of each
+    // message; timeline messages of up to 4 bytes are the common case
+    const size_t bytesPerEvent = sizeof(juce::int32) + sizeof(juce::uint16) + 4;
+    
+    auto buffers = std::make_unique<EventBuffers>();
+    buffers->eventsPerBeat = eventsPerBeat;
+    buffers->eventBytes = static_cast<size_t>(maxEventsPerBlock) * bytesPerEvent;
+    buffers->tracks.ensureSize(buffers->eventBytes);
+    
+    // The output holds incoming MIDI as well, so it and the spares that may
+    // replace a host's buffer have a block's worth of room to spare for it
+    buffers->output.ensureSize(2 * buffers->eventBytes);
+    
+    for (auto& spare : buffers->spares)
+        spare.ensureSize(2 * buffers->eventBytes);
+    
+    buffers->numSpares = static_cast<int>(buffers->spares.size());
+    return buffers;
+}
+
+void AIBandAudioProcessor::takeGrownEventBuffers() noexcept
+{
+    // The outgrown buffers wait in the retired slot for the next loader to
+    // free them; until it has, grown ones stay where they are
+    if (retiredEventBuffers.load(std::memory_order_acquire) != nullptr)
+        return;
+    
+    if (auto* grown = grownEventBuffers.exchange(nullptr, std::memory_order_acq_rel))
+    {
+        retiredEventBuffers.store(eventBuffers.release(), std::memory_order_release);
+        eventBuffers.reset(grown);
     }
 }
 
+void AIBandAudioProcessor::releaseActiveNotes(juce::MidiBuffer& midiMessages, int samplePosition)
+{
+    // Exactly one note-off per sounding note, instead of all-notes-off on 16
+    // channels; tracks dropped from the table are released here as well
+    for (auto& track : trackPlayback)
+        if (!track.notes.isEmpty())
+            track.notes.releaseAll(midiMessages, samplePosition);
+}
+
 //==============================================================================
 // This creates new instances of the plugin
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -1,8 +1,19 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include "ActiveNotes.h"
+#include "CommandQueue.h"
+#include "EventTransform.h"
+#include "MidiFolderWatcher.h"
 #include "MidiManager.h"
+#include "MidiTimeline.h"
 #include "NetworkClient.h"
+#include "TimelineCache.h"
+#include "TrackExchange.h"
+#include "TransportClock.h"
 
 //==============================================================================
 /**
@@ -14,7 +25,46 @@
     GitHub: https://github.com/sergiecode
     
     This class handles the core audio processing and MIDI functionality.
-    It integrates with the ai-band-backend to play AI-generated bass and drum tracks.
+    It integrates with the ai-band-backend to play AI-generated bass and drum tracks,
+    and any further instruments loaded into the track table. Every track has
+    its own channel routing, gain, mute, solo and timing offset, and all of
+    them are rendered by the same loop.
+    
+    Timing offsets go through the host's latency compensation: the earliest
+    track's offset is reported as the plugin latency, and every track follows
+    the host playhead by its own delay against it. Wraps and seeks of the
+    playhead are queued, so a delayed track reaches them at its own time.
+    
+    Newly generated tracks that arrive while playing take over at a bar line
+    of the playing tracks' time signatures, by default the next one. The new
+    snapshot is complete when it arrives, so the switch only moves a pointer;
+    notes held across the bar line by both generations carry on, the others
+    are released or chased. A seek or loop wrap before the bar line switches
+    there instead. When stopped, new tracks replace the old ones at once.
+    
+    Playback controls never touch the audio thread's state directly: they are
+    sent through a CommandQueue that processBlock() drains at the start of
+    each block. Getters report the last requested state. A track's channel
+    and gain are the exception: they are baked into its events together
+    with its EventTransform, so the render loop copies events as they are.
+    
+    processBlock() does not allocate once prepareToPlay() has run: the render
+    buffers are reserved there from the densest tracks published so far (with
+    a generous floor), and everything else it touches is fixed-size. Denser
+    tracks get larger buffers built on the thread publishing them, before
+    they go out; the audio thread takes them over between blocks. Events
+    are merged in a reserved buffer and copied into the host's MidiBuffer;
+    one too small for them is swapped for a reserved spare instead of being
+    grown, so a host that keeps its buffers has the room from then on.
+    
+    Track files are parsed through the process-wide TimelineCache, so every
+    instance loading the same file plays one shared, read-only timeline.
+    Compiled tracks are also stored in a CompiledTrackCache folder next to
+    the files' own, so reloading a session maps them instead of parsing.
+    
+    renderToMidiFile() plays the tracks through processBlock() with a
+    simulated playhead, as fast as the machine allows, for batch export. It
+    runs on a processor of its own, so playback here goes on meanwhile.
 */
 class AIBandAudioProcessor : public juce::AudioProcessor
 {
@@ -62,6 +112,77 @@ public:
     /** Load MIDI files from ai-band-backend output */
     bool loadMidiFiles(const juce::String& bassFilePath, const juce::String& drumFilePath);
     
+    /** Load MIDI files into the track table
+        @param filePaths    File for each track slot (see TrackExchange::TrackSlot);
+                            empty paths keep the loaded track
+        @returns true if every file was loaded (nothing is replaced otherwise)
+    */
+    bool loadTrackFiles(const juce::StringArray& filePaths);
+    
+    //==============================================================================
+    // Playback and mix controls can be called from any thread; they take
+    // effect at the start of the next block
+    
+    /** Route a track to a MIDI channel
+        Re-bakes the track like setTrackTransform(), after its transform.
+        @param trackIndex   Track slot
+        @param channel      Output channel 1-16, or 0 to keep the recorded channels
+    */
+    void setTrackChannel(int trackIndex, int channel);
+    
+    /** Scale the note-on velocities of a track (1.0 = as recorded)
+        Re-bakes the track like setTrackTransform(), after its transform.
+    */
+    void setTrackGain(int trackIndex, float gain);
+    
+    /** Mute or unmute a track */
+    void setTrackMuted(int trackIndex, bool shouldBeMuted);
+    
+    /** Solo a track; while any track is soloed, only soloed tracks play */
+    void setTrackSoloed(int trackIndex, bool shouldBeSoloed);
+    
+    /** Move a track earlier or later in time, e.g. to make up for the
+        latency of an external sound module
+        The earliest offset of all tracks is reported to the host as latency.
+        @param trackIndex   Track slot
+        @param milliseconds Negative to send the track early, positive to send
+                            it late; limited to +/- maxTimingOffsetMs
+    */
+    void setTrackTimingOffset(int trackIndex, double milliseconds);
+    
+    /** Largest timing offset a track can be given, either way */
+    static constexpr double maxTimingOffsetMs = 50.0;
+    
+    /** Set the transform (velocity curve, transposition, note and channel
+        maps) baked into a track
+        The track is re-baked on a worker thread and swapped in at a block
+        boundary without restarting playback; its held notes are chased
+        with the new events.
+    */
+    void setTrackTransform(int trackIndex, const EventTransform& transform);
+    
+    /** Get the transform set for a track, without its channel and gain */
+    EventTransform getTrackTransform(int trackIndex) const;
+    
+    /** Wait until the transforms, channels and gains set so far are baked
+        into the tracks (not on the audio thread)
+        @returns false if the bake did not finish within the timeout
+    */
+    bool waitForTransforms(int timeoutMs);
+    
+    /** Set when newly generated tracks take over while playing
+        @param numBars  1 for the next bar line, 2 for the one after and so
+                        on, up to maxHandoffBars; 0 to switch at once and
+                        restart from the beginning, as when stopped
+    */
+    void setHandoffBars(int numBars);
+    
+    /** Get how many bar lines new tracks wait for while playing */
+    int getHandoffBars() const { return handoffBars.load(); }
+    
+    /** Longest wait for a handoff, in bars */
+    static constexpr int maxHandoffBars = 16;
+    
     /** Start playing the loaded MIDI tracks */
     void startPlayback();
     
@@ -69,48 +190,263 @@ public:
     void stopPlayback();
     
     /** Check if MIDI tracks are currently playing */
-    bool isPlaying() const { return isPlayingTracks; }
+    bool isPlaying() const { return playing.load(); }
     
     /** Set the folder to monitor for new MIDI files */
     void setMidiFolder(const juce::String& folderPath);
     
+    /** Events per quarter note the render buffer is always reserved for */
+    static constexpr int minReservedEventsPerBeat = 256;
+    
+    /** Fastest tempo the render buffer is reserved for */
+    static constexpr double maxReservedTempoBpm = 300.0;
+    
+    /** Notes held across all tracks that a jump is reserved to release and chase */
+    static constexpr int maxReservedHeldNotes = 4096;
+    
+    /** Playhead wraps and seeks remembered for tracks still delayed behind them */
+    static constexpr int maxPendingJumps = 256;
+    
     /** Get current playback position in beats */
-    double getCurrentBeat() const { return currentBeat; }
+    double getCurrentBeat() const { return displayedBeat.load(); }
+    
+    /** Get the tempo the loaded tracks were written at, at the current
+        position, or 0 if no loaded file had tempo information
+    */
+    double getTrackTempo() const { return trackTempoBpm.load(); }
     
     /** Reset playback position to beginning */
     void resetPlayback();
+    
+    /** Move the internal transport to a position in beats
+        A host transport, when playing, keeps its own position.
+    */
+    void setPlaybackPosition(double beat);
+    
+    /** Set the tempo of the internal transport used when the host provides none
+        @param bpm          New tempo in beats per minute
+        @param rampSeconds  Time over which the tempo glides to bpm (0 = immediately)
+    */
+    void setInternalTempo(double bpm, double rampSeconds = 0.0);
+    
+    /** Get how many folder reloads were performed or skipped as unchanged */
+    MidiFolderWatcher::ReloadStatistics getReloadStatistics() const { return folderWatcher.getReloadStatistics(); }
+    
+    /** Get the counters and memory of the parsed tracks shared by all instances */
+    TimelineCache::Statistics getTimelineCacheStatistics() const { return timelineCache->getStatistics(); }
+    
+    //==============================================================================
+    // Offline rendering
+    
+    /** What renderToMidiFile() plays */
+    struct OfflineRenderOptions
+    {
+        double sampleRate = 44100.0;
+        int blockSize = 512;
+        double startBeat = 0.0;         /**< Where the simulated playhead starts */
+        double lengthInBeats = 0.0;     /**< Beats to play, loop repeats included; 0 = the longest track */
+        double tempoBpm = 0.0;          /**< Fixed tempo, or 0 to follow the tracks' tempo map */
+        double loopStartBeat = 0.0;     /**< Loop region, used when loopEndBeat is after loopStartBeat */
+        double loopEndBeat = 0.0;
+    };
+    
+    /** Results of renderToMidiFile() */
+    struct OfflineRenderStatistics
+    {
+        int numEvents = 0;              /**< Events written to the file */
+        double renderedSeconds = 0.0;   /**< Length of the rendered arrangement */
+        double elapsedSeconds = 0.0;    /**< Time the render took, writing included */
+        
+        double getEventsPerSecond() const { return elapsedSeconds > 0.0 ? numEvents / elapsedSeconds : 0.0; }
+        double getRealtimeFactor() const { return elapsedSeconds > 0.0 ? renderedSeconds / elapsedSeconds : 0.0; }
+    };
+    
+    /** Render the loaded tracks to a MIDI file as fast as possible
+        The tracks go through processBlock() as they would in a host, driven
+        by a simulated playhead, so tempo changes, loops, timing offsets,
+        transforms and the mix all apply. The reported latency is taken out
+        again, as a host does when bouncing.
+        
+        The render runs on a processor of its own, given the snapshot that
+        is published here and the same mix, so it can run on any thread
+        while this instance goes on playing.
+        @param filePath     Output file, written with MidiManager::saveMidiFile()
+        @param options      What to play and at which sample rate
+        @param statistics   Optional, receives the event count and timing
+        @returns true if the file was written
+    */
+    bool renderToMidiFile(const juce::String& filePath, const OfflineRenderOptions& options,
+                          OfflineRenderStatistics* statistics = nullptr);
 
 private:
+    //==============================================================================
+    /** Mix settings of a track as last requested, kept for the host state
+        and the reported latency; the audio thread gets the channel and gain
+        baked into the track and the others as commands
+    */
+    struct TrackControls
+    {
+        std::atomic<int> channel { 0 };
+        std::atomic<float> gain { 1.0f };
+        std::atomic<bool> muted { false };
+        std::atomic<bool> soloed { false };
+        std::atomic<double> timingOffsetMs { 0.0 };
+    };
+    
+    /** Mix settings of a track on the audio thread */
+    struct TrackSettings
+    {
+        bool muted = false;
+        bool soloed = false;
+        double timingOffsetMs = 0.0;
+    };
+    
+    /** Audio thread state of a track; kept in one array for the render loop */
+    struct TrackPlayback
+    {
+        TrackSettings settings;
+        const MidiTimeline* timeline = nullptr;     // the track the cursor belongs to
+        bool timelineChanged = false;               // re-baked since the last block
+        MidiTimeline::Cursor cursor;
+        ActiveNotes notes;
+        bool audible = true;
+        bool chasesNotes = true;        // drum hits are one-shots and are not chased
+        bool controlsChanged = false;
+        
+        // Position of the track's own, delayed playhead
+        int delaySamples = 0;           // how far behind the host playhead it plays
+        double nextBeat = 0.0;          // where its next window starts
+        double jumpLead = 0.0;          // rounding of the jump it last took, absorbed by the next window
+        juce::int64 nextJump = 0;       // first entry of pendingJumps it has not reached
+        bool running = false;           // false from a restart until it reaches the new position
+    };
+    
+    /** Render buffers reserved for tracks of up to eventsPerBeat events per
+        quarter note; larger ones are built off the audio thread and handed
+        over whole, the way snapshots are
+    */
+    struct EventBuffers
+    {
+        int eventsPerBeat = 0;
+        size_t eventBytes = 0;          // the busiest block's events
+        juce::MidiBuffer tracks;        // tracks rendered on the side of incoming MIDI
+        juce::MidiBuffer output;        // incoming MIDI and the tracks, copied to the host's buffer
+        std::array<juce::MidiBuffer, 2> spares;     // swapped for host buffers too small for the copy
+        int numSpares = 0;              // the first numSpares have not been given away
+    };
+    
+    /** Host playhead stand-in for renderToMidiFile() */
+    class OfflinePlayHead;
+    
+    /** A wrap or seek of the host playhead, taken by each track after its delay */
+    struct PlayheadJump
+    {
+        juce::int64 samplePosition;     // rendered sample the jump happens at
+        double fromBeat;                // where the playhead line before it ends
+        double toBeat;                  // where playback continues
+        double lead;                    // samplePosition minus the exact, fractional jump time
+    };
+    
     //==============================================================================
     // Core components
     MidiManager midiManager;
+    juce::SharedResourcePointer<TimelineCache> timelineCache;
+    TrackExchange trackExchange;
+    MidiFolderWatcher folderWatcher;
     NetworkClient networkClient;
     
-    // Playback state
+    // Re-bakes changed track transforms off the audio and message threads
+    juce::ThreadPool transformBaker { 1 };
+    std::atomic<bool> bakeQueued { false };
+    juce::CriticalSection transformLock;
+    std::array<EventTransform, TrackExchange::maxTracks> trackTransforms;   // as set, before channel and gain
+    
+    // Controls sent to the audio thread, and the state they last requested
+    CommandQueue commandQueue;
+    std::atomic<bool> commandsDropped { false };
+    std::atomic<bool> playing { false };
+    std::atomic<double> displayedBeat { 0.0 };
+    std::atomic<double> requestedBeat { 0.0 };         // of the last start or seek
+    std::atomic<double> requestedTempoBpm { 120.0 };
+    std::atomic<double> requestedTempoRamp { 0.0 };    // seconds
+    std::atomic<bool> seekDropped { false };
+    std::atomic<bool> tempoDropped { false };
+    std::atomic<int> handoffBars { 1 };
+    
+    // Playback state (audio thread)
     bool isPlayingTracks;
     double currentBeat;
     double beatsPerSecond;
-    int samplesSinceLastBeat;
+    TransportClock internalClock;
+    double nextBlockStartBeat;
+    bool hostLooping;
+    double loopStartBeat;
+    double loopEndBeat;
+    
+    // Switch to new tracks at a bar line (audio thread)
+    int handoffBarsSetting = 1;
+    bool handoffQueued = false;     // new tracks are waiting in the exchange
+    double handoffBeat = -1.0;      // where they take over, once scheduled
     
-    // MIDI data
-    juce::MidiBuffer currentMidiBuffer;
-    juce::MidiBuffer bassMidiData;
-    juce::MidiBuffer drumMidiData;
+    // Tempo map of the playing tracks (owned by the current snapshot)
+    const TempoMap* playingTempoMap = nullptr;
+    TempoMap::Cursor tempoCursor;
+    std::atomic<double> trackTempoBpm { 0.0 };
+    juce::uint32 playingLoadGeneration = 0;
+    TempoMap defaultTempoMap;       // bar lines for tracks without a tempo map
+    
+    // MIDI data (the tracks themselves live in trackExchange)
+    std::unique_ptr<EventBuffers> eventBuffers;             // the audio thread's
+    std::atomic<EventBuffers*> grownEventBuffers { nullptr };   // built for denser tracks, not taken yet
+    std::atomic<EventBuffers*> retiredEventBuffers { nullptr }; // outgrown, freed off the audio thread
+    std::array<TrackControls, TrackExchange::maxTracks> trackControls;
+    std::array<TrackPlayback, TrackExchange::maxTracks> trackPlayback;
+    std::array<PlayheadJump, maxPendingJumps> pendingJumps;
+    juce::int64 numJumps;
+    juce::int64 renderedSamples;
+    juce::int64 renderEndSample = -1;   // where an offline render ends, before each track's delay
     
     // Timing
     double hostSampleRate;
     int hostBlockSize;
     
-    // File monitoring
+    // Event buffer sizes, set off the audio thread
+    juce::CriticalSection eventBufferLock;
+    int reservedEventsPerBeat;
+    double reservedBeatsPerBlock = 0.0;
+    
+    // File monitoring (loading happens on the watcher thread)
     juce::String monitoredFolder;
-    juce::Time lastFolderCheck;
     
     //==============================================================================
     // Internal methods
+    void sendCommand(CommandQueue::Command::Type type, int trackIndex = 0, double value = 0.0, double secondValue = 0.0);
+    void updateTrackTransform(int trackIndex);
+    void handleCommands(juce::MidiBuffer& midiMessages);
+    void resyncControls(juce::MidiBuffer& midiMessages);
+    void restartPlayback(double beat);
     void processMidiEvents(juce::MidiBuffer& midiMessages, int numSamples);
+    void renderTracks(juce::MidiBuffer& output, int startSample, int endSample, double samplesPerBeat);
+    void queueJump(juce::int64 samplePosition, double fromBeat, double toBeat, double lead);
+    void followJumps(juce::MidiBuffer& output, int sampleOffset);
+    juce::int64 getNextJumpOffset(const TrackPlayback& track) const;
+    juce::int64 getRenderEndOffset(const TrackPlayback& track) const;
+    void applyTrackControls(double samplesPerBeat);
+    void chaseTrack(juce::MidiBuffer& output, int trackIndex, double beat, int sampleOffset);
+    int calculateLatencySamples() const;
     void updatePlaybackPosition(int numSamples);
-    void checkForNewMidiFiles();
-    void loadMidiFromBuffer(const juce::MidiBuffer& source, juce::MidiBuffer& destination, double startBeat, double endBeat);
+    void applyPendingTracks();
+    void adoptSnapshot(bool restart);
+    int findHandoffSample(double startBeat, int numSamples, double samplesPerBeat, int firstJumpSample);
+    void handOffTracks(juce::MidiBuffer& output, int sampleOffset);
+    void reserveEventBuffers();
+    void growEventBuffers(int peakEventsPerBeat);
+    std::unique_ptr<EventBuffers> createEventBuffers(int eventsPerBeat) const;
+    void takeGrownEventBuffers() noexcept;
+    static void copyEvents(const juce::MidiBuffer& source, juce::MidiBuffer& destination) noexcept;
+    bool playOfflineRender(const juce::String& filePath, const OfflineRenderOptions& options,
+                           OfflineRenderStatistics* statistics);
+    void releaseActiveNotes(juce::MidiBuffer& midiMessages, int samplePosition);
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AIBandAudioProcessor)
@@ -0,0 +1,198 @@
+#include "TempoMap.h"
+
+//==============================================================================
+TempoMap::TempoMap(double bpm, int ticks)
+    : TempoMap(std::vector<TempoChange> { { 0.0, bpm } }, ticks)
+{
+}
+
+TempoMap::TempoMap(std::vector<TempoChange> changes, int ticks, std::vector<TimeSignatureChange> timeSignatures)
+    : ticksPerQuarterNote(juce::jmax(1, ticks))
+{
+    std::stable_sort(changes.begin(), changes.end(),
+                     [](const TempoChange& a, const TempoChange& b) { return a.beat < b.beat; });
+
+    segments.push_back({ 0.0, 0.0, 60.0 / defaultTempoBpm });
+
+    for (const auto& change : changes)
+    {
+        if (!(change.bpm > 0.0))
+            continue;
+
+        auto beat = juce::jmax(0.0, change.beat);
+        auto secondsPerBeat = 60.0 / change.bpm;
+        auto& last = segments.back();
+
+        if (beat == last.startBeat)
+            last.secondsPerBeat = secondsPerBeat;
+        else if (secondsPerBeat != last.secondsPerBeat)
+            segments.push_back({ beat, last.startSeconds + (beat - last.startBeat) * last.secondsPerBeat, secondsPerBeat });
+    }
+
+    std::stable_sort(timeSignatures.begin(), timeSignatures.end(),
+                     [](const TimeSignatureChange& a, const TimeSignatureChange& b) { return a.beat < b.beat; });
+
+    meters.push_back({ 0.0, 0.0, 4.0, 4, 4 });
+
+    for (const auto& change : timeSignatures)
+    {
+        if (change.numerator <= 0 || change.denominator <= 0 || !juce::isPowerOfTwo(change.denominator))
+            continue;
+
+        auto beat = juce::jmax(0.0, change.beat);
+        auto beatsPerBar = change.numerator * 4.0 / change.denominator;
+        auto& last = meters.back();
+
+        if (beat == last.startBeat)
+        {
+            last = { last.startBeat, last.startBar, beatsPerBar, change.numerator, change.denominator };
+        }
+        else if (change.numerator != last.numerator || change.denominator != last.denominator)
+        {
+            // The new section starts a bar, even if the previous one is not complete
+            auto startBar = std::ceil(last.startBar + (beat - last.startBeat) / last.beatsPerBar - 1.0e-9);
+            meters.push_back({ beat, startBar, beatsPerBar, change.numerator, change.denominator });
+        }
+    }
+}
+
+std::shared_ptr<const TempoMap> TempoMap::createFromMidiFile(const juce::MidiFile& midiFile)
+{
+    auto ticks = midiFile.getTimeFormat() > 0 ? static_cast<int>(midiFile.getTimeFormat()) : 480;
+
+    // In type 1 files the tempo track is usually track 0, but the tempo
+    // applies to every track, so events from all of them are collected
+    std::vector<TempoChange> changes;
+    std::vector<TimeSignatureChange> timeSignatures;
+
+    for (int trackIndex = 0; trackIndex < midiFile.getNumTracks(); ++trackIndex)
+        if (const auto* track = midiFile.getTrack(trackIndex))
+            addChanges(*track, ticks, changes, timeSignatures);
+
+    return std::make_shared<const TempoMap>(std::move(changes), ticks, std::move(timeSignatures));
+}
+
+//==============================================================================
+double TempoMap::beatsToSeconds(double beats) const noexcept
+{
+    const auto& segment = segments[findSegment(beats, &Segment::startBeat)];
+    return segment.startSeconds + (beats - segment.startBeat) * segment.secondsPerBeat;
+}
+
+double TempoMap::beatsToSeconds(double beats, Cursor& cursor) const noexcept
+{
+    const auto& segment = segments[findSegment(beats, &Segment::startBeat, cursor)];
+    return segment.startSeconds + (beats - segment.startBeat) * segment.secondsPerBeat;
+}
+
+double TempoMap::secondsToBeats(double seconds) const noexcept
+{
+    const auto& segment = segments[findSegment(seconds, &Segment::startSeconds)];
+    return segment.startBeat + (seconds - segment.startSeconds) / segment.secondsPerBeat;
+}
+
+double TempoMap::secondsToBeats(double seconds, Cursor& cursor) const noexcept
+{
+    const auto& segment = segments[findSegment(seconds, &Segment::startSeconds, cursor)];
+    return segment.startBeat + (seconds - segment.startSeconds) / segment.secondsPerBeat;
+}
+
+double TempoMap::getTempoAt(double beats) const noexcept
+{
+    return 60.0 / segments[findSegment(beats, &Segment::startBeat)].secondsPerBeat;
+}
+
+double TempoMap::getTempoAt(double beats, Cursor& cursor) const noexcept
+{
+    return 60.0 / segments[findSegment(beats, &Segment::startBeat, cursor)].secondsPerBeat;
+}
+
+//==============================================================================
+double TempoMap::beatsToBars(double beats) const noexcept
+{
+    const auto& meter = meters[findMeter(beats, &Meter::startBeat)];
+    return meter.startBar + (beats - meter.startBeat) / meter.beatsPerBar;
+}
+
+double TempoMap::barsToBeats(double bars) const noexcept
+{
+    const auto& meter = meters[findMeter(bars, &Meter::startBar)];
+    return meter.startBeat + (bars - meter.startBar) * meter.beatsPerBar;
+}
+
+double TempoMap::getNextBarLine(double beats, int numBars) const noexcept
+{
+    // Positions a rounding error past a bar line still count as on it
+    auto firstBar = std::ceil(beatsToBars(beats) - 1.0e-9);
+    return barsToBeats(firstBar + juce::jmax(1, numBars) - 1);
+}
+
+const TempoMap::Meter& TempoMap::getMeterAt(double beats) const noexcept
+{
+    return meters[findMeter(beats, &Meter::startBeat)];
+}
+
+//==============================================================================
+size_t TempoMap::findSegment(double position, double Segment::* start) const noexcept
+{
+    // Last segment starting at or before the position; positions before the
+    // start use the first segment's tempo
+    auto next = std::upper_bound(segments.begin() + 1, segments.end(), position,
+                                 [start](double value, const Segment& segment) { return value < segment.*start; });
+
+    return static_cast<size_t>(next - segments.begin()) - 1;
+}
+
+size_t TempoMap::findSegment(double position, double Segment::* start, Cursor& cursor) const noexcept
+{
+    auto contains = [&](size_t index)
+    {
+        return (index == 0 || segments[index].*start <= position)
+            && (index + 1 == segments.size() || position < segments[index + 1].*start);
+    };
+
+    // The remembered segment, or the one after it, covers nearly every
+    // lookup while playing; anything else (a seek) searches
+    auto index = juce::jmin(cursor.segment, segments.size() - 1);
+
+    if (!contains(index))
+    {
+        if (index + 1 < segments.size() && contains(index + 1))
+            ++index;
+        else
+            index = findSegment(position, start);
+    }
+
+    cursor.segment = index;
+    return index;
+}
+
+size_t TempoMap::findMeter(double position, double Meter::* start) const noexcept
+{
+    // A handful of sections at most, looked up when scheduling, so no cursor
+    auto next = std::upper_bound(meters.begin() + 1, meters.end(), position,
+                                 [start](double value, const Meter& meter) { return value < meter.*start; });
+
+    return static_cast<size_t>(next - meters.begin()) - 1;
+}
+
+void TempoMap::addChanges(const juce::MidiMessageSequence& sequence, int ticks,
+                          std::vector<TempoChange>& changes,
+                          std::vector<TimeSignatureChange>& timeSignatures)
+{
+    for (int i = 0; i < sequence.getNumEvents(); ++i)
+    {
+        const auto& message = sequence.getEventPointer(i)->message;
+
+        if (message.isTempoMetaEvent() && message.getTempoSecondsPerQuarterNote() > 0.0)
+        {
+            changes.push_back({ message.getTimeStamp() / ticks, 60.0 / message.getTempoSecondsPerQuarterNote() });
+        }
+        else if (message.isTimeSignatureMetaEvent())
+        {
+            int numerator = 4, denominator = 4;
+            message.getTimeSignatureInfo(numerator, denominator);
+            timeSignatures.push_back({ message.getTimeStamp() / ticks, numerator, denominator });
+        }
+    }
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+    Tempo Map for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    An immutable list of constant-tempo segments, built once from the tempo
+    events of a MIDI file. Every segment stores where it starts both in
+    quarter notes and in seconds, so converting a position only needs the
+    segment it falls into: a binary search for random access, or a Cursor
+    that remembers the segment of the previous lookup. Playback moves
+    forward in small steps, so with a cursor a conversion almost always
+    costs O(1).
+
+    The map also holds the time signatures, as sections of whole bars, so
+    bar lines can be found for switching material in time with the music.
+
+    Maps are shared through std::shared_ptr<const TempoMap> by the parser,
+    the loaded timelines, the audio thread and the editor; none of them can
+    change a map, so it can be read from any thread. Queries never allocate.
+*/
+class TempoMap
+{
+public:
+    //==============================================================================
+    /** A tempo that applies from a position until the next change */
+    struct TempoChange
+    {
+        double beat;    /**< Position in quarter notes */
+        double bpm;     /**< Quarter notes per minute */
+    };
+
+    /** A time signature that applies from a position until the next change */
+    struct TimeSignatureChange
+    {
+        double beat;        /**< Position in quarter notes */
+        int numerator;
+        int denominator;    /**< A power of two: 4 = quarter note */
+    };
+
+    /** A section with one time signature; its start is always a bar line */
+    struct Meter
+    {
+        double startBeat;
+        double startBar;    /**< Bars since the start of the map */
+        double beatsPerBar; /**< Quarter notes per bar */
+        int numerator;
+        int denominator;
+    };
+
+    /** A constant-tempo section with its cumulative start times */
+    struct Segment
+    {
+        double startBeat;
+        double startSeconds;
+        double secondsPerBeat;
+    };
+
+    //==============================================================================
+    /** Lookup position in a tempo map.
+        Keep one per reader that moves through time (e.g. one for the audio
+        thread); it holds no reference to the map and is only a hint, so it
+        may be used with any map.
+    */
+    class Cursor
+    {
+    public:
+        /** Forget the remembered segment */
+        void reset() noexcept { segment = 0; }
+
+    private:
+        friend class TempoMap;
+
+        size_t segment = 0;
+    };
+
+    //==============================================================================
+    /** Create a map with one constant tempo */
+    explicit TempoMap(double bpm = defaultTempoBpm, int ticksPerQuarterNote = 480);
+
+    /** Create a map from tempo and time signature changes
+        Changes may come in any order; of several at the same position the
+        last one wins. Before the first change the tempo is defaultTempoBpm
+        and the time signature 4/4. A time signature change in the middle of
+        a bar cuts that bar short.
+        @param changes              Tempo changes
+        @param ticksPerQuarterNote  Resolution used by the tick conversions
+        @param timeSignatures       Time signature changes
+    */
+    TempoMap(std::vector<TempoChange> changes, int ticksPerQuarterNote,
+             std::vector<TimeSignatureChange> timeSignatures = {});
+
+    /** Build a map from the tempo and time signature events of every track of a file
+        Timestamps must still be in ticks (as they are straight after
+        MidiFile::readFrom).
+    */
+    static std::shared_ptr<const TempoMap> createFromMidiFile(const juce::MidiFile& midiFile);
+
+    /** Tempo assumed before the first tempo event, as in the MIDI standard */
+    static constexpr double defaultTempoBpm = 120.0;
+
+    //==============================================================================
+    /** Convert quarter notes to seconds from the start */
+    double beatsToSeconds(double beats) const noexcept;
+    double beatsToSeconds(double beats, Cursor& cursor) const noexcept;
+
+    /** Convert seconds from the start to quarter notes */
+    double secondsToBeats(double seconds) const noexcept;
+    double secondsToBeats(double seconds, Cursor& cursor) const noexcept;
+
+    /** Convert MIDI ticks to seconds from the start */
+    double ticksToSeconds(double ticks) const noexcept { return beatsToSeconds(ticks / ticksPerQuarterNote); }
+    double ticksToSeconds(double ticks, Cursor& cursor) const noexcept { return beatsToSeconds(ticks / ticksPerQuarterNote, cursor); }
+
+    /** Convert seconds from the start to MIDI ticks */
+    double secondsToTicks(double seconds) const noexcept { return secondsToBeats(seconds) * ticksPerQuarterNote; }
+    double secondsToTicks(double seconds, Cursor& cursor) const noexcept { return secondsToBeats(seconds, cursor) * ticksPerQuarterNote; }
+
+    /** Convert quarter notes to a (fractional) sample position */
+    double beatsToSamples(double beats, double sampleRate) const noexcept { return beatsToSeconds(beats) * sampleRate; }
+    double beatsToSamples(double beats, double sampleRate, Cursor& cursor) const noexcept { return beatsToSeconds(beats, cursor) * sampleRate; }
+
+    /** Convert a sample position to quarter notes */
+    double samplesToBeats(double samples, double sampleRate) const noexcept { return secondsToBeats(samples / sampleRate); }
+    double samplesToBeats(double samples, double sampleRate, Cursor& cursor) const noexcept { return secondsToBeats(samples / sampleRate, cursor); }
+
+    /** Get the tempo in BPM at a position in quarter notes */
+    double getTempoAt(double beats) const noexcept;
+    double getTempoAt(double beats, Cursor& cursor) const noexcept;
+
+    //==============================================================================
+    /** Convert quarter notes to bars since the start (fractional) */
+    double beatsToBars(double beats) const noexcept;
+
+    /** Convert bars since the start to quarter notes */
+    double barsToBeats(double bars) const noexcept;
+
+    /** Find a bar line ahead of a position
+        @param beats    Position in quarter notes
+        @param numBars  1 for the first bar line at or after the position,
+                        2 for the one after that, and so on
+        @returns the position of the bar line in quarter notes
+    */
+    double getNextBarLine(double beats, int numBars = 1) const noexcept;
+
+    /** Get the time signature section a position falls into */
+    const Meter& getMeterAt(double beats) const noexcept;
+
+    //==============================================================================
+    /** Get the resolution used by the tick conversions */
+    int getTicksPerQuarterNote() const noexcept { return ticksPerQuarterNote; }
+
+    /** Get the number of constant-tempo segments (at least 1) */
+    int getNumSegments() const noexcept { return static_cast<int>(segments.size()); }
+
+    /** Get a segment (index must be below getNumSegments()) */
+    const Segment& getSegment(int index) const noexcept { return segments[static_cast<size_t>(index)]; }
+
+    /** Check if the whole map has one tempo */
+    bool isConstant() const noexcept { return segments.size() == 1; }
+
+private:
+    //==============================================================================
+    /** Find the segment containing a position, by beat or by seconds */
+    size_t findSegment(double position, double Segment::* start) const noexcept;
+    size_t findSegment(double position, double Segment::* start, Cursor& cursor) const noexcept;
+
+    /** Find the time signature section containing a position, by beat or by bar */
+    size_t findMeter(double position, double Meter::* start) const noexcept;
+
+    /** Collect the tempo and time signature events of a sequence as changes */
+    static void addChanges(const juce::MidiMessageSequence& sequence, int ticksPerQuarterNote,
+                           std::vector<TempoChange>& changes,
+                           std::vector<TimeSignatureChange>& timeSignatures);
+
+    //==============================================================================
+    std::vector<Segment> segments;
+    std::vector<Meter> meters;
+    int ticksPerQuarterNote;
+
+    // Stores and restores the sections as they are
+    friend class CompiledTrackCache;
+
+    //==============================================================================
+    JUCE_LEAK_DETECTOR (TempoMap)
+};
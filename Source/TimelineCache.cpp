@@ -0,0 +1,142 @@
+#include "TimelineCache.h"
+
+//==============================================================================
+TimelineCache::TimelineCache()
+{
+}
+
+TimelineCache::~TimelineCache()
+{
+}
+
+//==============================================================================
+std::shared_ptr<const MidiTimeline> TimelineCache::getTimeline(const void* data, size_t size, MidiManager& midiManager,
+                                                               const CompiledTrackCache* compiledTracks)
+{
+    if (data == nullptr || size == 0)
+        return nullptr;
+
+    const Key key { hashContent(data, size), size };
+
+    {
+        const juce::ScopedLock scope(lock);
+        auto existing = entries.find(key);
+
+        if (existing != entries.end())
+        {
+            recentUses.splice(recentUses.begin(), recentUses, existing->second.recentUse);
+            ++numHits;
+            return existing->second.timeline;
+        }
+
+        ++numMisses;
+    }
+
+    std::shared_ptr<const MidiTimeline> timeline;
+    bool compiledLoad = false;
+
+    if (compiledTracks != nullptr)
+    {
+        timeline = compiledTracks->load(key.contentHash, size);
+        compiledLoad = timeline != nullptr;
+    }
+
+    if (timeline == nullptr)
+    {
+        // A file that fails to parse is not cached, so it is retried on the next load
+        auto parsed = std::make_shared<MidiTimeline>();
+        if (!midiManager.loadMidiFromMemory(data, size, *parsed))
+            return nullptr;
+
+        // Failing to write only costs a parse next time
+        if (compiledTracks != nullptr)
+            compiledTracks->store(key.contentHash, size, *parsed);
+
+        timeline = std::move(parsed);
+    }
+
+    const juce::ScopedLock scope(lock);
+
+    if (compiledLoad)
+        ++numCompiledLoads;
+
+    // Another loader may have parsed the same content meanwhile; the
+    // first one in is kept, so every caller shares one timeline
+    auto inserted = entries.emplace(key, Entry());
+    auto& entry = inserted.first->second;
+
+    if (inserted.second)
+    {
+        entry.timeline = std::move(timeline);
+        entry.memoryUsage = entry.timeline->getMemoryUsage();
+        entry.recentUse = recentUses.insert(recentUses.begin(), key);
+        memoryUsage += entry.memoryUsage;
+    }
+
+    auto result = entry.timeline;
+    evict(memoryLimit);
+    return result;
+}
+
+void TimelineCache::setMemoryLimit(size_t newLimitBytes)
+{
+    const juce::ScopedLock scope(lock);
+    memoryLimit = newLimitBytes;
+    evict(memoryLimit);
+}
+
+void TimelineCache::removeUnused()
+{
+    const juce::ScopedLock scope(lock);
+    evict(0);
+}
+
+TimelineCache::Statistics TimelineCache::getStatistics() const
+{
+    const juce::ScopedLock scope(lock);
+
+    Statistics statistics;
+    statistics.numEntries = static_cast<int>(entries.size());
+    statistics.memoryUsage = memoryUsage;
+    statistics.memoryLimit = memoryLimit;
+    statistics.hits = numHits;
+    statistics.misses = numMisses;
+    statistics.compiledLoads = numCompiledLoads;
+    statistics.evictions = numEvictions;
+    return statistics;
+}
+
+//==============================================================================
+juce::uint64 TimelineCache::hashContent(const void* data, size_t size) noexcept
+{
+    auto hash = (juce::uint64) 14695981039346656037ull;
+    auto* bytes = static_cast<const juce::uint8*>(data);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= (juce::uint64) 1099511628211ull;
+    }
+
+    return hash;
+}
+
+//==============================================================================
+void TimelineCache::evict(size_t limitBytes)
+{
+    // Walk from the least recently used end; a timeline referenced outside
+    // the cache is still being played (or about to be) and stays
+    for (auto it = recentUses.end(); it != recentUses.begin() && memoryUsage > limitBytes;)
+    {
+        --it;
+        auto entry = entries.find(*it);
+
+        if (entry->second.timeline.use_count() > 1)
+            continue;
+
+        memoryUsage -= entry->second.memoryUsage;
+        entries.erase(entry);
+        it = recentUses.erase(it);
+        ++numEvictions;
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <list>
+#include <map>
+#include <memory>
+#include "CompiledTrackCache.h"
+#include "MidiManager.h"
+#include "MidiTimeline.h"
+
+//==============================================================================
+/**
+    Timeline Cache for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    Process-wide store of parsed tracks, shared by every plugin instance
+    through a juce::SharedResourcePointer. Files are identified by their
+    content (64-bit FNV-1a hash and size), so ten instances pointed at the
+    same backend folder parse each file once and play the same immutable
+    timeline.
+
+    Timelines are tick-based and carry their own tempo map, so one parse
+    serves any host tempo and sample rate; neither is part of the key.
+
+    Given a CompiledTrackCache, a miss loads the compiled timeline from disk
+    when one was stored before (e.g. by an earlier session), and stores
+    the ones it has to parse.
+
+    The cache keeps a reference to every timeline it hands out. When the
+    memory of the cached timelines goes over the limit, entries that no
+    track is playing any more are dropped, least recently used first.
+    Timelines still in use are never dropped, so the limit can be exceeded
+    while they play.
+*/
+class TimelineCache
+{
+public:
+    //==============================================================================
+    /** Counters and memory of the cache */
+    struct Statistics
+    {
+        int numEntries = 0;
+        size_t memoryUsage = 0;     /**< Bytes held by the cached timelines */
+        size_t memoryLimit = 0;
+        int hits = 0;               /**< Lookups served without parsing */
+        int misses = 0;             /**< Lookups not served from memory */
+        int compiledLoads = 0;      /**< Misses served by a compiled track from disk */
+        int evictions = 0;          /**< Entries dropped to stay under the limit */
+    };
+
+    /** Memory the cached timelines may take before unused ones are dropped */
+    static constexpr size_t defaultMemoryLimit = 256 * 1024 * 1024;
+
+    //==============================================================================
+    TimelineCache();
+    ~TimelineCache();
+
+    //==============================================================================
+    /** Get the timeline of a MIDI file's content, parsing it only if no
+        timeline with the same content is cached (loader threads)
+        Parsing happens outside the cache lock, so loads of different files
+        never wait for each other.
+        @param data             MIDI file content
+        @param size             Size of the content in bytes
+        @param midiManager      Parser used on a miss
+        @param compiledTracks   On-disk cache tried before parsing, or nullptr
+        @returns the shared timeline, or nullptr if the data could not be parsed
+    */
+    std::shared_ptr<const MidiTimeline> getTimeline(const void* data, size_t size, MidiManager& midiManager,
+                                                    const CompiledTrackCache* compiledTracks = nullptr);
+
+    /** Set the memory the cached timelines may take, dropping unused entries over it */
+    void setMemoryLimit(size_t newLimitBytes);
+
+    /** Drop every entry no track is playing */
+    void removeUnused();
+
+    /** Get the counters and memory of the cache */
+    Statistics getStatistics() const;
+
+    //==============================================================================
+    /** 64-bit FNV-1a hash of a file's content */
+    static juce::uint64 hashContent(const void* data, size_t size) noexcept;
+
+private:
+    //==============================================================================
+    struct Key
+    {
+        juce::uint64 contentHash;
+        size_t size;
+
+        bool operator< (const Key& other) const noexcept
+        {
+            return contentHash != other.contentHash ? contentHash < other.contentHash : size < other.size;
+        }
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<const MidiTimeline> timeline;
+        size_t memoryUsage = 0;
+        std::list<Key>::iterator recentUse;
+    };
+
+    /** Drop unused entries, least recently used first, until under the limit
+        (called with the lock held)
+    */
+    void evict(size_t limitBytes);
+
+    //==============================================================================
+    juce::CriticalSection lock;
+    std::map<Key, Entry> entries;
+    std::list<Key> recentUses;      // most recently used first
+    size_t memoryUsage = 0;
+    size_t memoryLimit = defaultMemoryLimit;
+    int numHits = 0;
+    int numMisses = 0;
+    int numCompiledLoads = 0;
+    int numEvictions = 0;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimelineCache)
+};
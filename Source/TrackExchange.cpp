@@ -0,0 +1,251 @@
+#include "TrackExchange.h"
+
+//==============================================================================
+TrackExchange::TrackExchange()
+{
+    // Start with empty tracks so the audio thread never has to check for null
+    emptyTrack = std::make_shared<MidiTimeline>();
+    latest.tracks.assign(numNamedTracks, emptyTrack);
+    latestEventsPerBeat.assign(numNamedTracks, 0);
+    latestSources.assign(numNamedTracks, emptyTrack);
+    bakedVersions.assign(maxTracks, 0);
+    transforms.resize(maxTracks);
+    transformVersions.assign(maxTracks, 0);
+    current = new Snapshot(latest);
+}
+
+TrackExchange::~TrackExchange()
+{
+    // The audio thread is no longer running, so every snapshot can be freed here
+    delete pending.exchange(nullptr);
+    delete retired.exchange(nullptr);
+    delete superseded.exchange(nullptr);
+    delete queued;
+    delete current;
+}
+
+//==============================================================================
+juce::uint32 TrackExchange::publish(TrackList newTracks)
+{
+    SharedTrackList sharedTracks;
+    sharedTracks.reserve(newTracks.size());
+
+    for (auto& track : newTracks)
+        sharedTracks.push_back(std::move(track));
+
+    return publish(std::move(sharedTracks));
+}
+
+juce::uint32 TrackExchange::publish(SharedTrackList newTracks)
+{
+    jassert(newTracks.size() <= static_cast<size_t>(maxTracks));
+
+    juce::uint32 generation;
+
+    {
+        // Serialises loaders, so each snapshot builds on the previous one
+        const juce::ScopedLock lock(publishLock);
+
+        auto numTracks = juce::jmin(newTracks.size(), static_cast<size_t>(maxTracks));
+
+        if (numTracks > latest.tracks.size())
+        {
+            latest.tracks.resize(numTracks, emptyTrack);
+            latestEventsPerBeat.resize(numTracks, 0);
+            latestSources.resize(numTracks, emptyTrack);
+        }
+
+        // Only new tracks are baked and measured; the others keep theirs
+        for (size_t i = 0; i < numTracks; ++i)
+        {
+            if (newTracks[i] != nullptr)
+            {
+                latestSources[i] = std::move(newTracks[i]);
+                bakeTrack(i);
+            }
+        }
+
+        ++latest.loadGeneration;
+        generation = publishLatest();
+    }
+
+    // Free the slot the audio thread needs before it can take the new snapshot
+    collectGarbage();
+
+    return generation;
+}
+
+bool TrackExchange::setTransform(int trackIndex, const EventTransform& transform)
+{
+    if (!juce::isPositiveAndBelow(trackIndex, maxTracks))
+        return false;
+
+    const juce::ScopedLock lock(transformLock);
+    auto& slotTransform = transforms[static_cast<size_t>(trackIndex)];
+
+    if (slotTransform == transform)
+        return false;
+
+    slotTransform = transform;
+    ++transformVersions[static_cast<size_t>(trackIndex)];
+    return true;
+}
+
+EventTransform TrackExchange::getTransform(int trackIndex) const
+{
+    if (!juce::isPositiveAndBelow(trackIndex, maxTracks))
+        return {};
+
+    const juce::ScopedLock lock(transformLock);
+    return transforms[static_cast<size_t>(trackIndex)];
+}
+
+juce::uint32 TrackExchange::bakeTransforms()
+{
+    juce::uint32 generation = 0;
+
+    {
+        const juce::ScopedLock lock(publishLock);
+        bool changed = false;
+
+        for (size_t i = 0; i < latest.tracks.size(); ++i)
+        {
+            juce::uint32 version;
+
+            {
+                const juce::ScopedLock transformScope(transformLock);
+                version = transformVersions[i];
+            }
+
+            if (version != bakedVersions[i])
+            {
+                bakeTrack(i);
+                changed = true;
+            }
+        }
+
+        if (changed)
+            generation = publishLatest();
+    }
+
+    if (generation != 0)
+        collectGarbage();
+
+    return generation;
+}
+
+void TrackExchange::setPeakCallback(std::function<void(int)> callback)
+{
+    const juce::ScopedLock lock(publishLock);
+    peakCallback = std::move(callback);
+}
+
+TrackExchange::SharedTrackList TrackExchange::getPublishedTracks() const
+{
+    const juce::ScopedLock lock(publishLock);
+    return latest.tracks;
+}
+
+void TrackExchange::collectGarbage()
+{
+    delete retired.exchange(nullptr, std::memory_order_acq_rel);
+    delete superseded.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+//==============================================================================
+bool TrackExchange::update() noexcept
+{
+    receive();
+    return switchToQueued();
+}
+
+const TrackExchange::Snapshot* TrackExchange::receive() noexcept
+{
+    // A queued snapshot can only be replaced once the one it replaced
+    // before has been collected; until then the newer one stays pending
+    if (queued != nullptr && superseded.load(std::memory_order_acquire) != nullptr)
+        return queued;
+
+    if (auto* next = pending.exchange(nullptr, std::memory_order_acq_rel))
+    {
+        if (queued != nullptr)
+            superseded.store(queued, std::memory_order_release);
+
+        queued = next;
+    }
+
+    return queued;
+}
+
+bool TrackExchange::switchToQueued() noexcept
+{
+    // Only swap once the previous snapshot has been collected, so the handback
+    // never overwrites an object a loader still owes a delete
+    if (queued == nullptr || retired.load(std::memory_order_acquire) != nullptr)
+        return false;
+
+    retired.store(current, std::memory_order_release);
+    current = queued;
+    queued = nullptr;
+    return true;
+}
+
+//==============================================================================
+void TrackExchange::bakeTrack(size_t trackIndex)
+{
+    // Called with publishLock held. The version is read together with the
+    // transform, so a change made during the bake is picked up by the next one.
+    EventTransform transform;
+
+    {
+        const juce::ScopedLock lock(transformLock);
+        transform = transforms[trackIndex];
+        bakedVersions[trackIndex] = transformVersions[trackIndex];
+    }
+
+    const auto& source = latestSources[trackIndex];
+
+    if (transform.isIdentity())
+    {
+        latest.tracks[trackIndex] = source;
+    }
+    else
+    {
+        auto baked = std::make_shared<MidiTimeline>();
+        transform.bake(*source, *baked);
+        latest.tracks[trackIndex] = std::move(baked);
+    }
+
+    latestEventsPerBeat[trackIndex] = getMaxEventsPerBeat(*latest.tracks[trackIndex]);
+}
+
+juce::uint32 TrackExchange::publishLatest()
+{
+    // Called with publishLock held
+    auto generation = ++latest.generation;
+    latest.maxEventsPerBeat = 0;
+
+    for (auto eventsPerBeat : latestEventsPerBeat)
+        latest.maxEventsPerBeat += eventsPerBeat;
+
+    if (latest.maxEventsPerBeat > peakEventsPerBeat.load())
+    {
+        peakEventsPerBeat = latest.maxEventsPerBeat;
+
+        if (peakCallback != nullptr)
+            peakCallback(latest.maxEventsPerBeat);
+    }
+
+    // A snapshot still pending was never seen by the audio thread, so it
+    // is ours to delete; its tracks are already part of the new one
+    delete pending.exchange(new Snapshot(latest), std::memory_order_acq_rel);
+    publishedGeneration = generation;
+
+    return generation;
+}
+
+//==============================================================================
+int TrackExchange::getMaxEventsPerBeat(const MidiTimeline& timeline)
+{
+    return timeline.getMaxEventsInSpan(timeline.getTicksPerQuarterNote());
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "MidiTimeline.h"
+#include "EventTransform.h"
+
+//==============================================================================
+/**
+    Track Exchange for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    Read-copy-update publication of the playing tracks. Loader threads (UI,
+    folder watcher) never modify what the audio thread is reading; they build
+    a new immutable Snapshot and publish it with an atomic exchange:
+
+    - publish() stores the snapshot in "pending", replacing (and deleting)
+      any snapshot the audio thread has not picked up yet
+    - update() runs on the audio thread at a block boundary: it takes the
+      pending snapshot, makes it current and hands the previous one back
+      through "retired"
+    - collectGarbage() deletes retired snapshots on a non real-time thread
+
+    update() can also be taken in two steps, to switch at a chosen moment
+    such as a bar line: receive() takes the pending snapshot into a queue
+    the audio thread owns, and switchToQueued() later makes it current. The
+    snapshot is complete long before the switch, which only moves a pointer.
+    A newer publication received while one is queued replaces it.
+
+    The audio thread therefore never locks, allocates or frees. Unchanged
+    tracks are shared between consecutive snapshots, so replacing one track
+    does not copy the others.
+
+    Each slot can have an EventTransform. Published tracks are kept as
+    sources and the snapshot holds them with the transform baked in; a
+    changed transform only re-bakes its own slot from the source, on
+    whichever thread calls bakeTransforms(). Slots without a transform share
+    the source itself. Sources are never modified, so one parsed timeline
+    can be published to every plugin instance that plays the same file.
+
+    A snapshot holds a table of up to maxTracks tracks. The first slots are
+    the instruments the backend generates (bass, drums, keys, guitar); any
+    further slots are free for other parts.
+*/
+class TrackExchange
+{
+public:
+    //==============================================================================
+    /** Track slots of the instruments the backend generates */
+    enum TrackSlot
+    {
+        bassTrack = 0,
+        drumTrack,
+        keysTrack,
+        guitarTrack,
+        numNamedTracks
+    };
+
+    /** Largest number of tracks a snapshot can hold */
+    static constexpr int maxTracks = 64;
+
+    //==============================================================================
+    /** An immutable set of tracks; no track pointer is ever null */
+    struct Snapshot
+    {
+        std::vector<std::shared_ptr<const MidiTimeline>> tracks;
+        juce::uint32 generation = 0;
+        juce::uint32 loadGeneration = 0;   /**< Changes with new tracks, not with re-baked transforms */
+        int maxEventsPerBeat = 0;   /**< Densest quarter note summed across all tracks */
+
+        /** Get the number of tracks, at least numNamedTracks */
+        int getNumTracks() const noexcept { return static_cast<int>(tracks.size()); }
+
+        /** Get a track (index must be below getNumTracks()) */
+        const MidiTimeline& getTrack(int index) const noexcept { return *tracks[static_cast<size_t>(index)]; }
+    };
+
+    /** New tracks for publish(): entry i replaces track i, nullptr keeps it */
+    using TrackList = std::vector<std::unique_ptr<MidiTimeline>>;
+
+    /** New tracks that may be shared with other owners, e.g. a TimelineCache */
+    using SharedTrackList = std::vector<std::shared_ptr<const MidiTimeline>>;
+
+    //==============================================================================
+    TrackExchange();
+    ~TrackExchange();
+
+    //==============================================================================
+    /** Publish new tracks (loader threads)
+        A list longer than the published table adds tracks, up to maxTracks;
+        added slots that are skipped with nullptr start out empty.
+        @param newTracks    Replacement tracks by slot
+        @returns the generation number of the new snapshot
+    */
+    juce::uint32 publish(TrackList newTracks);
+
+    /** Publish new tracks that are shared, read-only, with other owners (loader threads)
+        The same timeline can be published to several exchanges at once.
+        @param newTracks    Replacement tracks by slot, as for publish(TrackList)
+        @returns the generation number of the new snapshot
+    */
+    juce::uint32 publish(SharedTrackList newTracks);
+
+    /** Set the transform baked into a track slot (any thread)
+        Only records the transform; bakeTransforms() applies it.
+        @returns true if the transform changed and the slot needs re-baking
+    */
+    bool setTransform(int trackIndex, const EventTransform& transform);
+
+    /** Get the transform of a track slot */
+    EventTransform getTransform(int trackIndex) const;
+
+    /** Re-bake the slots whose transform changed and publish them (loader threads)
+        @returns the generation number of the new snapshot, or 0 if nothing changed
+    */
+    juce::uint32 bakeTransforms();
+
+    /** Delete snapshots the audio thread has finished with (loader threads) */
+    void collectGarbage();
+
+    /** Get the tracks of the most recently published snapshot, transforms baked in (any thread)
+        Publishing them to another exchange plays the same snapshot there.
+    */
+    SharedTrackList getPublishedTracks() const;
+
+    /** Get the generation number of the most recently published snapshot */
+    juce::uint32 getPublishedGeneration() const noexcept { return publishedGeneration.load(); }
+
+    /** Get the highest event density of any snapshot published so far
+        Lets the audio side size its buffers before a snapshot goes live.
+    */
+    int getPeakEventsPerBeat() const noexcept { return peakEventsPerBeat.load(); }
+
+    /** Set a function to call whenever a snapshot raises getPeakEventsPerBeat()
+        It runs on the publishing thread before that snapshot is published, so
+        the audio side can grow its buffers before it can receive the snapshot.
+    */
+    void setPeakCallback(std::function<void(int peakEventsPerBeat)> callback);
+
+    //==============================================================================
+    /** Make the most recently published snapshot current (audio thread, wait-free)
+        Call once at the start of a block, before reading getCurrent().
+        @returns true if a new generation went live
+    */
+    bool update() noexcept;
+
+    /** Take the most recently published snapshot into the queue, without
+        making it current (audio thread, wait-free)
+        @returns the queued snapshot, or nullptr if none is queued
+    */
+    const Snapshot* receive() noexcept;
+
+    /** Make the queued snapshot current (audio thread, wait-free)
+        @returns false if nothing is queued, or the snapshot replaced by the
+                 previous switch has not been collected yet
+    */
+    bool switchToQueued() noexcept;
+
+    /** Get the snapshot the audio thread is playing (audio thread only) */
+    const Snapshot& getCurrent() const noexcept { return *current; }
+
+private:
+    //==============================================================================
+    static int getMaxEventsPerBeat(const MidiTimeline& timeline);
+    void bakeTrack(size_t trackIndex);
+    juce::uint32 publishLatest();
+
+    //==============================================================================
+    juce::CriticalSection publishLock;
+    Snapshot latest;
+    std::vector<int> latestEventsPerBeat;
+    std::vector<std::shared_ptr<const MidiTimeline>> latestSources;
+    std::vector<juce::uint32> bakedVersions;
+    std::function<void(int)> peakCallback;
+
+    // Transforms are set without waiting for a bake in progress
+    juce::CriticalSection transformLock;
+    std::vector<EventTransform> transforms;
+    std::vector<juce::uint32> transformVersions;
+    std::shared_ptr<const MidiTimeline> emptyTrack;
+
+    Snapshot* current;
+    Snapshot* queued = nullptr;
+    std::atomic<Snapshot*> pending { nullptr };
+    std::atomic<Snapshot*> retired { nullptr };
+    std::atomic<Snapshot*> superseded { nullptr };
+    std::atomic<juce::uint32> publishedGeneration { 0 };
+    std::atomic<int> peakEventsPerBeat { 0 };
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackExchange)
+};
@@ -0,0 +1,102 @@
+#include "TransportClock.h"
+
+//==============================================================================
+void TransportClock::setSampleRate(double newSampleRate) noexcept
+{
+    jassert(newSampleRate > 0.0);
+
+    if (newSampleRate <= 0.0 || newSampleRate == sampleRate)
+        return;
+
+    // Keep the beat position and the time left in a ramp; the sample counter
+    // restarts because samples of the old rate no longer mean the same time
+    auto beat = getBeatPosition();
+    auto bpm = getTempo();
+    auto rampSeconds = isRamping() ? static_cast<double>(anchorSample + rampLength - samplePosition) / sampleRate : 0.0;
+
+    sampleRate = newSampleRate;
+    samplePosition = 0;
+    anchorSample = 0;
+    anchorBeat = beat;
+    startBpm = bpm;
+    rampLength = juce::jmax((juce::int64) 0, static_cast<juce::int64>(std::llround(rampSeconds * sampleRate)));
+
+    if (rampLength == 0)
+        startBpm = targetBpm;
+}
+
+void TransportClock::reset(double beat) noexcept
+{
+    auto bpm = getTempo();
+
+    samplePosition = 0;
+    anchorSample = 0;
+    anchorBeat = beat;
+    startBpm = bpm;
+    rampLength = 0;
+    targetBpm = bpm;
+}
+
+void TransportClock::setTempo(double bpm, juce::int64 newRampLength) noexcept
+{
+    bpm = juce::jlimit(minTempoBpm, maxTempoBpm, bpm);
+
+    rebase(samplePosition);
+    targetBpm = bpm;
+    rampLength = juce::jmax((juce::int64) 0, newRampLength);
+
+    if (rampLength == 0)
+        startBpm = bpm;
+}
+
+void TransportClock::advance(int numSamples) noexcept
+{
+    samplePosition += juce::jmax(0, numSamples);
+
+    // Once a ramp has finished, continue from its end at the target tempo
+    if (isRamping() && samplePosition - anchorSample >= rampLength)
+        rebase(anchorSample + rampLength);
+}
+
+//==============================================================================
+double TransportClock::getBeatPositionAt(juce::int64 sample) const noexcept
+{
+    auto elapsed = static_cast<double>(sample - anchorSample);
+    auto samplesPerMinute = 60.0 * sampleRate;
+
+    if (rampLength == 0)
+        return anchorBeat + targetBpm * elapsed / samplesPerMinute;
+
+    auto length = static_cast<double>(rampLength);
+
+    // Integral of a linear tempo ramp, then the target tempo after it
+    if (elapsed <= length)
+        return anchorBeat + (startBpm * elapsed + (targetBpm - startBpm) * elapsed * elapsed / (2.0 * length)) / samplesPerMinute;
+
+    return anchorBeat + (0.5 * (startBpm + targetBpm) * length + targetBpm * (elapsed - length)) / samplesPerMinute;
+}
+
+double TransportClock::getTempo() const noexcept
+{
+    if (rampLength == 0)
+        return targetBpm;
+
+    auto progress = juce::jlimit(0.0, 1.0, static_cast<double>(samplePosition - anchorSample) / static_cast<double>(rampLength));
+    return startBpm + (targetBpm - startBpm) * progress;
+}
+
+void TransportClock::rebase(juce::int64 sample) noexcept
+{
+    auto beat = getBeatPositionAt(sample);
+    auto bpm = rampLength == 0 ? targetBpm
+                               : startBpm + (targetBpm - startBpm)
+                                     * juce::jlimit(0.0, 1.0, static_cast<double>(sample - anchorSample) / static_cast<double>(rampLength));
+
+    // Whatever is left of a ramp continues from the new anchor
+    auto rampLeft = juce::jmax((juce::int64) 0, anchorSample + rampLength - sample);
+
+    anchorSample = sample;
+    anchorBeat = beat;
+    startBpm = bpm;
+    rampLength = rampLength == 0 ? 0 : rampLeft;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Internal Transport Clock for AI Band Plugin
+
+    Created by Sergie Code - Software Engineer & Programming Educator
+    Part of the AI Band Ecosystem for musicians
+    YouTube: https://www.youtube.com/@SergieCode
+    GitHub: https://github.com/sergiecode
+
+    Keeps the playback position when no host transport is available. Time is
+    a 64-bit sample counter; the beat position is computed from it in closed
+    form relative to the last tempo change instead of being accumulated per
+    block, so rounding never builds up and the position stays exact after
+    hours of playback, whatever the block sizes.
+
+    Tempo changes can be immediate or ramp linearly (in BPM) over a number of
+    samples. All methods are allocation free and meant for the audio thread.
+*/
+class TransportClock
+{
+public:
+    //==============================================================================
+    TransportClock() = default;
+
+    //==============================================================================
+    /** Set the sample rate, keeping the current beat position */
+    void setSampleRate(double newSampleRate) noexcept;
+
+    /** Restart the sample counter at a beat position, keeping the tempo */
+    void reset(double beat = 0.0) noexcept;
+
+    /** Change the tempo
+        @param bpm              New tempo in beats per minute
+        @param rampLength       Samples over which the tempo moves linearly
+                                from the current tempo to bpm (0 = immediately)
+    */
+    void setTempo(double bpm, juce::int64 rampLength = 0) noexcept;
+
+    /** Move the clock forward by a block */
+    void advance(int numSamples) noexcept;
+
+    //==============================================================================
+    /** Get the beat position at the current sample */
+    double getBeatPosition() const noexcept { return getBeatPositionAt(samplePosition); }
+
+    /** Get the beat position at an absolute sample position */
+    double getBeatPositionAt(juce::int64 sample) const noexcept;
+
+    /** Get the number of samples played since the last reset */
+    juce::int64 getSamplePosition() const noexcept { return samplePosition; }
+
+    /** Get the tempo at the current sample in BPM */
+    double getTempo() const noexcept;
+
+    /** Check if a tempo ramp is in progress */
+    bool isRamping() const noexcept { return rampLength > 0; }
+
+    /** Tempo range accepted by setTempo() */
+    static constexpr double minTempoBpm = 1.0;
+    static constexpr double maxTempoBpm = 999.0;
+
+private:
+    //==============================================================================
+    /** Move the anchor to a sample so positions are computed from there */
+    void rebase(juce::int64 sample) noexcept;
+
+    double sampleRate = 44100.0;
+    juce::int64 samplePosition = 0;
+
+    // The beat position is anchorBeat at anchorSample and follows the tempo
+    // segment that starts there: a ramp from startBpm to targetBpm over
+    // rampLength samples, then targetBpm
+    juce::int64 anchorSample = 0;
+    double anchorBeat = 0.0;
+    double startBpm = 120.0;
+    double targetBpm = 120.0;
+    juce::int64 rampLength = 0;
+
+    //==============================================================================
+    JUCE_LEAK_DETECTOR (TransportClock)
+};
@@ -0,0 +1,163 @@
+#include "AllocationGuard.h"
+#include "TestFramework.h"
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#ifndef AIBAND_DETECT_ALLOCATIONS
+ #define AIBAND_DETECT_ALLOCATIONS 0
+#endif
+
+namespace
+{
+    // Plain thread_local ints in the executable use static TLS, so touching
+    // them from inside the allocator never allocates itself
+    thread_local int activeGuards = 0;
+    thread_local int allocationCount = 0;
+    thread_local int deallocationCount = 0;
+
+    inline void recordAllocation() noexcept
+    {
+        if (activeGuards > 0)
+            ++allocationCount;
+    }
+
+    inline void recordDeallocation() noexcept
+    {
+        if (activeGuards > 0)
+            ++deallocationCount;
+    }
+}
+
+//==============================================================================
+#if AIBAND_DETECT_ALLOCATIONS && defined (__GLIBC__)
+
+// Interpose the C allocator; libstdc++'s operator new calls into it as well
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size)
+    {
+        recordAllocation();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        recordAllocation();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        recordAllocation();
+        return __libc_realloc(ptr, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        recordAllocation();
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size)
+    {
+        recordAllocation();
+        *result = __libc_memalign(alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void free(void* ptr)
+    {
+        if (ptr != nullptr)
+            recordDeallocation();
+
+        __libc_free(ptr);
+    }
+}
+
+#elif AIBAND_DETECT_ALLOCATIONS
+
+// No portable way to interpose malloc, so only C++ allocations are seen
+void* operator new(std::size_t size)
+{
+    recordAllocation();
+
+    if (auto* ptr = std::malloc(size > 0 ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    recordAllocation();
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        recordDeallocation();
+
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept                        { operator delete(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept             { operator delete(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept           { operator delete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept   { operator delete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { operator delete(ptr); }
+
+#endif
+
+//==============================================================================
+AllocationGuard::AllocationGuard(const char* name)
+    : scopeName(name),
+      allocationsAtStart(allocationCount),
+      deallocationsAtStart(deallocationCount)
+{
+    ++activeGuards;
+}
+
+AllocationGuard::~AllocationGuard()
+{
+    --activeGuards;
+
+    // Reported once counting has stopped, as the report allocates itself
+    auto numAllocations = getNumAllocations();
+
+    if (numAllocations > 0)
+        TestFramework::assertEqualInt(0, numAllocations, juce::String("Allocations in ") + scopeName);
+}
+
+//==============================================================================
+int AllocationGuard::getNumAllocations() const noexcept
+{
+    return allocationCount - allocationsAtStart;
+}
+
+int AllocationGuard::getNumDeallocations() const noexcept
+{
+    return deallocationCount - deallocationsAtStart;
+}
+
+bool AllocationGuard::isEnabled() noexcept
+{
+    return AIBAND_DETECT_ALLOCATIONS != 0;
+}
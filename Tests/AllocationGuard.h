@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Allocation Guard for AI Band Plugin Tests
+
+    Counts the heap allocations the current thread makes while a guard is in
+    scope, so tests can prove real-time code paths never allocate. Any
+    allocation inside the scope fails the running test when the guard goes
+    out of scope, whether or not the test checks the count itself.
+
+    Counting needs the test executable to be built with
+    AIBAND_DETECT_ALLOCATIONS=1 (CMake option DETECT_RT_ALLOCATIONS). The
+    allocator is then intercepted for the whole executable: on Linux malloc,
+    calloc, realloc and free are interposed (which also covers operator new);
+    elsewhere the global operator new/delete are replaced.
+*/
+class AllocationGuard
+{
+public:
+    //==============================================================================
+    /** Start counting allocations on the calling thread
+        @param scopeName    Names the guarded code in the failure message
+    */
+    explicit AllocationGuard(const char* scopeName = "guarded scope");
+
+    /** Stop counting, and fail the test if anything was allocated */
+    ~AllocationGuard();
+
+    //==============================================================================
+    /** Get the number of allocations made since the guard was created */
+    int getNumAllocations() const noexcept;
+
+    /** Get the number of deallocations made since the guard was created */
+    int getNumDeallocations() const noexcept;
+
+    /** Check if the build intercepts the allocator (otherwise counts stay 0) */
+    static bool isEnabled() noexcept;
+
+private:
+    //==============================================================================
+    const char* scopeName;
+    int allocationsAtStart;
+    int deallocationsAtStart;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE (AllocationGuard)
+};
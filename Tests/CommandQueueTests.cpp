@@ -0,0 +1,180 @@
+#include "CommandQueueTests.h"
+
+namespace
+{
+    /** Sends numbered commands, like an editor or network thread would */
+    class SenderThread : public juce::Thread
+    {
+    public:
+        SenderThread(CommandQueue& queueToUse, int senderIndex, int commandsToSend)
+            : juce::Thread("Command Sender"),
+              queue(queueToUse),
+              sender(senderIndex),
+              numCommands(commandsToSend)
+        {
+        }
+
+        void run() override
+        {
+            CommandQueue::Command command;
+            command.type = CommandQueue::Command::seek;
+            command.trackIndex = sender;
+
+            for (int i = 0; i < numCommands && !threadShouldExit(); ++i)
+            {
+                command.value = i;
+
+                // A full queue is retried, as the audio thread drains it
+                while (!queue.push(command) && !threadShouldExit())
+                    juce::Thread::yield();
+            }
+        }
+
+    private:
+        CommandQueue& queue;
+        int sender;
+        int numCommands;
+    };
+}
+
+//==============================================================================
+CommandQueueTests::CommandQueueTests()
+{
+}
+
+CommandQueueTests::~CommandQueueTests()
+{
+}
+
+//==============================================================================
+bool CommandQueueTests::runAllTests()
+{
+    DBG("=== Running CommandQueue Tests ===");
+
+    bool allPassed = true;
+
+    allPassed &= testOrdering();
+    allPassed &= testCapacity();
+    allPassed &= testConcurrentSenders();
+
+    DBG("=== CommandQueue Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool CommandQueueTests::testOrdering()
+{
+    DBG("Testing command order...");
+
+    CommandQueue queue;
+    CommandQueue::Command command;
+
+    TestFramework::assertTrue(!queue.pop(command), "New queue is empty");
+
+    command.type = CommandQueue::Command::setTrackMuted;
+    command.trackIndex = 3;
+    command.value = 1.0;
+    queue.push(command);
+
+    command.type = CommandQueue::Command::setTempo;
+    command.trackIndex = 0;
+    command.value = 90.0;
+    command.secondValue = 2.0;
+    queue.push(command);
+
+    CommandQueue::Command first, second;
+    bool popped = queue.pop(first) && queue.pop(second);
+
+    TestFramework::assertTrue(popped, "Both commands arrive");
+    TestFramework::assertTrue(first.type == CommandQueue::Command::setTrackMuted && first.trackIndex == 3,
+                              "First command comes out first");
+    TestFramework::assertTrue(second.type == CommandQueue::Command::setTempo
+                               && second.value == 90.0 && second.secondValue == 2.0,
+                              "Second command keeps its values");
+    TestFramework::assertTrue(!queue.pop(command), "Queue is empty after draining");
+
+    return true;
+}
+
+bool CommandQueueTests::testCapacity()
+{
+    DBG("Testing queue capacity...");
+
+    CommandQueue queue;
+    CommandQueue::Command command;
+    command.type = CommandQueue::Command::seek;
+
+    int accepted = 0;
+
+    for (int i = 0; i < CommandQueue::capacity + 10; ++i)
+    {
+        command.value = i;
+        accepted += queue.push(command) ? 1 : 0;
+    }
+
+    TestFramework::assertEqualInt(CommandQueue::capacity, accepted, "Full queue rejects further commands");
+
+    // Drain and refill a few laps, so every slot is reused
+    bool inOrder = true;
+    int expected = 0;
+    int next = CommandQueue::capacity;
+
+    for (int lap = 0; lap < 3 * CommandQueue::capacity; ++lap)
+    {
+        inOrder &= queue.pop(command) && static_cast<int>(command.value) == expected++;
+
+        command.value = next++;
+        inOrder &= queue.push(command);
+    }
+
+    TestFramework::assertTrue(inOrder, "Slots are reused in order after draining");
+
+    return true;
+}
+
+bool CommandQueueTests::testConcurrentSenders()
+{
+    DBG("Testing concurrent senders...");
+
+    const int numSenders = 3;
+    const int commandsPerSender = 50000;
+
+    CommandQueue queue;
+    juce::OwnedArray<SenderThread> senders;
+
+    for (int i = 0; i < numSenders; ++i)
+        senders.add(new SenderThread(queue, i, commandsPerSender));
+
+    for (auto* sender : senders)
+        sender->startThread();
+
+    // Audio thread side: drain at "block boundaries"; each sender's commands
+    // must arrive complete, once each and in the order they were sent
+    int nextValue[numSenders] = {};
+    int received = 0;
+    bool inOrder = true;
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    while (received < numSenders * commandsPerSender
+           && juce::Time::getMillisecondCounterHiRes() - startTime < 10000.0)
+    {
+        CommandQueue::Command command;
+
+        while (queue.pop(command))
+        {
+            inOrder &= juce::isPositiveAndBelow(command.trackIndex, numSenders)
+                       && static_cast<int>(command.value) == nextValue[command.trackIndex]++;
+            ++received;
+        }
+
+        juce::Thread::yield();
+    }
+
+    for (auto* sender : senders)
+        sender->stopThread(2000);
+
+    TestFramework::assertEqualInt(numSenders * commandsPerSender, received, "Every command arrives once");
+    TestFramework::assertTrue(inOrder, "Each sender's commands keep their order");
+
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/CommandQueue.h"
+
+//==============================================================================
+/**
+    Unit Tests for CommandQueue class
+
+    Tests the control queue to the audio thread including:
+    - First-in first-out order
+    - Rejecting commands when full, and reusing slots after draining
+    - Several threads sending while the audio thread drains
+*/
+class CommandQueueTests
+{
+public:
+    //==============================================================================
+    CommandQueueTests();
+    ~CommandQueueTests();
+
+    //==============================================================================
+    /** Run all CommandQueue tests */
+    static bool runAllTests();
+
+    //==============================================================================
+    // Individual Test Methods
+
+    /** Test that commands come out in the order they went in */
+    static bool testOrdering();
+
+    /** Test a full queue and wrapping around the slots */
+    static bool testCapacity();
+
+    /** Test concurrent senders against one draining thread */
+    static bool testConcurrentSenders();
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CommandQueueTests)
+};
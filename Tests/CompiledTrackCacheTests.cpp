@@ -0,0 +1,353 @@
+#include "CompiledTrackCacheTests.h"
+
+namespace
+{
+    /** Check that two timelines hold the same events and note index */
+    bool haveSameContent(const MidiTimeline& expected, const MidiTimeline& actual)
+    {
+        if (expected.getNumEvents() != actual.getNumEvents()
+            || expected.getTicksPerQuarterNote() != actual.getTicksPerQuarterNote())
+            return false;
+
+        for (int i = 0; i < expected.getNumEvents(); ++i)
+        {
+            const auto& a = expected.getEvent(i);
+            const auto& b = actual.getEvent(i);
+            auto size = expected.getEventSize(a);
+
+            if (a.position != b.position || size != actual.getEventSize(b)
+                || std::memcmp(expected.getEventData(a), actual.getEventData(b), static_cast<size_t>(size)) != 0)
+                return false;
+        }
+
+        const auto& expectedIndex = expected.getNoteIndex();
+        const auto& actualIndex = actual.getNoteIndex();
+
+        if (expectedIndex.getNumIntervals() != actualIndex.getNumIntervals())
+            return false;
+
+        for (int i = 0; i < expectedIndex.getNumIntervals(); ++i)
+        {
+            const auto& a = expectedIndex.getInterval(i);
+            const auto& b = actualIndex.getInterval(i);
+
+            if (a.start != b.start || a.end != b.end || a.maxEnd != b.maxEnd || a.eventIndex != b.eventIndex)
+                return false;
+        }
+
+        return true;
+    }
+
+    /** Check that two tempo maps convert and count bars the same */
+    bool haveSameTempo(const TempoMap& expected, const TempoMap& actual)
+    {
+        if (expected.getNumSegments() != actual.getNumSegments()
+            || expected.getTicksPerQuarterNote() != actual.getTicksPerQuarterNote())
+            return false;
+
+        for (double beat = 0.0; beat < 40.0; beat += 0.75)
+        {
+            if (expected.beatsToSeconds(beat) != actual.beatsToSeconds(beat)
+                || expected.getNextBarLine(beat) != actual.getNextBarLine(beat)
+                || expected.getMeterAt(beat).numerator != actual.getMeterAt(beat).numerator)
+                return false;
+        }
+
+        return true;
+    }
+}
+
+//==============================================================================
+CompiledTrackCacheTests::CompiledTrackCacheTests()
+{
+}
+
+CompiledTrackCacheTests::~CompiledTrackCacheTests()
+{
+}
+
+//==============================================================================
+bool CompiledTrackCacheTests::runAllTests()
+{
+    DBG("=== Running CompiledTrackCache Tests ===");
+
+    bool allPassed = true;
+
+    allPassed &= testRoundTrip();
+    allPassed &= testKeying();
+    allPassed &= testRejectedFiles();
+    allPassed &= testTimelineCacheLoads();
+    allPassed &= testFolderLimits();
+
+    DBG("=== CompiledTrackCache Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool CompiledTrackCacheTests::testRoundTrip()
+{
+    DBG("Testing stored timelines...");
+
+    auto data = createMidiData(64);
+    MidiManager midiManager;
+    MidiTimeline parsed;
+    TestFramework::assertTrue(midiManager.loadMidiFromMemory(data.getData(), data.getSize(), parsed), "Source parsed");
+
+    CompiledTrackCache compiledTracks(TestFramework::createTempTestDirectory().getChildFile("cache"));
+    auto hash = TimelineCache::hashContent(data.getData(), data.getSize());
+
+    TestFramework::assertTrue(compiledTracks.load(hash, data.getSize()) == nullptr, "Nothing stored yet");
+    TestFramework::assertTrue(compiledTracks.store(hash, data.getSize(), parsed), "Timeline stored");
+    TestFramework::assertTrue(compiledTracks.getFolder().isDirectory(), "Cache folder created");
+
+    auto loaded = compiledTracks.load(hash, data.getSize());
+    TestFramework::assertTrue(loaded != nullptr, "Timeline loaded");
+
+    if (loaded == nullptr)
+        return true;
+
+    TestFramework::assertTrue(haveSameContent(parsed, *loaded), "Same events and note index");
+    TestFramework::assertTrue(loaded->getTempoMap() != nullptr && haveSameTempo(*parsed.getTempoMap(), *loaded->getTempoMap()),
+                              "Same tempo map");
+    TestFramework::assertTrue(loaded->getMemoryUsage() == parsed.getMemoryUsage(), "Same memory as the parsed timeline");
+
+    // The restored index answers like the one built by compiling
+    for (juce::int64 position = 0; position < parsed.getEndPosition(); position += 333)
+    {
+        auto expected = parsed.getNoteIndex().forEachNoteSoundingAt(position, [](const NoteIntervalIndex::Interval&) {});
+        auto actual = loaded->getNoteIndex().forEachNoteSoundingAt(position, [](const NoteIntervalIndex::Interval&) {});
+
+        if (expected != actual)
+        {
+            TestFramework::assertEqualInt(expected, actual, "Same notes sounding at " + juce::String(position));
+            break;
+        }
+    }
+
+    // Timelines without a tempo map (built from raw events) round-trip too
+    MidiTimeline untimed;
+    untimed.addEvent(juce::MidiMessage::noteOn(1, 60, (juce::uint8)100).getRawData(), 3, 0);
+    untimed.addEvent(juce::MidiMessage::noteOff(1, 60).getRawData(), 3, 100);
+    untimed.finishCompiling();
+    TestFramework::assertTrue(compiledTracks.store(1, 2, untimed), "Timeline without tempo map stored");
+
+    auto untimedLoaded = compiledTracks.load(1, 2);
+    TestFramework::assertTrue(untimedLoaded != nullptr && untimedLoaded->getTempoMap() == nullptr
+                              && haveSameContent(untimed, *untimedLoaded), "Timeline without tempo map loaded");
+
+    return true;
+}
+
+bool CompiledTrackCacheTests::testKeying()
+{
+    DBG("Testing entry keys...");
+
+    auto folder = TestFramework::createTempTestDirectory();
+    auto cacheFolder = CompiledTrackCache::getFolderFor(folder);
+    TestFramework::assertTrue(cacheFolder.getParentDirectory() == folder.getParentDirectory(), "Cache folder is a sibling");
+    TestFramework::assertEqualString(folder.getFileName() + "-aibc", cacheFolder.getFileName(), "Cache folder named after the source folder");
+
+    auto data = createMidiData(8);
+    MidiManager midiManager;
+    MidiTimeline parsed;
+    midiManager.loadMidiFromMemory(data.getData(), data.getSize(), parsed);
+
+    CompiledTrackCache compiledTracks(cacheFolder);
+    auto hash = TimelineCache::hashContent(data.getData(), data.getSize());
+    compiledTracks.store(hash, data.getSize(), parsed);
+
+    TestFramework::assertTrue(compiledTracks.getFileFor(hash, data.getSize()).hasFileExtension(CompiledTrackCache::fileExtension),
+                              "Entries use the .aibc extension");
+    TestFramework::assertTrue(compiledTracks.getFileFor(hash, data.getSize()) != compiledTracks.getFileFor(hash + 1, data.getSize()),
+                              "Each content has its own file");
+
+    TestFramework::assertTrue(compiledTracks.load(hash, data.getSize()) != nullptr, "Same content hits");
+    TestFramework::assertTrue(compiledTracks.load(hash + 1, data.getSize()) == nullptr, "Other content misses");
+    TestFramework::assertTrue(compiledTracks.load(hash, data.getSize() + 1) == nullptr, "Other size misses");
+
+    // Another instance on the same folder finds the entry
+    CompiledTrackCache otherInstance(cacheFolder);
+    TestFramework::assertTrue(otherInstance.load(hash, data.getSize()) != nullptr, "Entry shared through the folder");
+
+    return true;
+}
+
+bool CompiledTrackCacheTests::testRejectedFiles()
+{
+    DBG("Testing rejected cache files...");
+
+    auto data = createMidiData(16);
+    MidiManager midiManager;
+    MidiTimeline parsed;
+    midiManager.loadMidiFromMemory(data.getData(), data.getSize(), parsed);
+
+    CompiledTrackCache compiledTracks(TestFramework::createTempTestDirectory().getChildFile("cache"));
+    auto hash = TimelineCache::hashContent(data.getData(), data.getSize());
+    auto file = compiledTracks.getFileFor(hash, data.getSize());
+
+    compiledTracks.store(hash, data.getSize(), parsed);
+
+    juce::MemoryBlock stored;
+    file.loadFileAsData(stored);
+    TestFramework::assertTrue(stored.getSize() > 64, "Entry written");
+
+    auto storeModified = [&](std::function<void(juce::MemoryBlock&)> modify)
+    {
+        juce::MemoryBlock modified(stored.getData(), stored.getSize());
+        modify(modified);
+        file.replaceWithData(modified.getData(), modified.getSize());
+        return compiledTracks.load(hash, data.getSize());
+    };
+
+    TestFramework::assertTrue(storeModified([&](juce::MemoryBlock& block) { block[4] = static_cast<char>(block[4] ^ 0x7f); }) == nullptr,
+                              "Other format version rejected");
+    TestFramework::assertTrue(storeModified([&](juce::MemoryBlock& block) { block[0] = 'X'; }) == nullptr,
+                              "Other magic number rejected");
+    TestFramework::assertTrue(storeModified([&](juce::MemoryBlock& block) { block.setSize(block.getSize() - 1); }) == nullptr,
+                              "Truncated file rejected");
+    TestFramework::assertTrue(storeModified([&](juce::MemoryBlock& block) { block.append("x", 1); }) == nullptr,
+                              "Trailing data rejected");
+
+    // The sysex is the only long message: its table entry sits right before its data
+    const int sysexSize = 9;
+    TestFramework::assertTrue(storeModified([&](juce::MemoryBlock& block)
+                              {
+                                  block[block.getSize() - sysexSize - 1] = 0x7f;
+                              }) == nullptr,
+                              "Long message past its data rejected");
+
+    // An entry copied under another source's name is not that source
+    file.replaceWithData(stored.getData(), stored.getSize());
+    compiledTracks.getFileFor(hash + 1, data.getSize()).replaceWithData(stored.getData(), stored.getSize());
+    TestFramework::assertTrue(compiledTracks.load(hash + 1, data.getSize()) == nullptr, "Entry of another source rejected");
+    TestFramework::assertTrue(compiledTracks.load(hash, data.getSize()) != nullptr, "Intact entry still loads");
+
+    // A rejected entry is replaced by the next store
+    file.replaceWithData("garbage", 7);
+    TestFramework::assertTrue(compiledTracks.load(hash, data.getSize()) == nullptr, "Garbage rejected");
+    TestFramework::assertTrue(compiledTracks.store(hash, data.getSize(), parsed), "Entry rewritten");
+    TestFramework::assertTrue(compiledTracks.load(hash, data.getSize()) != nullptr, "Rewritten entry loads");
+
+    return true;
+}
+
+bool CompiledTrackCacheTests::testTimelineCacheLoads()
+{
+    DBG("Testing compiled loads through the timeline cache...");
+
+    CompiledTrackCache compiledTracks(CompiledTrackCache::getFolderFor(TestFramework::createTempTestDirectory()));
+    auto data = createMidiData(32);
+    MidiManager midiManager;
+
+    // First session: parsed, and stored for the next one
+    TimelineCache firstSession;
+    auto parsed = firstSession.getTimeline(data.getData(), data.getSize(), midiManager, &compiledTracks);
+    TestFramework::assertTrue(parsed != nullptr, "Parsed on a cold start");
+    TestFramework::assertEqualInt(0, firstSession.getStatistics().compiledLoads, "Nothing compiled yet");
+
+    auto hash = TimelineCache::hashContent(data.getData(), data.getSize());
+    TestFramework::assertTrue(compiledTracks.getFileFor(hash, data.getSize()).existsAsFile(), "Parsed track stored");
+
+    // Next session: mapped from disk
+    TimelineCache nextSession;
+    auto loaded = nextSession.getTimeline(data.getData(), data.getSize(), midiManager, &compiledTracks);
+    TestFramework::assertTrue(loaded != nullptr, "Loaded on a warm start");
+    TestFramework::assertEqualInt(1, nextSession.getStatistics().misses, "Still a miss in memory");
+    TestFramework::assertEqualInt(1, nextSession.getStatistics().compiledLoads, "Served by the compiled track");
+
+    if (parsed != nullptr && loaded != nullptr)
+        TestFramework::assertTrue(haveSameContent(*parsed, *loaded), "Warm load plays the same track");
+
+    // Later lookups are served from memory as before
+    nextSession.getTimeline(data.getData(), data.getSize(), midiManager, &compiledTracks);
+    TestFramework::assertEqualInt(1, nextSession.getStatistics().hits, "Memory hit after the warm load");
+
+    // Data that fails to parse is never stored
+    const char text[] = "not a MIDI file";
+    TestFramework::assertTrue(nextSession.getTimeline(text, sizeof(text), midiManager, &compiledTracks) == nullptr, "Invalid data rejected");
+    TestFramework::assertTrue(!compiledTracks.getFileFor(TimelineCache::hashContent(text, sizeof(text)), sizeof(text)).exists(),
+                              "Invalid data not stored");
+
+    return true;
+}
+
+bool CompiledTrackCacheTests::testFolderLimits()
+{
+    DBG("Testing cache folder limits...");
+
+    auto folder = TestFramework::createTempTestDirectory();
+    auto data = createMidiData(8);
+    MidiManager midiManager;
+    MidiTimeline parsed;
+    midiManager.loadMidiFromMemory(data.getData(), data.getSize(), parsed);
+
+    CompiledTrackCache compiledTracks(CompiledTrackCache::getFolderFor(folder).getChildFile("limits"));
+    compiledTracks.setLimits(3, CompiledTrackCache::defaultMaxBytes);
+
+    // Five takes, each written a second after the one before
+    const juce::int64 firstWritten = 1000000000000;
+
+    for (juce::uint64 take = 1; take <= 5; ++take)
+    {
+        compiledTracks.store(take, data.getSize(), parsed);
+        compiledTracks.getFileFor(take, data.getSize())
+            .setLastModificationTime(juce::Time(firstWritten + static_cast<juce::int64>(take) * 1000));
+    }
+
+    auto isStored = [&](juce::uint64 take) { return compiledTracks.getFileFor(take, data.getSize()).existsAsFile(); };
+
+    TestFramework::assertTrue(!isStored(1) && !isStored(2), "Oldest entries removed beyond the count");
+    TestFramework::assertTrue(isStored(3) && isStored(4) && isStored(5), "Newest entries kept");
+    TestFramework::assertTrue(compiledTracks.load(5, data.getSize()) != nullptr, "Kept entries still load");
+
+    // A size limit of two entries keeps the new one and the newest before it
+    auto entrySize = compiledTracks.getFileFor(5, data.getSize()).getSize();
+    compiledTracks.setLimits(100, entrySize * 2);
+    compiledTracks.store(6, data.getSize(), parsed);
+
+    TestFramework::assertTrue(!isStored(3) && !isStored(4), "Oldest entries removed beyond the size");
+    TestFramework::assertTrue(isStored(5) && isStored(6), "Entries within the size kept");
+
+    // An entry larger than the whole limit is still written
+    compiledTracks.setLimits(100, 0);
+    TestFramework::assertTrue(compiledTracks.store(7, data.getSize(), parsed) && isStored(7) && !isStored(6),
+                              "New entry kept whatever the limits");
+
+    return true;
+}
+
+//==============================================================================
+// Helper Methods
+
+juce::MemoryBlock CompiledTrackCacheTests::createMidiData(int numNotes)
+{
+    juce::MidiMessageSequence track;
+    track.addEvent(juce::MidiMessage::tempoMetaEvent(600000), 0.0);
+    track.addEvent(juce::MidiMessage::timeSignatureMetaEvent(3, 4), 0.0);
+    track.addEvent(juce::MidiMessage::tempoMetaEvent(400000), 8.0 * 480);
+
+    const juce::uint8 sysexData[] = { 0x7e, 0x7f, 0x09, 0x01, 0x00, 0x00, 0x00 };
+    track.addEvent(juce::MidiMessage::createSysExMessage(sysexData, static_cast<int>(sizeof(sysexData))), 0.0);
+
+    // Notes two beats long, one per beat, so every position has notes held across it
+    for (int i = 0; i < numNotes; ++i)
+    {
+        track.addEvent(juce::MidiMessage::noteOn(1, 36 + i % 24, (juce::uint8)100), i * 480.0);
+        track.addEvent(juce::MidiMessage::noteOff(1, 36 + i % 24), i * 480.0 + 960.0);
+    }
+
+    track.updateMatchedPairs();
+
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(480);
+    midiFile.addTrack(track);
+
+    juce::MemoryBlock data;
+
+    {
+        juce::MemoryOutputStream stream(data, false);
+        midiFile.writeTo(stream);
+    }
+
+    return data;
+}
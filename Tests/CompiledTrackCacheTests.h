@@ -0,0 +1,54 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/CompiledTrackCache.h"
+#include "../Source/TimelineCache.h"
+
+//==============================================================================
+/**
+    Unit Tests for CompiledTrackCache class
+
+    Tests the on-disk compiled track cache including:
+    - Timelines, note indexes and tempo maps restored exactly
+    - Entries keyed by source content
+    - Damaged, foreign and outdated files rejected
+    - Warm loads through the shared TimelineCache
+*/
+class CompiledTrackCacheTests
+{
+public:
+    //==============================================================================
+    CompiledTrackCacheTests();
+    ~CompiledTrackCacheTests();
+
+    //==============================================================================
+    /** Run all CompiledTrackCache tests */
+    static bool runAllTests();
+
+    //==============================================================================
+    // Individual Test Methods
+
+    /** Test that a stored timeline loads back identical */
+    static bool testRoundTrip();
+
+    /** Test that entries are found by source content only */
+    static bool testKeying();
+
+    /** Test that invalid cache files are rejected and replaced */
+    static bool testRejectedFiles();
+
+    /** Test loading compiled tracks through the TimelineCache */
+    static bool testTimelineCacheLoads();
+
+    /** Test that the oldest entries are removed beyond the folder's limits */
+    static bool testFolderLimits();
+
+private:
+    //==============================================================================
+    /** Helper to build the content of a MIDI file with tempo, meter, sysex and notes */
+    static juce::MemoryBlock createMidiData(int numNotes);
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompiledTrackCacheTests)
+};
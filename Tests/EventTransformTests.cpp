@@ -0,0 +1,193 @@
+#include "EventTransformTests.h"
+
+namespace
+{
+    /** Transform a three-byte message and return it packed as 0xSSDDVV,
+        or -1 if it was dropped
+    */
+    int transformMessage(const EventTransform& transform, int status, int data1, int data2)
+    {
+        juce::uint8 bytes[3] = { static_cast<juce::uint8>(status),
+                                 static_cast<juce::uint8>(data1),
+                                 static_cast<juce::uint8>(data2) };
+
+        if (!transform.apply(bytes, 3))
+            return -1;
+
+        return (bytes[0] << 16) | (bytes[1] << 8) | bytes[2];
+    }
+}
+
+//==============================================================================
+EventTransformTests::EventTransformTests()
+{
+}
+
+EventTransformTests::~EventTransformTests()
+{
+}
+
+//==============================================================================
+bool EventTransformTests::runAllTests()
+{
+    DBG("=== Running EventTransform Tests ===");
+
+    bool allPassed = true;
+
+    allPassed &= testVelocity();
+    allPassed &= testNotes();
+    allPassed &= testChannels();
+    allPassed &= testBake();
+
+    DBG("=== EventTransform Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool EventTransformTests::testVelocity()
+{
+    DBG("Testing velocity transforms...");
+
+    EventTransform identity;
+    TestFramework::assertTrue(identity.isIdentity(), "New transform changes nothing");
+    TestFramework::assertEqualInt(0x903c64, transformMessage(identity, 0x90, 60, 100), "Identity keeps the message");
+
+    EventTransform half;
+    half.scaleVelocity(0.5f);
+    TestFramework::assertTrue(!half.isIdentity(), "Scaled transform is not the identity");
+    TestFramework::assertEqualInt(0x903c32, transformMessage(half, 0x90, 60, 100), "Velocity is halved");
+    TestFramework::assertEqualInt(0x903c01, transformMessage(half, 0x90, 60, 1), "Scaled velocity stays at least 1");
+    TestFramework::assertEqualInt(0x903c00, transformMessage(half, 0x90, 60, 0), "Note-on with velocity 0 stays a note-off");
+    TestFramework::assertEqualInt(0x803c64, transformMessage(half, 0x80, 60, 100), "Note-off velocity is kept");
+
+    EventTransform loud;
+    loud.scaleVelocity(4.0f);
+    TestFramework::assertEqualInt(0x903c7f, transformMessage(loud, 0x90, 60, 100), "Scaled velocity stays at most 127");
+
+    EventTransform soft;
+    soft.applyVelocityCurve(2.0f);
+    TestFramework::assertEqualInt(0x903c7f, transformMessage(soft, 0x90, 60, 127), "Curve keeps full velocity");
+    TestFramework::assertEqualInt(0x903c20, transformMessage(soft, 0x90, 60, 64), "Curve above 1 softens notes");
+
+    // Stages compose in order: halving after the curve is not the same as before it
+    EventTransform curveThenHalf, halfThenCurve;
+    curveThenHalf.applyVelocityCurve(2.0f).scaleVelocity(0.5f);
+    halfThenCurve.scaleVelocity(0.5f).applyVelocityCurve(2.0f);
+    TestFramework::assertEqualInt(0x903c40, transformMessage(curveThenHalf, 0x90, 60, 127), "Curve then halve");
+    TestFramework::assertEqualInt(0x903c20, transformMessage(halfThenCurve, 0x90, 60, 127), "Halve then curve");
+
+    return true;
+}
+
+bool EventTransformTests::testNotes()
+{
+    DBG("Testing note transforms...");
+
+    EventTransform up;
+    up.transpose(12);
+    TestFramework::assertEqualInt(0x904864, transformMessage(up, 0x90, 60, 100), "Note-on is transposed");
+    TestFramework::assertEqualInt(0x804800, transformMessage(up, 0x80, 60, 0), "Note-off is transposed with it");
+    TestFramework::assertEqualInt(0xa04840, transformMessage(up, 0xa0, 60, 64), "Aftertouch is transposed");
+    TestFramework::assertEqualInt(0xb03c40, transformMessage(up, 0xb0, 60, 64), "Controller number is not a note");
+    TestFramework::assertEqualInt(-1, transformMessage(up, 0x90, 120, 100), "Note pushed above 127 is dropped");
+
+    // Transposing back and forth within range is the identity again
+    EventTransform roundTrip;
+    roundTrip.transpose(5).transpose(-5);
+    TestFramework::assertEqualInt(0x903c64, transformMessage(roundTrip, 0x90, 60, 100), "Round trip keeps the note");
+    TestFramework::assertEqualInt(-1, transformMessage(roundTrip, 0x90, 125, 100), "Note dropped on the way stays dropped");
+
+    // Drum kit map: acoustic snare to electric snare, and no cowbell
+    std::array<juce::uint8, 128> kitMap;
+    for (size_t i = 0; i < kitMap.size(); ++i)
+        kitMap[i] = static_cast<juce::uint8>(i);
+
+    kitMap[38] = 40;
+    kitMap[56] = EventTransform::dropNote;
+
+    EventTransform kit;
+    kit.remapNotes(kitMap);
+    TestFramework::assertEqualInt(0x992864, transformMessage(kit, 0x99, 38, 100), "Snare is remapped");
+    TestFramework::assertEqualInt(0x992464, transformMessage(kit, 0x99, 36, 100), "Kick is kept");
+    TestFramework::assertEqualInt(-1, transformMessage(kit, 0x99, 56, 100), "Cowbell is dropped");
+
+    // Transforms with the same effect compare equal, however they were built
+    EventTransform single;
+    single.remapNote(38, 40).remapNote(56, 200);
+    TestFramework::assertTrue(single != kit, "Different note maps differ");
+
+    single.remapNotes(kitMap);
+    EventTransform twice;
+    twice.remapNotes(kitMap).remapNotes(kitMap);
+    TestFramework::assertTrue(single == twice, "Same tables compare equal");
+
+    return true;
+}
+
+bool EventTransformTests::testChannels()
+{
+    DBG("Testing channel transforms...");
+
+    EventTransform bassToTwo;
+    bassToTwo.remapChannel(1, 2);
+    TestFramework::assertEqualInt(0x913c64, transformMessage(bassToTwo, 0x90, 60, 100), "Channel 1 moves to channel 2");
+    TestFramework::assertEqualInt(0x923c64, transformMessage(bassToTwo, 0x92, 60, 100), "Other channels are kept");
+    TestFramework::assertEqualInt(0xb14007, transformMessage(bassToTwo, 0xb0, 64, 7), "Controllers move with the notes");
+
+    EventTransform drums;
+    drums.setChannel(10);
+    TestFramework::assertEqualInt(0x992464, transformMessage(drums, 0x93, 36, 100), "Every channel moves to channel 10");
+    TestFramework::assertEqualInt(0xf80000, transformMessage(drums, 0xf8, 0, 0), "System messages pass unchanged");
+
+    EventTransform invalid;
+    invalid.setChannel(17).remapChannel(0, 3);
+    TestFramework::assertTrue(invalid.isIdentity(), "Channels outside 1-16 are ignored");
+
+    return true;
+}
+
+bool EventTransformTests::testBake()
+{
+    DBG("Testing baked timelines...");
+
+    MidiTimeline source;
+    source.setTicksPerQuarterNote(480);
+    source.setTempoMap(std::make_shared<const TempoMap>(100.0, 480));
+
+    const juce::uint8 kickOn[] = { 0x99, 36, 100 };
+    const juce::uint8 kickOff[] = { 0x89, 36, 0 };
+    const juce::uint8 bellOn[] = { 0x99, 56, 90 };
+    const juce::uint8 bellOff[] = { 0x89, 56, 0 };
+    const juce::uint8 sysex[] = { 0xf0, 0x7e, 0x7f, 0x09, 0x01, 0xf7 };
+
+    source.addEvent(sysex, sizeof(sysex), 0);
+    source.addEvent(kickOn, sizeof(kickOn), 0);
+    source.addEvent(bellOn, sizeof(bellOn), 240);
+    source.addEvent(kickOff, sizeof(kickOff), 240);
+    source.addEvent(bellOff, sizeof(bellOff), 480);
+    source.finishCompiling();
+
+    EventTransform transform;
+    transform.remapNote(56, EventTransform::dropNote).remapNote(36, 35).scaleVelocity(0.5f);
+
+    MidiTimeline baked;
+    transform.bake(source, baked);
+
+    TestFramework::assertEqualInt(480, baked.getTicksPerQuarterNote(), "Tick resolution is kept");
+    TestFramework::assertTrue(baked.getTempoMap() == source.getTempoMap(), "Tempo map is shared");
+    TestFramework::assertEqualInt(3, baked.getNumEvents(), "Dropped notes leave sysex, note-on and note-off");
+
+    const auto& first = baked.getEvent(0);
+    TestFramework::assertEqualInt(6, baked.getEventSize(first), "Sysex is copied whole");
+    TestFramework::assertTrue(std::memcmp(baked.getEventData(first), sysex, sizeof(sysex)) == 0, "Sysex bytes are unchanged");
+
+    const auto* on = baked.getEventData(baked.getEvent(1));
+    TestFramework::assertTrue(on[0] == 0x99 && on[1] == 35 && on[2] == 50, "Kick is remapped and softened");
+
+    const auto& off = baked.getEvent(2);
+    TestFramework::assertTrue(off.position == 240 && baked.getEventData(off)[1] == 35, "Note-off keeps its time and follows the note");
+
+    TestFramework::assertEqualInt(5, source.getNumEvents(), "Source timeline is left alone");
+
+    return true;
+}
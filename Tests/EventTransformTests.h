@@ -0,0 +1,45 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/EventTransform.h"
+
+//==============================================================================
+/**
+    Unit Tests for EventTransform class
+
+    Tests the event transform including:
+    - Velocity scaling and curves, with note-offs left alone
+    - Transposition, note maps and dropped notes
+    - Channel remapping and messages that pass unchanged
+    - Baking a transformed copy of a timeline
+*/
+class EventTransformTests
+{
+public:
+    //==============================================================================
+    EventTransformTests();
+    ~EventTransformTests();
+
+    //==============================================================================
+    /** Run all EventTransform tests */
+    static bool runAllTests();
+
+    //==============================================================================
+    // Individual Test Methods
+
+    /** Test velocity scaling and curves */
+    static bool testVelocity();
+
+    /** Test transposition and note maps */
+    static bool testNotes();
+
+    /** Test channel remapping */
+    static bool testChannels();
+
+    /** Test baking a timeline */
+    static bool testBake();
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EventTransformTests)
+};
@@ -0,0 +1,469 @@
+#include "MidiFileParserTests.h"
+
+namespace
+{
+    /** Check that two timelines hold the same events at the same ticks */
+    bool haveSameEvents(const MidiTimeline& expected, const MidiTimeline& actual)
+    {
+        if (expected.getNumEvents() != actual.getNumEvents())
+            return false;
+
+        for (int i = 0; i < expected.getNumEvents(); ++i)
+        {
+            const auto& a = expected.getEvent(i);
+            const auto& b = actual.getEvent(i);
+            auto size = expected.getEventSize(a);
+
+            if (a.position != b.position || size != actual.getEventSize(b)
+                || std::memcmp(expected.getEventData(a), actual.getEventData(b), static_cast<size_t>(size)) != 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    /** Check one event's tick and bytes */
+    bool isEvent(const MidiTimeline& timeline, int index, juce::int64 tick, std::vector<juce::uint8> bytes)
+    {
+        if (index >= timeline.getNumEvents())
+            return false;
+
+        const auto& event = timeline.getEvent(index);
+        return event.position == tick
+            && timeline.getEventSize(event) == static_cast<int>(bytes.size())
+            && std::memcmp(timeline.getEventData(event), bytes.data(), bytes.size()) == 0;
+    }
+}
+
+//==============================================================================
+MidiFileParserTests::MidiFileParserTests()
+{
+}
+
+MidiFileParserTests::~MidiFileParserTests()
+{
+}
+
+//==============================================================================
+bool MidiFileParserTests::runAllTests()
+{
+    DBG("=== Running MidiFileParser Tests ===");
+
+    bool allPassed = true;
+
+    allPassed &= testMatchesMidiFile();
+    allPassed &= testRunningStatus();
+    allPassed &= testNoteOrdering();
+    allPassed &= testTempoMap();
+    allPassed &= testMalformedData();
+    allPassed &= testParallelTracks();
+
+    DBG("=== MidiFileParser Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool MidiFileParserTests::testMatchesMidiFile()
+{
+    DBG("Testing against the juce::MidiFile path...");
+
+    // A conductor track and two instrument tracks with every kind of event
+    juce::MidiMessageSequence conductor;
+    conductor.addEvent(juce::MidiMessage::tempoMetaEvent(600000), 0.0);
+    conductor.addEvent(juce::MidiMessage::timeSignatureMetaEvent(3, 4), 0.0);
+    conductor.addEvent(juce::MidiMessage::tempoMetaEvent(400000), 1440.0);
+
+    const juce::uint8 sysexData[] = { 0x43, 0x10, 0x4c, 0x00, 0x00, 0x7e, 0x00 };
+
+    juce::MidiMessageSequence bass;
+    bass.addEvent(juce::MidiMessage::createSysExMessage(sysexData, static_cast<int>(sizeof(sysexData))), 0.0);
+    bass.addEvent(juce::MidiMessage::programChange(2, 33), 0.0);
+    bass.addEvent(juce::MidiMessage::controllerEvent(2, 7, 100), 10.0);
+
+    juce::MidiMessageSequence drums;
+
+    for (int beat = 0; beat < 16; ++beat)
+    {
+        bass.addEvent(juce::MidiMessage::noteOn(2, 40 + beat % 5, (juce::uint8)90), beat * 480.0);
+        bass.addEvent(juce::MidiMessage::noteOff(2, 40 + beat % 5), beat * 480.0 + 400.0);
+        bass.addEvent(juce::MidiMessage::pitchWheel(2, 8192 + beat * 100), beat * 480.0 + 200.0);
+
+        drums.addEvent(juce::MidiMessage::noteOn(10, 36, (juce::uint8)120), beat * 480.0);
+        drums.addEvent(juce::MidiMessage::noteOn(10, 42, (juce::uint8)80), beat * 480.0);
+        drums.addEvent(juce::MidiMessage::noteOff(10, 36), beat * 480.0 + 120.0);
+        drums.addEvent(juce::MidiMessage::noteOff(10, 42), beat * 480.0 + 120.0);
+    }
+
+    bass.updateMatchedPairs();
+    drums.updateMatchedPairs();
+
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(480);
+    midiFile.addTrack(conductor);
+    midiFile.addTrack(bass);
+    midiFile.addTrack(drums);
+
+    juce::MemoryBlock data;
+
+    {
+        juce::MemoryOutputStream stream(data, false);
+        midiFile.writeTo(stream);
+    }
+
+    // Reference: read through juce::MidiFile and convert
+    MidiManager midiManager;
+    juce::MidiFile readBack;
+    juce::MemoryInputStream input(data, false);
+    TestFramework::assertTrue(readBack.readFrom(input), "juce::MidiFile reads the data");
+
+    MidiTimeline expected;
+    midiManager.convertMidiFileToTimeline(readBack, expected);
+
+    MidiFileParser parser;
+    MidiTimeline parsed;
+    TestFramework::assertTrue(parser.parse(data.getData(), data.getSize(), parsed), "Parser reads the data");
+
+    TestFramework::assertEqualInt(expected.getNumEvents(), parsed.getNumEvents(), "Same number of events");
+    TestFramework::assertTrue(haveSameEvents(expected, parsed), "Same events at the same ticks");
+    TestFramework::assertEqualInt(expected.getTicksPerQuarterNote(), parsed.getTicksPerQuarterNote(), "Same resolution");
+
+    const auto& expectedTempo = *expected.getTempoMap();
+    const auto& parsedTempo = *parsed.getTempoMap();
+    TestFramework::assertEqualInt(expectedTempo.getNumSegments(), parsedTempo.getNumSegments(), "Same tempo segments");
+
+    for (double tick = 0.0; tick < 8000.0; tick += 333.0)
+        TestFramework::assertTrue(expectedTempo.ticksToSeconds(tick) == parsedTempo.ticksToSeconds(tick), "Same tempo map");
+
+    // The same parser is reused for the next file
+    MidiTimeline again;
+    parser.parse(data.getData(), data.getSize(), again);
+    TestFramework::assertTrue(haveSameEvents(parsed, again), "Reused parser gives the same timeline");
+
+    // loadMidiFromMemory() goes through the parser
+    MidiTimeline loaded;
+    TestFramework::assertTrue(midiManager.loadMidiFromMemory(data.getData(), data.getSize(), loaded), "Loaded from memory");
+    TestFramework::assertTrue(haveSameEvents(expected, loaded), "Loaded timeline matches");
+
+    return true;
+}
+
+bool MidiFileParserTests::testRunningStatus()
+{
+    DBG("Testing running status...");
+
+    auto data = createFile({
+        0x00, 0x90, 0x3c, 0x64,     // note-on
+        0x0a, 0x3e, 0x64,           // note-on, running status
+        0x0a, 0x3c, 0x00,           // note-on with velocity 0 releases
+        0x00, 0xc0, 0x05,           // program change
+        0x05, 0x07,                 // program change, running status
+        0x00, 0xff, 0x2f, 0x00
+    });
+
+    MidiFileParser parser;
+    MidiTimeline timeline;
+    TestFramework::assertTrue(parser.parse(data.getData(), data.getSize(), timeline), "File parsed");
+    TestFramework::assertEqualInt(5, timeline.getNumEvents(), "Every message decoded");
+
+    TestFramework::assertTrue(isEvent(timeline, 0, 0, { 0x90, 0x3c, 0x64 }), "First note-on");
+    TestFramework::assertTrue(isEvent(timeline, 1, 10, { 0x90, 0x3e, 0x64 }), "Note-on without status byte");
+    TestFramework::assertTrue(isEvent(timeline, 2, 20, { 0x90, 0x3c, 0x00 }), "Release without status byte");
+    TestFramework::assertTrue(isEvent(timeline, 3, 20, { 0xc0, 0x05 }), "Two-byte message");
+    TestFramework::assertTrue(isEvent(timeline, 4, 25, { 0xc0, 0x07 }), "Two-byte message without status byte");
+
+    // Data bytes before any status byte cannot be decoded
+    auto orphan = createFile({ 0x00, 0x3c, 0x64, 0x00, 0xff, 0x2f, 0x00 });
+    TestFramework::assertTrue(parser.parse(orphan.getData(), orphan.getSize(), timeline), "File still parsed");
+    TestFramework::assertEqualInt(0, timeline.getNumEvents(), "Track without a status byte ends");
+
+    // Meta and sysex events cancel the running status, so data bytes after them end the track too
+    auto afterMeta = createFile({ 0x00, 0x90, 0x3c, 0x64, 0x00, 0xff, 0x01, 0x00, 0x0a, 0x3e, 0x64, 0x00, 0xff, 0x2f, 0x00 });
+    TestFramework::assertTrue(parser.parse(afterMeta.getData(), afterMeta.getSize(), timeline), "File with meta event parsed");
+    TestFramework::assertEqualInt(1, timeline.getNumEvents(), "No running status after a meta event");
+
+    auto afterSysex = createFile({ 0x00, 0x90, 0x3c, 0x64, 0x00, 0xf0, 0x01, 0xf7, 0x0a, 0x3e, 0x64, 0x00, 0xff, 0x2f, 0x00 });
+    TestFramework::assertTrue(parser.parse(afterSysex.getData(), afterSysex.getSize(), timeline), "File with sysex parsed");
+    TestFramework::assertEqualInt(2, timeline.getNumEvents(), "No running status after a sysex event");
+    TestFramework::assertTrue(isEvent(timeline, 1, 0, { 0xf0, 0xf7 }), "Sysex kept");
+
+    return true;
+}
+
+bool MidiFileParserTests::testNoteOrdering()
+{
+    DBG("Testing note ordering...");
+
+    auto data = createFile({
+        0x00, 0x90, 0x3c, 0x64,
+        0x83, 0x60, 0x90, 0x3e, 0x64,   // 480: next note written before the release
+        0x00, 0x80, 0x3c, 0x00,
+        0x83, 0x60, 0x90, 0x40, 0x64,   // 960
+        0x83, 0x60, 0x90, 0x40, 0x64,   // 1440: struck again while held
+        0x83, 0x60, 0x80, 0x40, 0x00,   // 1920
+        0x00, 0xff, 0x2f, 0x00
+    });
+
+    MidiFileParser parser;
+    MidiTimeline timeline;
+    TestFramework::assertTrue(parser.parse(data.getData(), data.getSize(), timeline), "File parsed");
+    TestFramework::assertEqualInt(7, timeline.getNumEvents(), "One note-off inserted");
+
+    TestFramework::assertTrue(isEvent(timeline, 0, 0, { 0x90, 0x3c, 0x64 }), "First note");
+    TestFramework::assertTrue(isEvent(timeline, 1, 480, { 0x80, 0x3c, 0x00 }), "Release moved ahead");
+    TestFramework::assertTrue(isEvent(timeline, 2, 480, { 0x90, 0x3e, 0x64 }), "Note-on after the release");
+    TestFramework::assertTrue(isEvent(timeline, 3, 960, { 0x90, 0x40, 0x64 }), "Held note");
+    TestFramework::assertTrue(isEvent(timeline, 4, 1440, { 0x80, 0x40, 0x00 }), "Held note released first");
+    TestFramework::assertTrue(isEvent(timeline, 5, 1440, { 0x90, 0x40, 0x64 }), "Note struck again");
+    TestFramework::assertTrue(isEvent(timeline, 6, 1920, { 0x80, 0x40, 0x00 }), "Final release");
+
+    return true;
+}
+
+bool MidiFileParserTests::testTempoMap()
+{
+    DBG("Testing tempo map and resolution...");
+
+    auto data = createFile({
+        0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20,               // 120 BPM
+        0x00, 0xff, 0x58, 0x04, 0x03, 0x02, 0x18, 0x08,         // 3/4
+        0x00, 0xff, 0x03, 0x04, 'B', 'a', 's', 's',             // track name
+        0x00, 0x90, 0x3c, 0x64,
+        0x87, 0x40, 0xff, 0x51, 0x03, 0x0f, 0x42, 0x40,         // 960: 60 BPM
+        0x83, 0x60, 0x80, 0x3c, 0x00,                           // 1440
+        0x00, 0xff, 0x2f, 0x00
+    });
+
+    MidiFileParser parser;
+    MidiTimeline timeline;
+    TestFramework::assertTrue(parser.parse(data.getData(), data.getSize(), timeline), "File parsed");
+    TestFramework::assertEqualInt(2, timeline.getNumEvents(), "Meta events left out");
+    TestFramework::assertEqualInt(480, timeline.getTicksPerQuarterNote(), "Resolution from the header");
+
+    const auto& tempoMap = *timeline.getTempoMap();
+    TestFramework::assertEqualInt(2, tempoMap.getNumSegments(), "Two tempos");
+    TestFramework::assertApproxEqual(1.0, tempoMap.ticksToSeconds(960.0), 1.0e-9, "Two beats at 120 BPM");
+    TestFramework::assertApproxEqual(2.0, tempoMap.ticksToSeconds(1440.0), 1.0e-9, "Then one beat at 60 BPM");
+    TestFramework::assertEqualInt(3, tempoMap.getMeterAt(0.0).numerator, "Time signature numerator");
+    TestFramework::assertEqualInt(4, tempoMap.getMeterAt(0.0).denominator, "Time signature denominator");
+
+    auto coarse = createFile({ 0x00, 0x90, 0x3c, 0x64, 0x60, 0x80, 0x3c, 0x00 }, 96);
+    parser.parse(coarse.getData(), coarse.getSize(), timeline);
+    TestFramework::assertEqualInt(96, timeline.getTicksPerQuarterNote(), "Other resolutions kept");
+    TestFramework::assertApproxEqual(0.5, timeline.getTempoMap()->ticksToSeconds(96.0), 1.0e-9, "Default tempo without tempo events");
+
+    // SMPTE timing (negative time format) falls back to the default resolution
+    auto smpte = createFile({ 0x00, 0x90, 0x3c, 0x64 }, 0xe728);
+    TestFramework::assertTrue(parser.parse(smpte.getData(), smpte.getSize(), timeline), "SMPTE file parsed");
+    TestFramework::assertEqualInt(MidiFileParser::defaultTicksPerQuarterNote, timeline.getTicksPerQuarterNote(),
+                                  "SMPTE file uses the default resolution");
+
+    return true;
+}
+
+bool MidiFileParserTests::testMalformedData()
+{
+    DBG("Testing malformed data...");
+
+    MidiFileParser parser;
+    MidiTimeline timeline;
+
+    const char text[] = "This is not a MIDI file at all";
+    TestFramework::assertTrue(!parser.parse(text, sizeof(text), timeline), "Text rejected");
+    TestFramework::assertTrue(!parser.parse(nullptr, 0, timeline), "No data rejected");
+
+    auto valid = createFile({ 0x00, 0x90, 0x3c, 0x64, 0x60, 0x80, 0x3c, 0x00 });
+    TestFramework::assertTrue(!parser.parse(valid.getData(), 10, timeline), "Truncated header rejected");
+
+    // Rejected data leaves the timeline as it was
+    parser.parse(valid.getData(), valid.getSize(), timeline);
+    TestFramework::assertTrue(!parser.parse(text, sizeof(text), timeline), "Text rejected again");
+    TestFramework::assertEqualInt(2, timeline.getNumEvents(), "Timeline kept after rejected data");
+
+    auto badFormat = valid;
+    static_cast<juce::uint8*>(badFormat.getData())[9] = 3;
+    TestFramework::assertTrue(!parser.parse(badFormat.getData(), badFormat.getSize(), timeline), "Unknown format rejected");
+
+    // An event cut short ends the track, keeping what came before it
+    auto truncated = createFile({ 0x00, 0x90, 0x3c, 0x64, 0x60, 0x80, 0x3c, 0x00, 0x00, 0x90, 0x3e });
+    TestFramework::assertTrue(parser.parse(truncated.getData(), truncated.getSize(), timeline), "Truncated track parsed");
+    TestFramework::assertEqualInt(2, timeline.getNumEvents(), "Events before the cut kept");
+
+    // So does an event beyond the timeline's 32-bit range: 16 of the longest
+    // deltas stay inside it, the 17th does not
+    std::vector<juce::uint8> farTrack { 0x00, 0xb0, 0x01, 0x00 };
+    for (int i = 0; i < 17; ++i)
+        farTrack.insert(farTrack.end(), { 0xff, 0xff, 0xff, 0x7f, 0xb0, 0x01, 0x00 });
+
+    auto far = createFile(farTrack);
+    TestFramework::assertTrue(parser.parse(far.getData(), far.getSize(), timeline), "Long track parsed");
+    TestFramework::assertEqualInt(17, timeline.getNumEvents(), "Track ends before the event out of range");
+
+    // A track chunk that claims more data than the file holds is left out
+    TestFramework::assertTrue(parser.parse(valid.getData(), valid.getSize() - 2, timeline), "Short chunk parsed");
+    TestFramework::assertEqualInt(0, timeline.getNumEvents(), "Short chunk left out");
+
+    // RIFF-wrapped files (.rmi) hold a standard file
+    const juce::uint8 riffHeader[] = { 'R', 'I', 'F', 'F', 0, 0, 0, 0, 'R', 'M', 'I', 'D', 'd', 'a', 't', 'a', 0, 0, 0, 0 };
+    juce::MemoryBlock riff(riffHeader, sizeof(riffHeader));
+    riff.append(valid.getData(), valid.getSize());
+    TestFramework::assertTrue(parser.parse(riff.getData(), riff.getSize(), timeline), "RIFF file parsed");
+    TestFramework::assertEqualInt(2, timeline.getNumEvents(), "RIFF file events");
+
+    return true;
+}
+
+bool MidiFileParserTests::testParallelTracks()
+{
+    DBG("Testing tracks decoded on several threads...");
+
+    auto data = createMultiTrackFile(16, 1500);
+    TestFramework::assertTrue(data.getSize() >= MidiFileParser::minSizeForThreads, "File large enough to use threads");
+
+    MidiFileParser sequentialParser;
+    MidiTimeline expected;
+    sequentialParser.parse(data.getData(), data.getSize(), expected);
+
+    for (int numThreads : { 1, 3, 8 })
+    {
+        juce::ThreadPool threadPool(numThreads);
+        MidiFileParser parser;
+        parser.setThreadPool(&threadPool);
+
+        // Twice, so reused track buffers are covered as well
+        for (int run = 0; run < 2; ++run)
+        {
+            MidiTimeline parsed;
+            TestFramework::assertTrue(parser.parse(data.getData(), data.getSize(), parsed), "Parsed on threads");
+
+            auto threads = juce::String(numThreads) + " threads: ";
+            TestFramework::assertEqualInt(expected.getNumEvents(), parsed.getNumEvents(), threads + "Same number of events");
+
+            // The packed events themselves, long message indices included
+            bool sameEvents = expected.getNumEvents() == parsed.getNumEvents();
+
+            for (int i = 0; sameEvents && i < expected.getNumEvents(); ++i)
+                sameEvents = std::memcmp(&expected.getEvent(i), &parsed.getEvent(i), sizeof(MidiTimeline::Event)) == 0;
+
+            TestFramework::assertTrue(sameEvents, threads + "Byte-identical events");
+            TestFramework::assertTrue(haveSameEvents(expected, parsed), threads + "Same messages");
+            TestFramework::assertEqualInt(expected.getNoteIndex().getNumIntervals(), parsed.getNoteIndex().getNumIntervals(),
+                                          threads + "Same note index");
+            TestFramework::assertTrue(expected.getMemoryUsage() == parsed.getMemoryUsage(), threads + "Same memory");
+
+            const auto& expectedTempo = *expected.getTempoMap();
+            const auto& parsedTempo = *parsed.getTempoMap();
+            TestFramework::assertEqualInt(expectedTempo.getNumSegments(), parsedTempo.getNumSegments(), threads + "Same tempo segments");
+
+            for (double beat = 0.0; beat < 400.0; beat += 7.25)
+            {
+                if (expectedTempo.beatsToSeconds(beat) != parsedTempo.beatsToSeconds(beat)
+                    || expectedTempo.getNextBarLine(beat) != parsedTempo.getNextBarLine(beat))
+                {
+                    TestFramework::assertTrue(false, threads + "Same tempo map at beat " + juce::String(beat));
+                    break;
+                }
+            }
+        }
+    }
+
+    // Small files and single tracks stay on the caller's thread and are unaffected
+    juce::ThreadPool threadPool(2);
+    MidiFileParser parser;
+    parser.setThreadPool(&threadPool);
+
+    auto smallData = createMultiTrackFile(4, 10);
+    MidiTimeline smallExpected, smallParsed;
+    sequentialParser.parse(smallData.getData(), smallData.getSize(), smallExpected);
+    parser.parse(smallData.getData(), smallData.getSize(), smallParsed);
+    TestFramework::assertTrue(haveSameEvents(smallExpected, smallParsed), "Small file parsed the same");
+
+    // With every pool thread busy the caller decodes alone, and does not
+    // wait for the helper jobs still queued behind the busy ones
+    juce::WaitableEvent releasePool(true);
+    juce::ThreadPool busyPool(2);
+    parser.setThreadPool(&busyPool);
+
+    for (int i = 0; i < busyPool.getNumThreads(); ++i)
+        busyPool.addJob([&releasePool] { releasePool.wait(10000); });
+
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    MidiTimeline busyParsed;
+    parser.parse(data.getData(), data.getSize(), busyParsed);
+    auto elapsed = juce::Time::getMillisecondCounterHiRes() - startTime;
+
+    releasePool.signal();
+
+    TestFramework::assertTrue(elapsed < 5000.0, "Busy pool does not hold up the caller");
+    TestFramework::assertTrue(haveSameEvents(expected, busyParsed), "Busy pool parsed the same");
+
+    return true;
+}
+
+//==============================================================================
+// Helper Methods
+
+juce::MemoryBlock MidiFileParserTests::createFile(const std::vector<juce::uint8>& trackData, int timeFormat)
+{
+    auto trackSize = static_cast<juce::uint32>(trackData.size());
+
+    const juce::uint8 header[] = {
+        'M', 'T', 'h', 'd', 0, 0, 0, 6,
+        0, 0, 0, 1,
+        static_cast<juce::uint8>(timeFormat >> 8), static_cast<juce::uint8>(timeFormat),
+        'M', 'T', 'r', 'k',
+        static_cast<juce::uint8>(trackSize >> 24), static_cast<juce::uint8>(trackSize >> 16),
+        static_cast<juce::uint8>(trackSize >> 8), static_cast<juce::uint8>(trackSize)
+    };
+
+    juce::MemoryBlock data(header, sizeof(header));
+    data.append(trackData.data(), trackData.size());
+    return data;
+}
+
+juce::MemoryBlock MidiFileParserTests::createMultiTrackFile(int numTracks, int notesPerTrack)
+{
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(480);
+
+    for (int trackIndex = 0; trackIndex < numTracks; ++trackIndex)
+    {
+        juce::MidiMessageSequence track;
+
+        // Tempo and meter changes in more than one track
+        if (trackIndex == 0 || trackIndex == 3)
+        {
+            track.addEvent(juce::MidiMessage::tempoMetaEvent(500000 - trackIndex * 20000), trackIndex * 960.0);
+            track.addEvent(juce::MidiMessage::timeSignatureMetaEvent(trackIndex == 0 ? 4 : 7, 4), trackIndex * 1920.0);
+        }
+
+        // Long messages in several tracks, so their indices need renumbering when merged
+        if (trackIndex % 2 == 1)
+        {
+            const juce::uint8 sysexData[] = { 0x43, 0x10, 0x4c, static_cast<juce::uint8>(trackIndex), 0x00, 0x7e, 0x00 };
+
+            for (int i = 0; i < 3; ++i)
+                track.addEvent(juce::MidiMessage::createSysExMessage(sysexData, static_cast<int>(sizeof(sysexData))), i * 4800.0);
+        }
+
+        // Every voice hits on the same grid, so most positions are shared
+        // between tracks and their order depends on the track order
+        for (int i = 0; i < notesPerTrack; ++i)
+        {
+            auto tick = i * 120.0 * (1 + trackIndex % 3);
+            track.addEvent(juce::MidiMessage::noteOn(10, 35 + trackIndex, (juce::uint8)(60 + i % 60)), tick);
+            track.addEvent(juce::MidiMessage::noteOff(10, 35 + trackIndex), tick + 60.0);
+        }
+
+        track.updateMatchedPairs();
+        midiFile.addTrack(track);
+    }
+
+    juce::MemoryBlock data;
+
+    {
+        juce::MemoryOutputStream stream(data, false);
+        midiFile.writeTo(stream);
+    }
+
+    return data;
+}
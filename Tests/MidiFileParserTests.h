@@ -0,0 +1,63 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/MidiFileParser.h"
+#include "../Source/MidiManager.h"
+
+//==============================================================================
+/**
+    Unit Tests for MidiFileParser class
+
+    Tests the Standard MIDI File parser including:
+    - Timelines identical to the juce::MidiFile path
+    - Running status and system exclusive events
+    - Note ordering within a tick and repeated note-ons
+    - Tempo maps, resolutions and malformed data
+    - Tracks decoded on several threads
+*/
+class MidiFileParserTests
+{
+public:
+    //==============================================================================
+    MidiFileParserTests();
+    ~MidiFileParserTests();
+
+    //==============================================================================
+    /** Run all MidiFileParser tests */
+    static bool runAllTests();
+
+    //==============================================================================
+    // Individual Test Methods
+
+    /** Test that a multi-track file compiles the same as through juce::MidiFile */
+    static bool testMatchesMidiFile();
+
+    /** Test messages that leave out their status byte */
+    static bool testRunningStatus();
+
+    /** Test note-offs ahead of same-tick note-ons and repeated note-ons */
+    static bool testNoteOrdering();
+
+    /** Test the tempo map and time resolution taken from the file */
+    static bool testTempoMap();
+
+    /** Test data that is not, or not entirely, a MIDI file */
+    static bool testMalformedData();
+
+    /** Test that decoding tracks on a thread pool gives the same timeline */
+    static bool testParallelTracks();
+
+private:
+    //==============================================================================
+    /** Helper to wrap raw track data in a single-track file */
+    static juce::MemoryBlock createFile(const std::vector<juce::uint8>& trackData, int timeFormat = 480);
+
+    /** Helper to build a file of one track per drum voice, with tempo
+        changes and system exclusive messages spread over the tracks
+    */
+    static juce::MemoryBlock createMultiTrackFile(int numTracks, int notesPerTrack);
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiFileParserTests)
+};
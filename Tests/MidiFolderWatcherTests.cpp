@@ -0,0 +1,162 @@
+#include "MidiFolderWatcherTests.h"
+
+//==============================================================================
+MidiFolderWatcherTests::MidiFolderWatcherTests()
+{
+}
+
+MidiFolderWatcherTests::~MidiFolderWatcherTests()
+{
+}
+
+//==============================================================================
+bool MidiFolderWatcherTests::runAllTests()
+{
+    DBG("=== Running MidiFolderWatcher Tests ===");
+    
+    bool allPassed = true;
+    
+    allPassed &= testBackgroundLoading();
+    allPassed &= testNotificationLatency();
+    allPassed &= testChangeDetection();
+    
+    DBG("=== MidiFolderWatcher Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool MidiFolderWatcherTests::testBackgroundLoading()
+{
+    DBG("Testing background loading...");
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    TestFramework::createTestMidiFileInTicks(tempDir.getChildFile("song_bass.mid").getFullPathName(), 4);
+    TestFramework::createTestMidiFileInTicks(tempDir.getChildFile("song_keys.midi").getFullPathName(), 4);
+    
+    TrackExchange exchange;
+    MidiFolderWatcher watcher(exchange);
+    watcher.setFolder(tempDir.getFullPathName());
+    
+    TestFramework::assertTrue(waitForLoads(watcher, 1, 3000.0) >= 0.0, "Existing file loaded in the background");
+    
+    // Audio thread side of the handoff
+    TestFramework::assertTrue(exchange.update(), "Loaded tracks are handed over");
+    TestFramework::assertEqualInt(8, exchange.getCurrent().getTrack(TrackExchange::bassTrack).getNumEvents(), "Bass track fully compiled");
+    TestFramework::assertEqualInt(8, exchange.getCurrent().getTrack(TrackExchange::keysTrack).getNumEvents(), "Files ending in .midi are loaded too");
+    TestFramework::assertTrue(exchange.getCurrent().getTrack(TrackExchange::drumTrack).isEmpty(), "No drum track present");
+    
+    watcher.stop();
+    return true;
+}
+
+bool MidiFolderWatcherTests::testNotificationLatency()
+{
+    DBG("Testing write-to-load latency...");
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    
+    TrackExchange exchange;
+    MidiFolderWatcher watcher(exchange);
+    watcher.setFolder(tempDir.getFullPathName());
+    
+    // Let the watcher attach to the (empty) folder first
+    juce::Thread::sleep(200);
+    
+    auto loadsBefore = watcher.getNumLoads();
+    TestFramework::createTestMidiFileInTicks(tempDir.getChildFile("latency_drum.mid").getFullPathName(), 16);
+    
+    auto latencyMs = waitForLoads(watcher, loadsBefore + 1, 2000.0);
+    TestFramework::assertTrue(latencyMs >= 0.0, "New file detected");
+    
+    juce::Logger::writeToLog("Folder watcher write-to-load latency: " + juce::String(latencyMs, 2) + " ms ("
+                             + (watcher.usesFileNotifications() ? "notifications" : "polling") + ")");
+    
+    // The spec target of 10 ms for notifications is tracked by the logged figure;
+    // a loaded machine can miss it, so only a gross stall fails the test. The
+    // polling fallback is bounded by its interval instead.
+    if (watcher.usesFileNotifications())
+        TestFramework::assertTrue(latencyMs < 250.0, "Write-to-load latency well below a poll interval");
+    else
+        TestFramework::assertTrue(latencyMs < MidiFolderWatcher::pollIntervalMs + 500.0, "Write-to-load latency within one poll interval");
+    
+    watcher.stop();
+    return true;
+}
+
+bool MidiFolderWatcherTests::testChangeDetection()
+{
+    DBG("Testing change detection...");
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("detect_bass.mid");
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 4);
+    
+    TrackExchange exchange;
+    MidiFolderWatcher watcher(exchange);
+    watcher.setFolder(tempDir.getFullPathName());
+    
+    TestFramework::assertTrue(waitForLoads(watcher, 1, 3000.0) >= 0.0, "Initial file loaded");
+    exchange.update();
+    
+    auto statistics = watcher.getReloadStatistics();
+    TestFramework::assertEqualInt(1, statistics.performed, "Initial load counted");
+    
+    // An unrelated MIDI file triggers a rescan, but the bass file is unchanged
+    TestFramework::createTestMidiFileInTicks(tempDir.getChildFile("notes.mid").getFullPathName(), 2);
+    TestFramework::assertTrue(waitForSkips(watcher, statistics.skipped + 1, 3000.0), "Unchanged file skipped on rescan");
+    
+    // Rewriting the same content is detected by the content hash
+    statistics = watcher.getReloadStatistics();
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 4);
+    TestFramework::assertTrue(waitForSkips(watcher, statistics.skipped + 1, 3000.0), "Identical rewrite skipped");
+    
+    TestFramework::assertEqualInt(1, watcher.getReloadStatistics().performed, "Unchanged file never parsed again");
+    TestFramework::assertEqualInt(1, watcher.getNumLoads(), "Nothing published for unchanged files");
+    
+    // Genuinely new content is parsed and published
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 8);
+    TestFramework::assertTrue(waitForLoads(watcher, 2, 3000.0) >= 0.0, "Modified file reloaded");
+    TestFramework::assertEqualInt(2, watcher.getReloadStatistics().performed, "Modified file counted");
+    
+    TestFramework::assertTrue(exchange.update(), "Modified track handed over");
+    TestFramework::assertEqualInt(16, exchange.getCurrent().getTrack(TrackExchange::bassTrack).getNumEvents(), "Modified track has the new content");
+    
+    watcher.stop();
+    return true;
+}
+
+//==============================================================================
+// Helper Methods
+
+double MidiFolderWatcherTests::waitForLoads(const MidiFolderWatcher& watcher, int expectedLoads, double timeoutMs)
+{
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    
+    for (;;)
+    {
+        auto elapsed = juce::Time::getMillisecondCounterHiRes() - startTime;
+        
+        if (watcher.getNumLoads() >= expectedLoads)
+            return elapsed;
+        
+        if (elapsed > timeoutMs)
+            return -1.0;
+        
+        juce::Thread::yield();
+    }
+}
+
+bool MidiFolderWatcherTests::waitForSkips(const MidiFolderWatcher& watcher, int expectedSkips, double timeoutMs)
+{
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    
+    while (watcher.getReloadStatistics().skipped < expectedSkips)
+    {
+        if (juce::Time::getMillisecondCounterHiRes() - startTime > timeoutMs)
+            return false;
+        
+        juce::Thread::sleep(1);
+    }
+    
+    return true;
+}
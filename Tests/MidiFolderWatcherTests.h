@@ -0,0 +1,54 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/MidiFolderWatcher.h"
+
+//==============================================================================
+/**
+    Unit Tests for MidiFolderWatcher class
+    
+    Tests the background folder monitoring service including:
+    - Loading files dropped into the monitored folder
+    - Publishing loaded tracks to the audio thread
+    - Write-to-load notification latency
+    - Skipping unchanged files on rescans
+*/
+class MidiFolderWatcherTests
+{
+public:
+    //==============================================================================
+    MidiFolderWatcherTests();
+    ~MidiFolderWatcherTests();
+    
+    //==============================================================================
+    /** Run all MidiFolderWatcher tests */
+    static bool runAllTests();
+    
+    //==============================================================================
+    // Individual Test Methods
+    
+    /** Test that files in the folder are loaded and handed over */
+    static bool testBackgroundLoading();
+    
+    /** Test the latency between a file being written and loaded */
+    static bool testNotificationLatency();
+    
+    /** Test that only new or modified files are parsed again */
+    static bool testChangeDetection();
+
+private:
+    //==============================================================================
+    /** Helper method to wait until the watcher has loaded a number of track sets
+        @returns milliseconds waited, or a negative value on timeout
+    */
+    static double waitForLoads(const MidiFolderWatcher& watcher, int expectedLoads, double timeoutMs);
+    
+    /** Helper method to wait until the watcher has skipped a number of unchanged files
+        @returns true if the count was reached before the timeout
+    */
+    static bool waitForSkips(const MidiFolderWatcher& watcher, int expectedSkips, double timeoutMs);
+    
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiFolderWatcherTests)
+};
@@ -24,6 +24,8 @@ bool MidiManagerTests::runAllTests()
     allPassed &= testTempoDetection();
     allPassed &= testTimeSignatureDetection();
     allPassed &= testDurationCalculation();
+    allPassed &= testTimelineLoading();
+    allPassed &= testFileTempoMap();
     allPassed &= testBeatSampleConversion();
     allPassed &= testErrorHandling();
     
@@ -247,6 +249,101 @@ bool MidiManagerTests::testDurationCalculation()
     return true;
 }
 
+bool MidiManagerTests::testTimelineLoading()
+{
+    DBG("Testing timeline loading in musical time...");
+    
+    auto manager = createTestMidiManager();
+    manager->initialize();
+    manager->prepareToPlay(44100.0, 512);
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto midiFile = tempDir.getChildFile("ticks_test.mid");
+    
+    TestFramework::assertTrue(
+        TestFramework::createTestMidiFileInTicks(midiFile.getFullPathName(), 4, 480, 140),
+        "Create tick-accurate MIDI file"
+    );
+    
+    MidiTimeline timeline;
+    bool loadSuccess = manager->loadMidiFile(midiFile.getFullPathName(), timeline);
+    
+    TestFramework::assertTrue(loadSuccess, "Load MIDI file into timeline");
+    TestFramework::assertEqualInt(480, timeline.getTicksPerQuarterNote(), "Timeline keeps file resolution");
+    TestFramework::assertEqualInt(8, timeline.getNumEvents(), "Meta events are not compiled");
+    TestFramework::assertTrue(timeline.getEvent(2).position == 480, "Second note starts at tick 480");
+    TestFramework::assertApproxEqual(3.5, timeline.getLengthInBeats(), 0.001, "Timeline length in beats");
+    TestFramework::assertTrue(timeline.getTempoMap() != nullptr, "Timeline keeps the file's tempo map");
+    
+    if (timeline.getTempoMap() != nullptr)
+        TestFramework::assertApproxEqual(140.0, timeline.getTempoMap()->getTempoAt(1.0), 0.01, "Tempo map has the file tempo");
+    
+    // The result must not depend on the sample rate the manager was prepared with
+    manager->prepareToPlay(96000.0, 64);
+    MidiTimeline otherTimeline;
+    manager->loadMidiFile(midiFile.getFullPathName(), otherTimeline);
+    TestFramework::assertTrue(otherTimeline.getEvent(2).position == 480, "Tick positions ignore sample rate");
+    
+    // A failed load leaves the timeline untouched
+    bool failResult = manager->loadMidiFile("nonexistent.mid", timeline);
+    TestFramework::assertTrue(!failResult, "Fail to load non-existent file into timeline");
+    TestFramework::assertEqualInt(8, timeline.getNumEvents(), "Timeline kept after failed load");
+    
+    return true;
+}
+
+bool MidiManagerTests::testFileTempoMap()
+{
+    DBG("Testing the file tempo map...");
+    
+    auto manager = createTestMidiManager();
+    manager->initialize();
+    manager->prepareToPlay(44100.0, 512);
+    
+    // Type 1 layout: 60 BPM, then 120 BPM from beat 2, in the tempo track only
+    juce::MidiMessageSequence tempoTrack;
+    tempoTrack.addEvent(juce::MidiMessage::tempoMetaEvent(1000000), 0.0);
+    tempoTrack.addEvent(juce::MidiMessage::tempoMetaEvent(500000), 2.0 * 480);
+    
+    juce::MidiMessageSequence noteTrack;
+    noteTrack.addEvent(juce::MidiMessage::noteOn(1, 36, (juce::uint8)100), 1.0 * 480);
+    noteTrack.addEvent(juce::MidiMessage::noteOn(1, 38, (juce::uint8)100), 3.0 * 480);
+    
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(480);
+    midiFile.addTrack(tempoTrack);
+    midiFile.addTrack(noteTrack);
+    
+    juce::MemoryBlock data;
+    
+    {
+        juce::MemoryOutputStream stream(data, false);
+        midiFile.writeTo(stream);
+    }
+    
+    juce::MidiBuffer buffer;
+    TestFramework::assertTrue(manager->loadMidiFromMemory(data.getData(), data.getSize(), buffer), "Load type 1 file");
+    
+    int firstNote = -1;
+    int secondNote = -1;
+    
+    for (const auto metadata : buffer)
+    {
+        auto message = metadata.getMessage();
+        
+        if (message.isNoteOn() && message.getNoteNumber() == 36)
+            firstNote = metadata.samplePosition;
+        else if (message.isNoteOn())
+            secondNote = metadata.samplePosition;
+    }
+    
+    // Beat 1 is one second in at 60 BPM; beat 3 is two seconds plus half a second at 120 BPM
+    TestFramework::assertEqualInt(44100, firstNote, "Note track timed by the tempo track");
+    TestFramework::assertEqualInt(110250, secondNote, "Tempo change applies to the note track");
+    
+    return true;
+}
+
 bool MidiManagerTests::testBeatSampleConversion()
 {
     DBG("Testing beat/sample conversion...");
@@ -274,6 +371,12 @@ bool MidiManagerTests::testBeatSampleConversion()
     TestFramework::assertEqualInt(0, manager->beatsToSamples(0.0, tempo), "0 beats to samples");
     TestFramework::assertEqualDouble(0.0, manager->samplesToBeats(0, tempo), "0 samples to beats");
     
+    // With a tempo map: two beats at 120 BPM, then 60 BPM
+    TempoMap tempoMap({ { 2.0, 60.0 } }, 480);
+    
+    TestFramework::assertEqualInt(88200, manager->beatsToSamples(3.0, tempoMap), "Beat after a tempo change to samples");
+    TestFramework::assertApproxEqual(3.0, manager->samplesToBeats(88200, tempoMap), 0.0001, "Samples after a tempo change to beats");
+    
     return true;
 }
 
@@ -47,6 +47,12 @@ public:
     /** Test MIDI duration calculation */
     static bool testDurationCalculation();
     
+    /** Test loading into a tick-based timeline */
+    static bool testTimelineLoading();
+    
+    /** Test that the tempo track of a type 1 file times every track */
+    static bool testFileTempoMap();
+    
     /** Test beat/sample conversion utilities */
     static bool testBeatSampleConversion();
     
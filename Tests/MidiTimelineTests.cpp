@@ -0,0 +1,593 @@
+#include "MidiTimelineTests.h"
+
+//==============================================================================
+MidiTimelineTests::MidiTimelineTests()
+{
+}
+
+MidiTimelineTests::~MidiTimelineTests()
+{
+}
+
+//==============================================================================
+bool MidiTimelineTests::runAllTests()
+{
+    DBG("=== Running MidiTimeline Tests ===");
+
+    bool allPassed = true;
+
+    allPassed &= testCompilation();
+    allPassed &= testWindowRendering();
+    allPassed &= testCursorSeeking();
+    allPassed &= testLongMessages();
+    allPassed &= testPackedEvents();
+    allPassed &= testActiveNoteTracking();
+    allPassed &= testNoteChasing();
+    allPassed &= testNoteHandoff();
+    allPassed &= testMergedRendering();
+
+    DBG("=== MidiTimeline Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool MidiTimelineTests::testCompilation()
+{
+    DBG("Testing timeline compilation...");
+
+    // 4 beats at 120 BPM: note on at every beat, note off 2205 samples later
+    auto source = TestFramework::createTestMidiBuffer(4.0, 120);
+
+    MidiTimeline timeline;
+    compileFromBuffer(timeline, source);
+
+    TestFramework::assertEqualInt(8, timeline.getNumEvents(), "Timeline has all source events");
+    TestFramework::assertTrue(timeline.getEndPosition() == 66150 + 2205, "Timeline end position");
+
+    bool sorted = true;
+    for (int i = 1; i < timeline.getNumEvents(); ++i)
+        sorted &= timeline.getEvent(i - 1).position <= timeline.getEvent(i).position;
+
+    TestFramework::assertTrue(sorted, "Timeline events are sorted");
+
+    timeline.clear();
+    TestFramework::assertTrue(timeline.isEmpty(), "Cleared timeline is empty");
+
+    return true;
+}
+
+bool MidiTimelineTests::testWindowRendering()
+{
+    DBG("Testing timeline window rendering...");
+
+    MidiTimeline timeline;
+    compileFromBuffer(timeline, TestFramework::createTestMidiBuffer(4.0, 120));
+
+    MidiTimeline::Cursor cursor;
+    juce::MidiBuffer output;
+    int totalEvents = 0;
+
+    // Walk the whole track in 512-sample blocks
+    for (juce::int64 start = 0; start < 90000; start += 512)
+    {
+        output.clear();
+        totalEvents += renderTicks(timeline, cursor, start, start + 512, output);
+
+        for (const auto metadata : output)
+        {
+            TestFramework::assertTrue(metadata.samplePosition >= 0 && metadata.samplePosition < 512,
+                                      "Rendered event lies inside the block");
+        }
+    }
+
+    TestFramework::assertEqualInt(8, totalEvents, "Every event rendered exactly once");
+
+    // Check the offset of a specific event: note on at 22050
+    output.clear();
+    cursor.reset();
+    renderTicks(timeline, cursor, 22000, 22100, output);
+
+    TestFramework::assertEqualInt(1, countEvents(output), "One event in window");
+    TestFramework::assertEqualInt(50, output.getFirstEventTime(), "Event offset within window");
+
+    return true;
+}
+
+bool MidiTimelineTests::testCursorSeeking()
+{
+    DBG("Testing timeline cursor seeking...");
+
+    MidiTimeline timeline;
+    compileFromBuffer(timeline, TestFramework::createTestMidiBuffer(4.0, 120));
+
+    MidiTimeline::Cursor cursor;
+    juce::MidiBuffer output;
+
+    // Play the first block, then jump forward past two notes
+    renderTicks(timeline, cursor, 0, 512, output);
+    TestFramework::assertEqualInt(1, countEvents(output), "First block has the first note on");
+
+    output.clear();
+    renderTicks(timeline, cursor, 44100, 44612, output);
+    TestFramework::assertEqualInt(1, countEvents(output), "Forward seek finds the third note on");
+
+    // Jump backwards to the start
+    output.clear();
+    renderTicks(timeline, cursor, 0, 512, output);
+    TestFramework::assertEqualInt(1, countEvents(output), "Backward seek replays the first note on");
+
+    // Past the end nothing is rendered
+    output.clear();
+    renderTicks(timeline, cursor, 100000, 100512, output);
+    TestFramework::assertEqualInt(0, countEvents(output), "No events past the end");
+
+    TestFramework::assertEqualInt(4, static_cast<int>(timeline.findFirstEventAtOrAfter(44100)),
+                                  "Binary search finds the first event at position");
+
+    return true;
+}
+
+bool MidiTimelineTests::testLongMessages()
+{
+    DBG("Testing timeline long message storage...");
+
+    const juce::uint8 sysexData[] = { 0x43, 0x10, 0x4c, 0x00, 0x00, 0x7e, 0x00 };
+
+    juce::MidiBuffer source;
+    source.addEvent(juce::MidiMessage::noteOn(1, 40, (juce::uint8)100), 0);
+    source.addEvent(juce::MidiMessage::createSysExMessage(sysexData, (int) sizeof(sysexData)), 10);
+    source.addEvent(juce::MidiMessage::noteOff(1, 40), 20);
+
+    MidiTimeline timeline;
+    compileFromBuffer(timeline, source);
+
+    TestFramework::assertEqualInt(3, timeline.getNumEvents(), "Sysex event compiled");
+
+    MidiTimeline::Cursor cursor;
+    juce::MidiBuffer output;
+    renderTicks(timeline, cursor, 0, 64, output);
+
+    bool foundSysex = false;
+    for (const auto metadata : output)
+    {
+        auto message = metadata.getMessage();
+        if (message.isSysEx())
+            foundSysex = message.getSysExDataSize() == (int) sizeof(sysexData);
+    }
+
+    TestFramework::assertTrue(foundSysex, "Sysex data survives compilation");
+
+    return true;
+}
+
+bool MidiTimelineTests::testPackedEvents()
+{
+    DBG("Testing packed event storage...");
+
+    TestFramework::assertEqualInt(8, static_cast<int>(sizeof(MidiTimeline::Event)), "Events take 8 bytes");
+
+    const juce::uint8 programChange[] = { 0xc2, 0x05 };
+    const juce::uint8 noteOn[] = { 0x91, 0x3c, 0x64 };
+    const juce::uint8 tempo[] = { 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20 };
+    const juce::uint8 sysex[] = { 0xf0, 0x7e, 0x7f, 0x09, 0x01, 0xf7 };
+    const juce::int64 lastPosition = MidiTimeline::maxPosition;
+
+    // Two long messages, so the second one needs a side table index above 0
+    MidiTimeline timeline;
+    timeline.addEvent(tempo, (int) sizeof(tempo), 0);
+    timeline.addEvent(programChange, (int) sizeof(programChange), 0);
+    timeline.addEvent(sysex, (int) sizeof(sysex), 480);
+    timeline.addEvent(noteOn, (int) sizeof(noteOn), lastPosition);
+    timeline.finishCompiling();
+
+    auto matches = [&timeline](int index, const juce::uint8* expected, int numBytes)
+    {
+        const auto& event = timeline.getEvent(index);
+        return timeline.getEventSize(event) == numBytes
+            && std::memcmp(timeline.getEventData(event), expected, static_cast<size_t>(numBytes)) == 0;
+    };
+
+    TestFramework::assertTrue(matches(0, tempo, (int) sizeof(tempo)), "Meta event read back from the side table");
+    TestFramework::assertTrue(matches(1, programChange, (int) sizeof(programChange)), "Two-byte message stored inline");
+    TestFramework::assertTrue(matches(2, sysex, (int) sizeof(sysex)), "Second long message read back");
+    TestFramework::assertTrue(matches(3, noteOn, (int) sizeof(noteOn)), "Note stored inline");
+    TestFramework::assertTrue(timeline.getEndPosition() == lastPosition, "Largest position kept");
+    TestFramework::assertEqualInt(1, timeline.getNoteIndex().getNumIntervals(), "Inline note indexed");
+
+    // Positions outside the 32-bit range are refused rather than clamped
+    MidiTimeline outOfRange;
+    TestFramework::assertTrue(!outOfRange.addEvent(noteOn, (int) sizeof(noteOn), lastPosition + 1), "Position beyond the range refused");
+    TestFramework::assertTrue(!outOfRange.addEvent(noteOn, (int) sizeof(noteOn), -1), "Negative position refused");
+    TestFramework::assertEqualInt(0, outOfRange.getNumEvents(), "Refused events not added");
+
+    // Events without notes leave only the packed array, trimmed by finishCompiling()
+    juce::MidiBuffer controllers;
+    for (int i = 0; i < 10000; ++i)
+        controllers.addEvent(juce::MidiMessage::controllerEvent(1, 1, i & 0x7f), i * 10);
+
+    MidiTimeline compiled;
+    compileFromBuffer(compiled, controllers);
+
+    TestFramework::assertTrue(compiled.getMemoryPerEvent() < 8.1, "Memory per event close to the packed size");
+    TestFramework::assertTrue(MidiTimeline().getMemoryPerEvent() == 0.0, "Empty timeline reports no memory per event");
+
+    return true;
+}
+
+bool MidiTimelineTests::testActiveNoteTracking()
+{
+    DBG("Testing active note tracking...");
+    
+    MidiTimeline timeline;
+    compileFromBuffer(timeline, TestFramework::createTestMidiBuffer(4.0, 120));
+    
+    MidiTimeline::Cursor cursor;
+    ActiveNotes activeNotes;
+    juce::MidiBuffer output;
+    
+    // First block holds the note on of beat 0 (note 60), its note off comes later
+    renderTicks(timeline, cursor, 0, 512, output, &activeNotes);
+    TestFramework::assertEqualInt(1, activeNotes.getNumActiveNotes(), "Note on tracked");
+    TestFramework::assertTrue(activeNotes.isNoteOn(1, 60), "Sounding note identified");
+    
+    // Rendering past the note off clears it
+    output.clear();
+    renderTicks(timeline, cursor, 512, 4000, output, &activeNotes);
+    TestFramework::assertTrue(activeNotes.isEmpty(), "Note off tracked");
+    
+    // Note on with velocity 0 counts as a note off
+    const juce::uint8 noteOn[] = { 0x92, 40, 100 };
+    const juce::uint8 zeroVelocity[] = { 0x92, 40, 0 };
+    activeNotes.handleMidiEvent(noteOn, 3);
+    TestFramework::assertTrue(activeNotes.isNoteOn(3, 40), "Note on channel 3 tracked");
+    activeNotes.handleMidiEvent(zeroVelocity, 3);
+    TestFramework::assertTrue(activeNotes.isEmpty(), "Velocity 0 releases the note");
+    
+    // Release emits exactly one note off per sounding note, on the right channel
+    activeNotes.noteOn(1, 0);
+    activeNotes.noteOn(1, 127);
+    activeNotes.noteOn(16, 64);
+    
+    output.clear();
+    TestFramework::assertEqualInt(3, activeNotes.releaseAll(output, 100), "One note off per sounding note");
+    TestFramework::assertTrue(activeNotes.isEmpty(), "Release clears the set");
+    
+    ActiveNotes released;
+    bool allNoteOffsAtPosition = true;
+    
+    for (const auto metadata : output)
+    {
+        auto message = metadata.getMessage();
+        allNoteOffsAtPosition &= message.isNoteOff() && metadata.samplePosition == 100;
+        released.noteOn(message.getChannel(), message.getNoteNumber());
+    }
+    
+    TestFramework::assertTrue(allNoteOffsAtPosition, "Note offs at the requested position");
+    TestFramework::assertTrue(released.isNoteOn(1, 0) && released.isNoteOn(1, 127) && released.isNoteOn(16, 64),
+                              "Note offs match the sounding notes");
+    
+    return true;
+}
+
+bool MidiTimelineTests::testNoteChasing()
+{
+    DBG("Testing note chasing...");
+    
+    // Bass line in ticks: a long note 40 over [0, 1920), note 43 over
+    // [480, 960) and note 45 that is never released
+    MidiTimeline timeline;
+    timeline.addEvent(juce::MidiMessage::noteOn(1, 40, (juce::uint8)100).getRawData(), 3, 0);
+    timeline.addEvent(juce::MidiMessage::noteOn(1, 43, (juce::uint8)90).getRawData(), 3, 480);
+    timeline.addEvent(juce::MidiMessage::noteOff(1, 43).getRawData(), 3, 960);
+    timeline.addEvent(juce::MidiMessage::noteOff(1, 40).getRawData(), 3, 1920);
+    timeline.addEvent(juce::MidiMessage::noteOn(1, 45, (juce::uint8)80).getRawData(), 3, 2400);
+    timeline.addEvent(juce::MidiMessage::controllerEvent(1, 7, 100).getRawData(), 3, 2880);
+    timeline.finishCompiling();
+    
+    TestFramework::assertEqualInt(3, timeline.getNoteIndex().getNumIntervals(), "One span per note");
+    
+    ActiveNotes activeNotes;
+    juce::MidiBuffer output;
+    
+    // Inside both notes: both are re-triggered with their original velocity
+    TestFramework::assertEqualInt(2, timeline.chaseNotes(600, output, 10, &activeNotes), "Both held notes chased");
+    TestFramework::assertTrue(activeNotes.isNoteOn(1, 40) && activeNotes.isNoteOn(1, 43), "Chased notes tracked");
+    
+    bool chasedAsRecorded = true;
+    
+    for (const auto metadata : output)
+    {
+        auto message = metadata.getMessage();
+        chasedAsRecorded &= message.isNoteOn() && metadata.samplePosition == 10
+                            && message.getVelocity() == (message.getNoteNumber() == 40 ? 100 : 90);
+    }
+    
+    TestFramework::assertTrue(chasedAsRecorded, "Chased note-ons keep their velocity");
+    
+    // Notes starting or ending exactly at the position are left to the render
+    output.clear();
+    TestFramework::assertEqualInt(1, timeline.chaseNotes(480, output), "Note starting at the position not chased");
+    TestFramework::assertEqualInt(1, timeline.chaseNotes(960, output), "Note ending at the position not chased");
+    TestFramework::assertEqualInt(0, timeline.chaseNotes(0, output), "Nothing held at the start");
+    TestFramework::assertEqualInt(0, timeline.chaseNotes(2000, output), "Nothing held between notes");
+    
+    // An unreleased note is held until the end of the track
+    TestFramework::assertEqualInt(1, timeline.chaseNotes(2880, output), "Unreleased note held to the end");
+    
+    // Beat positions use the same tick rounding as renderMergedBeatWindows()
+    output.clear();
+    TestFramework::assertEqualInt(2, timeline.chaseNotesAtBeat(0.75, output), "Chase at a beat position");
+    TestFramework::assertEqualInt(1, timeline.chaseNotesAtBeat(0.5, output), "Note at the beat is rendered, not chased");
+    
+    // The index must agree with a scan of every note, on a dense random track
+    NoteIntervalIndex index;
+    juce::Array<juce::int64> starts, ends;
+    juce::Random random(42);
+    juce::int64 start = 0;
+    
+    for (int i = 0; i < 5000; ++i)
+    {
+        start += random.nextInt(60);
+        starts.add(start);
+        ends.add(start + 1 + random.nextInt(i % 50 == 0 ? 20000 : 480));
+        index.add(starts.getLast(), ends.getLast(), i);
+    }
+    
+    index.build();
+    
+    bool matchesScan = true;
+    
+    for (juce::int64 position = 0; position < start + 1000; position += 97)
+    {
+        int expected = 0;
+        
+        for (int i = 0; i < starts.size(); ++i)
+            if (starts[i] < position && position < ends[i])
+                ++expected;
+        
+        int previous = -1;
+        bool inStartOrder = true;
+        
+        auto found = index.forEachNoteSoundingAt(position, [&](const NoteIntervalIndex::Interval& note)
+        {
+            inStartOrder &= note.eventIndex > previous && note.start < position && position < note.end;
+            previous = note.eventIndex;
+        });
+        
+        matchesScan &= (found == expected) && inStartOrder;
+    }
+    
+    TestFramework::assertTrue(matchesScan, "Interval index matches a linear scan");
+    
+    return true;
+}
+
+bool MidiTimelineTests::testNoteHandoff()
+{
+    DBG("Testing note handoff...");
+    
+    // The outgoing track holds notes 40 and 43; the incoming one holds 40 and
+    // 45 at beat 1 (tick 960) and starts note 47 exactly there
+    MidiTimeline timeline;
+    timeline.addEvent(juce::MidiMessage::noteOn(1, 40, (juce::uint8)100).getRawData(), 3, 0);
+    timeline.addEvent(juce::MidiMessage::noteOn(1, 45, (juce::uint8)90).getRawData(), 3, 0);
+    timeline.addEvent(juce::MidiMessage::noteOn(1, 47, (juce::uint8)80).getRawData(), 3, 960);
+    timeline.addEvent(juce::MidiMessage::noteOff(1, 40).getRawData(), 3, 1920);
+    timeline.addEvent(juce::MidiMessage::noteOff(1, 45).getRawData(), 3, 1920);
+    timeline.addEvent(juce::MidiMessage::noteOff(1, 47).getRawData(), 3, 1920);
+    timeline.setTicksPerQuarterNote(960);
+    timeline.finishCompiling();
+    
+    ActiveNotes activeNotes;
+    activeNotes.noteOn(1, 40);
+    activeNotes.noteOn(1, 43);
+    juce::MidiBuffer output;
+    
+    TestFramework::assertEqualInt(1, timeline.handOffNotesAtBeat(1.0, output, 5, activeNotes), "Only the new held note chased");
+    
+    juce::Array<juce::MidiMessage> messages;
+    
+    for (const auto metadata : output)
+        if (metadata.samplePosition == 5)
+            messages.add(metadata.getMessage());
+    
+    TestFramework::assertEqualInt(2, messages.size(), "One release and one chase");
+    TestFramework::assertTrue(messages.size() == 2 && messages[0].isNoteOff() && messages[0].getNoteNumber() == 43,
+                              "Note only the old track holds released first");
+    TestFramework::assertTrue(messages.size() == 2 && messages[1].isNoteOn() && messages[1].getNoteNumber() == 45,
+                              "Note only the new track holds chased");
+    TestFramework::assertTrue(activeNotes.isNoteOn(1, 40) && activeNotes.isNoteOn(1, 45)
+                              && !activeNotes.isNoteOn(1, 43) && !activeNotes.isNoteOn(1, 47),
+                              "Shared note keeps sounding; note at the position left to the render");
+    
+    // On another channel, the shared note is a different note
+    MidiTimeline moved;
+    moved.addEvent(juce::MidiMessage::noteOn(2, 40, (juce::uint8)100).getRawData(), 3, 0);
+    moved.addEvent(juce::MidiMessage::noteOff(2, 40).getRawData(), 3, 1920);
+    moved.setTicksPerQuarterNote(960);
+    moved.finishCompiling();
+    output.clear();
+    
+    TestFramework::assertEqualInt(1, moved.handOffNotesAtBeat(1.0, output, 0, activeNotes), "Note chased on the new channel");
+    TestFramework::assertTrue(activeNotes.isNoteOn(2, 40) && !activeNotes.isNoteOn(1, 40) && !activeNotes.isNoteOn(1, 45),
+                              "Notes moved to the new channel");
+    
+    return true;
+}
+
+bool MidiTimelineTests::testMergedRendering()
+{
+    DBG("Testing merged rendering of several tracks...");
+    
+    // Three tracks at two resolutions whose events often land on the same sample
+    const int numTracks = 3;
+    MidiTimeline tracks[numTracks];
+    
+    for (int t = 0; t < numTracks; ++t)
+    {
+        auto tpq = t == 1 ? 480 : 960;
+        tracks[t].setTicksPerQuarterNote(tpq);
+        
+        for (int i = 0; i < 64; ++i)
+        {
+            auto position = static_cast<juce::int64>(i * tpq / (t + 2));
+            tracks[t].addEvent(juce::MidiMessage::noteOn(t + 1, 36 + i % 24, (juce::uint8)100).getRawData(), 3, position);
+            tracks[t].addEvent(juce::MidiMessage::noteOff(t + 1, 36 + i % 24).getRawData(), 3, position + tpq / 8);
+        }
+        
+        tracks[t].finishCompiling();
+    }
+    
+    MidiTimeline::Cursor referenceCursors[numTracks], mergedCursors[numTracks];
+    ActiveNotes referenceNotes[numTracks], mergedNotes[numTracks];
+    MidiTimeline::MergeSource references[numTracks], sources[numTracks];
+    
+    for (int t = 0; t < numTracks; ++t)
+    {
+        references[t] = { &tracks[t], &referenceCursors[t], &referenceNotes[t] };
+        sources[t] = { &tracks[t], &mergedCursors[t], &mergedNotes[t] };
+    }
+    
+    // Render 40 beats in 512-sample blocks both ways: track by track, each
+    // inserted into a shared block, and in one merged pass
+    const double samplesPerBeat = 22050.0;
+    const int blockSize = 512;
+    const double beatsPerBlock = blockSize / samplesPerBeat;
+    juce::MidiBuffer reference, track, merged;
+    int totalEvents = 0;
+    int mismatches = 0;
+    
+    for (double beat = 0.0; beat < 40.0; beat += beatsPerBlock)
+    {
+        reference.clear();
+        merged.clear();
+        
+        for (int t = 0; t < numTracks; ++t)
+        {
+            references[t].startBeat = sources[t].startBeat = beat;
+            references[t].endBeat = sources[t].endBeat = beat + beatsPerBlock;
+            
+            track.clear();
+            MidiTimeline::renderMergedBeatWindows(&references[t], 1, samplesPerBeat, track, 0, blockSize);
+            reference.addEvents(track, 0, -1, 0);
+        }
+        
+        auto numEmitted = MidiTimeline::renderMergedBeatWindows(sources, numTracks, samplesPerBeat, merged, 0, blockSize);
+        totalEvents += numEmitted;
+        
+        if (numEmitted != reference.getNumEvents() || merged.getNumEvents() != reference.getNumEvents())
+        {
+            ++mismatches;
+            continue;
+        }
+        
+        // Same events in the same order, ties on a sample kept in track order
+        auto expected = reference.begin();
+        
+        for (const auto metadata : merged)
+        {
+            const auto other = *expected;
+            
+            if (metadata.samplePosition != other.samplePosition || metadata.numBytes != other.numBytes
+                 || std::memcmp(metadata.data, other.data, static_cast<size_t>(metadata.numBytes)) != 0)
+                ++mismatches;
+            
+            ++expected;
+        }
+    }
+    
+    TestFramework::assertEqualInt(numTracks * 128, totalEvents, "Every event merged exactly once");
+    TestFramework::assertEqualInt(0, mismatches, "Merged blocks match per-track rendering");
+    
+    // Both paths leave the same notes sounding
+    bool sameNotes = true;
+    
+    for (int t = 0; t < numTracks; ++t)
+        for (int channel = 1; channel <= 16; ++channel)
+            for (int note = 0; note < 128; ++note)
+                sameNotes &= referenceNotes[t].isNoteOn(channel, note) == mergedNotes[t].isNoteOn(channel, note);
+    
+    TestFramework::assertTrue(sameNotes, "Active notes tracked per source");
+    
+    // A merge can continue a block that already holds earlier events
+    juce::MidiBuffer block;
+    block.addEvent(juce::MidiMessage::allNotesOff(1), 0);
+    
+    for (auto& cursor : mergedCursors)
+        cursor.reset();
+    
+    for (auto& source : sources)
+    {
+        source.startBeat = 0.0;
+        source.endBeat = 0.5;
+    }
+    
+    MidiTimeline::renderMergedBeatWindows(sources, numTracks, samplesPerBeat, block, 10, static_cast<int>(0.5 * samplesPerBeat));
+    
+    int previous = 0;
+    bool ordered = true;
+    
+    for (const auto metadata : block)
+    {
+        ordered &= metadata.samplePosition >= previous;
+        previous = metadata.samplePosition;
+    }
+    
+    TestFramework::assertTrue(ordered && block.getNumEvents() > 1, "Merged events appended after existing ones");
+    TestFramework::assertEqualInt(0, block.getFirstEventTime(), "Existing event kept first");
+    
+    // Sources playing different windows all start at the same sample
+    MidiTimeline::Cursor shiftedCursors[2];
+    MidiTimeline::MergeSource shifted[2] = { { &tracks[0], &shiftedCursors[0] }, { &tracks[0], &shiftedCursors[1] } };
+    shifted[0].startBeat = 0.0;
+    shifted[0].endBeat = 0.1;
+    shifted[1].startBeat = 0.5;
+    shifted[1].endBeat = 0.6;
+    
+    block.clear();
+    MidiTimeline::renderMergedBeatWindows(shifted, 2, samplesPerBeat, block, 0, 2205);
+    
+    juce::Array<int> offsets;
+    for (const auto metadata : block)
+        offsets.add(metadata.samplePosition);
+    
+    TestFramework::assertTrue(offsets.size() == 2 && offsets[0] == 0 && offsets[1] == 0,
+                              "Each source window mapped onto the block start");
+    
+    return true;
+}
+
+//==============================================================================
+// Helper Methods
+
+int MidiTimelineTests::countEvents(const juce::MidiBuffer& buffer)
+{
+    return buffer.getNumEvents();
+}
+
+void MidiTimelineTests::compileFromBuffer(MidiTimeline& timeline, const juce::MidiBuffer& source)
+{
+    timeline.clear();
+    timeline.setTicksPerQuarterNote(1024);
+
+    for (const auto metadata : source)
+        timeline.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition);
+
+    timeline.finishCompiling();
+}
+
+int MidiTimelineTests::renderTicks(const MidiTimeline& timeline,
+                                   MidiTimeline::Cursor& cursor,
+                                   juce::int64 startTick,
+                                   juce::int64 endTick,
+                                   juce::MidiBuffer& destination,
+                                   ActiveNotes* activeNotes)
+{
+    auto ticksPerBeat = static_cast<double>(timeline.getTicksPerQuarterNote());
+    MidiTimeline::MergeSource source { &timeline, &cursor, activeNotes,
+                                       static_cast<double>(startTick) / ticksPerBeat,
+                                       static_cast<double>(endTick) / ticksPerBeat };
+
+    return MidiTimeline::renderMergedBeatWindows(&source, 1, ticksPerBeat, destination, 0,
+                                                 static_cast<int>(endTick - startTick));
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/MidiTimeline.h"
+#include "../Source/ActiveNotes.h"
+
+//==============================================================================
+/**
+    Unit Tests for MidiTimeline class
+    
+    Tests the compiled playback timeline including:
+    - Compilation from added events
+    - Window rendering and sample offsets
+    - Cursor continuation and seeking
+    - Long (sysex) message storage
+    - Note chasing through the note interval index
+    - Merging several tracks into one block
+*/
+class MidiTimelineTests
+{
+public:
+    //==============================================================================
+    MidiTimelineTests();
+    ~MidiTimelineTests();
+    
+    //==============================================================================
+    /** Run all MidiTimeline tests */
+    static bool runAllTests();
+    
+    //==============================================================================
+    // Individual Test Methods
+    
+    /** Test compiling a timeline from added events */
+    static bool testCompilation();
+    
+    /** Test rendering consecutive windows with a cursor */
+    static bool testWindowRendering();
+    
+    /** Test cursor seeking on playhead jumps */
+    static bool testCursorSeeking();
+    
+    /** Test storage of messages longer than the inline size */
+    static bool testLongMessages();
+    
+    /** Test the packed event layout and its memory per event */
+    static bool testPackedEvents();
+    
+    /** Test tracking of sounding notes while rendering */
+    static bool testActiveNoteTracking();
+    
+    /** Test finding the notes held at a position after a jump */
+    static bool testNoteChasing();
+    
+    /** Test taking over the notes of another track */
+    static bool testNoteHandoff();
+    
+    /** Test merging several tracks into one block in timestamp order */
+    static bool testMergedRendering();
+
+private:
+    //==============================================================================
+    /** Helper method to count events in a buffer */
+    static int countEvents(const juce::MidiBuffer& buffer);
+    
+    /** Helper method to compile a timeline whose tick positions are the sample
+        positions of a buffer, at a power of two resolution so that tick and
+        beat positions convert exactly
+    */
+    static void compileFromBuffer(MidiTimeline& timeline, const juce::MidiBuffer& source);
+    
+    /** Helper method to render the ticks [startTick, endTick) one sample per tick,
+        offset from startTick, through renderMergedBeatWindows()
+    */
+    static int renderTicks(const MidiTimeline& timeline,
+                           MidiTimeline::Cursor& cursor,
+                           juce::int64 startTick,
+                           juce::int64 endTick,
+                           juce::MidiBuffer& destination,
+                           ActiveNotes* activeNotes = nullptr);
+    
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiTimelineTests)
+};
@@ -0,0 +1,628 @@
+#include "PerformanceBenchmarks.h"
+
+//==============================================================================
+PerformanceBenchmarks::PerformanceBenchmarks()
+{
+}
+
+PerformanceBenchmarks::~PerformanceBenchmarks()
+{
+}
+
+//==============================================================================
+bool PerformanceBenchmarks::runAllBenchmarks()
+{
+    DBG("=== Running Performance Benchmarks ===");
+
+    bool allPassed = true;
+
+    allPassed &= benchmarkTimelineRendering();
+    allPassed &= benchmarkTrackMerge();
+    allPassed &= benchmarkOfflineRender();
+    allPassed &= benchmarkEventMemory();
+    allPassed &= benchmarkMidiFileParsing();
+    allPassed &= benchmarkCompiledTrackCache();
+    allPassed &= benchmarkParallelParsing();
+
+    DBG("=== Performance Benchmarks Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool PerformanceBenchmarks::benchmarkTimelineRendering()
+{
+    DBG("Benchmarking timeline rendering...");
+
+    // Same event density for every size, so each block emits the same number
+    // of events; only the total track length changes
+    const int blockSize = 64;
+    const int samplesBetweenEvents = 96;
+    const int numBlocks = 20000;
+    const int trackSizes[] = { 1000, 10000, 100000, 1000000 };
+
+    juce::MidiBuffer output;
+    output.ensureSize(4096);
+
+    double smallestTrackCost = 0.0;
+    double largestTrackCost = 0.0;
+
+    for (auto numEvents : trackSizes)
+    {
+        MidiTimeline timeline;
+        buildDenseTimeline(timeline, numEvents, samplesBetweenEvents);
+
+        // One beat per block, so every window starts on an exact tick
+        timeline.setTicksPerQuarterNote(blockSize);
+
+        MidiTimeline::Cursor cursor;
+        MidiTimeline::MergeSource source { &timeline, &cursor };
+        auto trackLength = timeline.getEndPosition();
+        int emitted = 0;
+
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // Wrap around inside the track so every size plays the same
+            // number of blocks; the wrap itself costs one seek
+            auto start = (static_cast<juce::int64>(block) * blockSize) % trackLength;
+            source.startBeat = static_cast<double>(start / blockSize);
+            source.endBeat = source.startBeat + 1.0;
+
+            output.clear();
+            emitted += MidiTimeline::renderMergedBeatWindows(&source, 1, blockSize, output, 0, blockSize);
+        }
+
+        auto elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+        auto nanosPerBlock = ticksToNanoseconds(elapsed) / numBlocks;
+
+        if (numEvents == trackSizes[0])
+            smallestTrackCost = nanosPerBlock;
+
+        largestTrackCost = nanosPerBlock;
+
+        juce::Logger::writeToLog("Timeline render: " + juce::String(numEvents) + " events, "
+                                 + juce::String(nanosPerBlock, 1) + " ns/block, "
+                                 + juce::String(emitted) + " events emitted");
+    }
+
+    // The per-block cost must not grow with the length of the track
+    // (generous bound to stay robust against scheduler noise)
+    TestFramework::assertTrue(largestTrackCost < smallestTrackCost * 4.0 + 1000.0,
+                              "Timeline per-block cost stays flat as track length grows");
+
+    return true;
+}
+
+bool PerformanceBenchmarks::benchmarkTrackMerge()
+{
+    DBG("Benchmarking track merging...");
+
+    // One tick per sample, so the beat windows line up with whole blocks;
+    // slightly different spacings keep the tracks' events interleaved
+    const double samplesPerBeat = 22050.0;
+    const int blockSize = 256;
+    const int numBlocks = 10000;
+    const int numEventsPerTrack = 20000;
+    const int trackCounts[] = { 2, 8, 32 };
+
+    juce::MidiBuffer scratch, output;
+    scratch.ensureSize(65536);
+    output.ensureSize(65536);
+
+    for (auto numTracks : trackCounts)
+    {
+        std::vector<std::unique_ptr<MidiTimeline>> tracks;
+        std::vector<MidiTimeline::Cursor> cursors(static_cast<size_t>(numTracks));
+        std::vector<MidiTimeline::MergeSource> sources;
+
+        for (int t = 0; t < numTracks; ++t)
+        {
+            tracks.push_back(std::make_unique<MidiTimeline>());
+            buildDenseTimeline(*tracks.back(), numEventsPerTrack, 48 + t);
+            tracks.back()->setTicksPerQuarterNote(static_cast<int>(samplesPerBeat));
+            sources.push_back({ tracks.back().get(), &cursors[static_cast<size_t>(t)], nullptr });
+        }
+
+        auto trackLength = static_cast<double>(tracks.front()->getEndPosition()) / samplesPerBeat;
+        const double beatsPerBlock = blockSize / samplesPerBeat;
+
+        // Previous approach: every track inserts into a shared buffer, which
+        // is then copied into the output
+        int legacyEmitted = 0;
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            auto beat = std::fmod(block * beatsPerBlock, trackLength);
+
+            scratch.clear();
+            output.clear();
+
+            for (auto& track : tracks)
+            {
+                auto startTick = static_cast<juce::int64>(std::ceil(beat * samplesPerBeat));
+                auto endTick = static_cast<juce::int64>(std::ceil((beat + beatsPerBlock) * samplesPerBeat));
+
+                for (auto index = track->findFirstEventAtOrAfter(startTick);
+                     index < static_cast<size_t>(track->getNumEvents()) && track->getEvent(static_cast<int>(index)).position < endTick;
+                     ++index)
+                {
+                    const auto& event = track->getEvent(static_cast<int>(index));
+                    scratch.addEvent(track->getEventData(event), track->getEventSize(event),
+                                     juce::jlimit(0, blockSize - 1, static_cast<int>(event.position - startTick)));
+                }
+            }
+
+            output.addEvents(scratch, 0, blockSize, 0);
+            legacyEmitted += output.getNumEvents();
+        }
+
+        auto legacyCost = ticksToNanoseconds(juce::Time::getHighResolutionTicks() - startTicks) / numBlocks;
+
+        for (auto& cursor : cursors)
+            cursor.reset();
+
+        // Heap merge appending straight into the output
+        int mergedEmitted = 0;
+        startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            auto beat = std::fmod(block * beatsPerBlock, trackLength);
+
+            for (auto& source : sources)
+            {
+                source.startBeat = beat;
+                source.endBeat = beat + beatsPerBlock;
+            }
+
+            output.clear();
+            mergedEmitted += MidiTimeline::renderMergedBeatWindows(sources.data(), numTracks, samplesPerBeat, output, 0, blockSize);
+        }
+
+        auto mergedCost = ticksToNanoseconds(juce::Time::getHighResolutionTicks() - startTicks) / numBlocks;
+
+        juce::Logger::writeToLog("Track merge: " + juce::String(numTracks) + " tracks, "
+                                 + juce::String(mergedEmitted / numBlocks) + " events/block, "
+                                 + juce::String(legacyCost, 1) + " ns/block per-track insert, "
+                                 + juce::String(mergedCost, 1) + " ns/block merged");
+
+        TestFramework::assertEqualInt(legacyEmitted, mergedEmitted, "Both paths emit the same events");
+
+        // Inserting grows quadratically with the events per block, so with
+        // many tracks the merge must come out ahead (generous bound for noise)
+        if (numTracks == trackCounts[2])
+            TestFramework::assertTrue(mergedCost < legacyCost * 1.5 + 1000.0,
+                                      "Merged rendering is not slower than per-track insertion");
+    }
+
+    return true;
+}
+
+bool PerformanceBenchmarks::benchmarkOfflineRender()
+{
+    DBG("Benchmarking offline rendering...");
+
+    // Ten minutes at 120 BPM: sixteenth-note bass and eighth-note drums
+    const int numBeats = 1200;
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("benchmark_bass.mid");
+    auto drumFile = tempDir.getChildFile("benchmark_drums.mid");
+    auto outputFile = tempDir.getChildFile("benchmark_render.mid");
+
+    writeDenseMidiFile(bassFile, numBeats, 4);
+    writeDenseMidiFile(drumFile, numBeats, 2);
+
+    auto processor = std::make_unique<AIBandAudioProcessor>();
+    processor->prepareToPlay(44100.0, 512);
+    processor->loadMidiFiles(bassFile.getFullPathName(), drumFile.getFullPathName());
+    processor->setTrackChannel(TrackExchange::drumTrack, 10);
+
+    AIBandAudioProcessor::OfflineRenderOptions options;
+    options.lengthInBeats = numBeats;
+
+    const int blockSizes[] = { 64, 512, 4096 };
+
+    for (auto blockSize : blockSizes)
+    {
+        options.blockSize = blockSize;
+
+        AIBandAudioProcessor::OfflineRenderStatistics statistics;
+        bool written = processor->renderToMidiFile(outputFile.getFullPathName(), options, &statistics);
+
+        juce::Logger::writeToLog("Offline render: block size " + juce::String(blockSize) + ", "
+                                 + juce::String(statistics.numEvents) + " events in "
+                                 + juce::String(statistics.elapsedSeconds * 1000.0, 1) + " ms, "
+                                 + juce::String(statistics.getEventsPerSecond() / 1.0e6, 2) + " M events/s, "
+                                 + juce::String(statistics.getRealtimeFactor(), 0) + "x realtime");
+
+        TestFramework::assertTrue(written, "Render written");
+        TestFramework::assertEqualInt(numBeats * (4 + 2) * 2, statistics.numEvents, "Every note rendered");
+
+        // Generous bound: even a debug build renders far faster than this
+        TestFramework::assertTrue(statistics.getRealtimeFactor() > 10.0, "Offline render is faster than real time");
+    }
+
+    return true;
+}
+
+bool PerformanceBenchmarks::benchmarkEventMemory()
+{
+    DBG("Benchmarking event memory...");
+
+    // A multi-hour generated set: an event every 1000 samples is over six
+    // hours at 44.1 kHz, and still inside MidiBuffer's 32-bit positions
+    const int numEvents = 1000000;
+    const int samplesBetweenEvents = 1000;
+    const int windowSize = 512;
+
+    MidiTimeline timeline;
+    buildDenseTimeline(timeline, numEvents, samplesBetweenEvents);
+    timeline.setTicksPerQuarterNote(windowSize);
+
+    // The same events in MidiBuffer's own layout, written in order
+    juce::MidiBuffer buffer;
+    for (int i = 0; i < timeline.getNumEvents(); ++i)
+    {
+        const auto& event = timeline.getEvent(i);
+        MidiTimeline::appendEvent(buffer, timeline.getEventData(event), timeline.getEventSize(event),
+                                  static_cast<int>(event.position));
+    }
+
+    auto bufferBytesPerEvent = static_cast<double>(buffer.data.size()) / numEvents;
+    auto indexBytes = timeline.getNoteIndex().getMemoryUsage();
+    auto eventBytesPerEvent = static_cast<double>(timeline.getMemoryUsage() - indexBytes) / numEvents;
+
+    // A MidiMessageSequence holds every event in its own heap object; this
+    // leaves out the allocator's overhead, so the real figure is higher
+    auto sequenceBytesPerEvent = static_cast<double>(sizeof(juce::MidiMessageSequence::MidiEventHolder) + sizeof(void*));
+
+    // Scan cost: read every event once, window by window
+    MidiTimeline::Cursor cursor;
+    MidiTimeline::MergeSource source { &timeline, &cursor };
+    juce::MidiBuffer output;
+    output.ensureSize(4096);
+    int timelineEvents = 0;
+
+    auto trackLength = timeline.getEndPosition() + 1;
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (juce::int64 start = 0; start < trackLength; start += windowSize)
+    {
+        source.startBeat = static_cast<double>(start / windowSize);
+        source.endBeat = source.startBeat + 1.0;
+
+        output.clear();
+        timelineEvents += MidiTimeline::renderMergedBeatWindows(&source, 1, windowSize, output, 0, windowSize);
+    }
+
+    auto timelineCost = ticksToNanoseconds(juce::Time::getHighResolutionTicks() - startTicks) / numEvents;
+
+    // MidiBuffer::addEvents() searches from the start for every window, so
+    // the buffer gets a cursor of its own to keep the comparison fair
+    int bufferEvents = 0;
+    auto next = buffer.begin();
+    startTicks = juce::Time::getHighResolutionTicks();
+
+    for (juce::int64 start = 0; start < trackLength; start += windowSize)
+    {
+        output.clear();
+
+        for (; next != buffer.end() && (*next).samplePosition < start + windowSize; ++next)
+        {
+            const auto metadata = *next;
+            MidiTimeline::appendEvent(output, metadata.data, metadata.numBytes,
+                                      static_cast<int>(metadata.samplePosition - start));
+            ++bufferEvents;
+        }
+    }
+
+    auto bufferCost = ticksToNanoseconds(juce::Time::getHighResolutionTicks() - startTicks) / numEvents;
+
+    juce::Logger::writeToLog("Event memory: " + juce::String(numEvents) + " events, packed timeline "
+                             + juce::String(eventBytesPerEvent, 2) + " bytes/event (+ "
+                             + juce::String(static_cast<double>(indexBytes) / numEvents, 2) + " note index), MidiBuffer "
+                             + juce::String(bufferBytesPerEvent, 2) + " bytes/event, MidiMessageSequence at least "
+                             + juce::String(sequenceBytesPerEvent, 0) + " bytes/event");
+    juce::Logger::writeToLog("Event scan: packed timeline " + juce::String(timelineCost, 2) + " ns/event, MidiBuffer "
+                             + juce::String(bufferCost, 2) + " ns/event");
+
+    TestFramework::assertEqualInt(numEvents, timelineEvents, "Timeline scan reads every event");
+    TestFramework::assertEqualInt(numEvents, bufferEvents, "Buffer scan reads every event");
+    TestFramework::assertTrue(eventBytesPerEvent < 8.1, "Packed events take 8 bytes");
+    TestFramework::assertTrue(eventBytesPerEvent < bufferBytesPerEvent, "Packed events are smaller than MidiBuffer storage");
+    TestFramework::assertTrue(timeline.getMemoryPerEvent() < sequenceBytesPerEvent,
+                              "Timeline with its note index is smaller than a MidiMessageSequence");
+
+    return true;
+}
+
+bool PerformanceBenchmarks::benchmarkMidiFileParsing()
+{
+    DBG("Benchmarking MIDI file parsing...");
+
+    // A dense multi-track arrangement, as the backend writes it
+    const int numTracks = 8;
+    const int notesPerTrack = 25000;
+    const int numRuns = 5;
+
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(480);
+
+    for (int trackIndex = 0; trackIndex < numTracks; ++trackIndex)
+    {
+        juce::MidiMessageSequence track;
+        auto channel = trackIndex + 1;
+
+        for (int i = 0; i < notesPerTrack; ++i)
+        {
+            auto note = 36 + (i + trackIndex) % 24;
+            track.addEvent(juce::MidiMessage::noteOn(channel, note, (juce::uint8)100), i * 120.0);
+            track.addEvent(juce::MidiMessage::noteOff(channel, note), i * 120.0 + 60.0);
+        }
+
+        track.updateMatchedPairs();
+        midiFile.addTrack(track);
+    }
+
+    juce::MemoryBlock data;
+
+    {
+        juce::MemoryOutputStream stream(data, false);
+        midiFile.writeTo(stream);
+    }
+
+    auto megabytes = static_cast<double>(data.getSize()) / (1024.0 * 1024.0);
+    const int numEvents = numTracks * notesPerTrack * 2;
+
+    // Best of several runs for each path, both from the same bytes in memory
+    MidiManager midiManager;
+    MidiTimeline midiFileTimeline;
+    double midiFileSeconds = 0.0;
+
+    for (int run = 0; run < numRuns; ++run)
+    {
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        juce::MidiFile readBack;
+        juce::MemoryInputStream stream(data, false);
+        readBack.readFrom(stream);
+        midiManager.convertMidiFileToTimeline(readBack, midiFileTimeline);
+
+        auto seconds = ticksToNanoseconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e-9;
+        midiFileSeconds = run == 0 ? seconds : juce::jmin(midiFileSeconds, seconds);
+    }
+
+    MidiFileParser parser;
+    MidiTimeline parserTimeline;
+    double parserSeconds = 0.0;
+
+    for (int run = 0; run < numRuns; ++run)
+    {
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        parser.parse(data.getData(), data.getSize(), parserTimeline);
+
+        auto seconds = ticksToNanoseconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e-9;
+        parserSeconds = run == 0 ? seconds : juce::jmin(parserSeconds, seconds);
+    }
+
+    juce::Logger::writeToLog("MIDI file parsing: " + juce::String(numEvents) + " events, "
+                             + juce::String(megabytes, 2) + " MB; juce::MidiFile "
+                             + juce::String(megabytes / midiFileSeconds, 1) + " MB/s, "
+                             + juce::String(numEvents / midiFileSeconds / 1.0e6, 2) + " M events/s; MidiFileParser "
+                             + juce::String(megabytes / parserSeconds, 1) + " MB/s, "
+                             + juce::String(numEvents / parserSeconds / 1.0e6, 2) + " M events/s ("
+                             + juce::String(midiFileSeconds / parserSeconds, 1) + "x)");
+
+    TestFramework::assertEqualInt(numEvents, midiFileTimeline.getNumEvents(), "juce::MidiFile path reads every event");
+    TestFramework::assertEqualInt(numEvents, parserTimeline.getNumEvents(), "Parser reads every event");
+
+    // Generous bound: skipping the intermediate sequences must not cost time
+    TestFramework::assertTrue(parserSeconds < midiFileSeconds * 1.5, "Parser is not slower than juce::MidiFile");
+
+    return true;
+}
+
+bool PerformanceBenchmarks::benchmarkCompiledTrackCache()
+{
+    DBG("Benchmarking compiled track loading...");
+
+    // A session's worth of files, each with different content
+    const int numFiles = 120;
+    const int notesPerBeat = 4;
+
+    auto folder = TestFramework::createTempTestDirectory();
+    juce::Array<juce::File> files;
+
+    for (int i = 0; i < numFiles; ++i)
+    {
+        auto file = folder.getChildFile("track_" + juce::String(i) + ".mid");
+        writeDenseMidiFile(file, 256 + i, notesPerBeat);
+        files.add(file);
+    }
+
+    CompiledTrackCache compiledTracks(CompiledTrackCache::getFolderFor(folder));
+    MidiManager midiManager;
+    int numEvents = 0;
+
+    // Both sessions read every file and start with nothing in memory; the
+    // first parses and stores, the second maps the stored tracks
+    auto loadSession = [&](TimelineCache& cache)
+    {
+        numEvents = 0;
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (const auto& file : files)
+        {
+            juce::MemoryBlock data;
+            file.loadFileAsData(data);
+
+            if (auto timeline = cache.getTimeline(data.getData(), data.getSize(), midiManager, &compiledTracks))
+                numEvents += timeline->getNumEvents();
+        }
+
+        return ticksToNanoseconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e-6;
+    };
+
+    TimelineCache coldSession;
+    auto coldMilliseconds = loadSession(coldSession);
+    auto coldEvents = numEvents;
+
+    TimelineCache warmSession;
+    auto warmMilliseconds = loadSession(warmSession);
+
+    juce::Logger::writeToLog("Compiled track loading: " + juce::String(numFiles) + " files, "
+                             + juce::String(numEvents) + " events; cold "
+                             + juce::String(coldMilliseconds / numFiles, 3) + " ms/file, warm "
+                             + juce::String(warmMilliseconds / numFiles, 3) + " ms/file ("
+                             + juce::String(coldMilliseconds / warmMilliseconds, 1) + "x)");
+
+    TestFramework::assertEqualInt(numFiles, warmSession.getStatistics().compiledLoads, "Every file served by its compiled track");
+    TestFramework::assertEqualInt(coldEvents, numEvents, "Warm loads restore every event");
+
+    // Generous bound: mapping a compiled track must beat parsing and indexing it
+    TestFramework::assertTrue(warmMilliseconds < coldMilliseconds, "Warm load is faster than parsing");
+
+    return true;
+}
+
+bool PerformanceBenchmarks::benchmarkParallelParsing()
+{
+    DBG("Benchmarking parallel MIDI file parsing...");
+
+    // A generated arrangement with one track per drum voice and instrument
+    const int numTracks = 32;
+    const int notesPerTrack = 20000;
+    const int numRuns = 5;
+    const int maxCores = juce::jmin(16, juce::SystemStats::getNumCpus());
+
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(480);
+
+    for (int trackIndex = 0; trackIndex < numTracks; ++trackIndex)
+    {
+        juce::MidiMessageSequence track;
+        auto channel = trackIndex % 16 + 1;
+
+        for (int i = 0; i < notesPerTrack; ++i)
+        {
+            auto note = 36 + (i + trackIndex) % 24;
+            track.addEvent(juce::MidiMessage::noteOn(channel, note, (juce::uint8)100), i * 120.0);
+            track.addEvent(juce::MidiMessage::noteOff(channel, note), i * 120.0 + 60.0);
+        }
+
+        track.updateMatchedPairs();
+        midiFile.addTrack(track);
+    }
+
+    juce::MemoryBlock data;
+
+    {
+        juce::MemoryOutputStream stream(data, false);
+        midiFile.writeTo(stream);
+    }
+
+    const int numEvents = numTracks * notesPerTrack * 2;
+    MidiTimeline sequential;
+    double singleCoreSeconds = 0.0;
+    double allCoresSeconds = 0.0;
+    bool allIdentical = true;
+
+    // The caller's thread always works too, so N cores means N - 1 pool threads
+    for (int numCores = 1; numCores <= maxCores; ++numCores)
+    {
+        std::unique_ptr<juce::ThreadPool> threadPool;
+        MidiFileParser parser;
+
+        if (numCores > 1)
+        {
+            threadPool = std::make_unique<juce::ThreadPool>(numCores - 1);
+            parser.setThreadPool(threadPool.get());
+        }
+
+        MidiTimeline timeline;
+        double seconds = 0.0;
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            auto startTicks = juce::Time::getHighResolutionTicks();
+            parser.parse(data.getData(), data.getSize(), numCores == 1 ? sequential : timeline);
+
+            auto runSeconds = ticksToNanoseconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e-9;
+            seconds = run == 0 ? runSeconds : juce::jmin(seconds, runSeconds);
+        }
+
+        if (numCores == 1)
+            singleCoreSeconds = seconds;
+        else
+            allIdentical = allIdentical && timeline.getNumEvents() == sequential.getNumEvents()
+                        && std::memcmp(&timeline.getEvent(0), &sequential.getEvent(0),
+                                       static_cast<size_t>(numEvents) * sizeof(MidiTimeline::Event)) == 0;
+
+        allCoresSeconds = seconds;
+
+        juce::Logger::writeToLog("Parallel parsing: " + juce::String(numTracks) + " tracks, "
+                                 + juce::String(numEvents) + " events, " + juce::String(numCores) + " cores: "
+                                 + juce::String(seconds * 1000.0, 2) + " ms ("
+                                 + juce::String(singleCoreSeconds / seconds, 2) + "x)");
+    }
+
+    TestFramework::assertEqualInt(numEvents, sequential.getNumEvents(), "Parser reads every event");
+    TestFramework::assertTrue(allIdentical, "Every core count gives the sequential timeline");
+
+    // Generous bound: handing tracks to other cores must not cost time
+    TestFramework::assertTrue(allCoresSeconds < singleCoreSeconds * 1.5, "All cores are not slower than one");
+
+    return true;
+}
+
+//==============================================================================
+// Helper Methods
+
+void PerformanceBenchmarks::buildDenseTimeline(MidiTimeline& timeline, int numEvents, int samplesBetweenEvents)
+{
+    timeline.clear();
+
+    for (int i = 0; i < numEvents; ++i)
+    {
+        auto note = 36 + (i / 2) % 24;
+        auto message = (i % 2 == 0) ? juce::MidiMessage::noteOn(1, note, (juce::uint8)100)
+                                    : juce::MidiMessage::noteOff(1, note);
+
+        timeline.addEvent(message.getRawData(), message.getRawDataSize(),
+                          static_cast<juce::int64>(i) * samplesBetweenEvents);
+    }
+
+    timeline.finishCompiling();
+}
+
+double PerformanceBenchmarks::ticksToNanoseconds(juce::int64 ticks)
+{
+    return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9;
+}
+
+bool PerformanceBenchmarks::writeDenseMidiFile(const juce::File& file, int numBeats, int notesPerBeat)
+{
+    const int ticksPerQuarterNote = 480;
+    const int ticksPerNote = ticksPerQuarterNote / notesPerBeat;
+
+    juce::MidiMessageSequence track;
+
+    for (int i = 0; i < numBeats * notesPerBeat; ++i)
+    {
+        auto note = 36 + i % 24;
+        track.addEvent(juce::MidiMessage::noteOn(1, note, (juce::uint8)100), static_cast<double>(i * ticksPerNote));
+        track.addEvent(juce::MidiMessage::noteOff(1, note), static_cast<double>(i * ticksPerNote + ticksPerNote / 2));
+    }
+
+    track.updateMatchedPairs();
+
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(ticksPerQuarterNote);
+    midiFile.addTrack(track);
+
+    file.deleteFile();
+    juce::FileOutputStream stream(file);
+    return !stream.failedToOpen() && midiFile.writeTo(stream);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/CompiledTrackCache.h"
+#include "../Source/MidiFileParser.h"
+#include "../Source/MidiManager.h"
+#include "../Source/MidiTimeline.h"
+#include "../Source/PluginProcessor.h"
+#include "../Source/TimelineCache.h"
+
+//==============================================================================
+/**
+    Performance Benchmarks for AI Band Plugin
+
+    Measures the real-time critical paths of the plugin and reports the
+    results through juce::Logger. Benchmarks are not part of runAllTests();
+    run them explicitly with "--suite Performance", ideally in a Release build.
+*/
+class PerformanceBenchmarks
+{
+public:
+    //==============================================================================
+    PerformanceBenchmarks();
+    ~PerformanceBenchmarks();
+
+    //==============================================================================
+    /** Run all benchmarks */
+    static bool runAllBenchmarks();
+
+    //==============================================================================
+    // Individual Benchmarks
+
+    /** Per-block timeline rendering cost for growing track lengths */
+    static bool benchmarkTimelineRendering();
+
+    /** Per-block cost of combining 2, 8 and 32 tracks into one output buffer */
+    static bool benchmarkTrackMerge();
+
+    /** Events per second and realtime factor of rendering an arrangement to a file */
+    static bool benchmarkOfflineRender();
+
+    /** Memory per event and scan cost of packed timelines against MidiBuffer storage */
+    static bool benchmarkEventMemory();
+
+    /** Parse throughput of MidiFileParser against juce::MidiFile in MB/s and events/s */
+    static bool benchmarkMidiFileParsing();
+
+    /** Per-file load time of 120 files parsed cold against loaded from compiled tracks */
+    static bool benchmarkCompiledTrackCache();
+
+    /** Parse time of a 32-track file with 1 to N cores decoding and merging tracks */
+    static bool benchmarkParallelParsing();
+
+private:
+    //==============================================================================
+    /** Helper to build a timeline with evenly spaced note events */
+    static void buildDenseTimeline(MidiTimeline& timeline, int numEvents, int samplesBetweenEvents);
+
+    /** Helper to write a MIDI file with a number of notes in every beat */
+    static bool writeDenseMidiFile(const juce::File& file, int numBeats, int notesPerBeat);
+
+    /** Helper to convert high resolution ticks to nanoseconds */
+    static double ticksToNanoseconds(juce::int64 ticks);
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PerformanceBenchmarks)
+};
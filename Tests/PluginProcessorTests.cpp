@@ -1,5 +1,39 @@
 #include "PluginProcessorTests.h"
 
+namespace
+{
+    /** A note on channel 1, in quarter notes */
+    struct TestNote
+    {
+        int noteNumber;
+        double startBeat;
+        double endBeat;
+    };
+    
+    /** Write a single-track MIDI file at 480 ticks per quarter note */
+    bool writeTestNotes(const juce::File& file, std::initializer_list<TestNote> notes)
+    {
+        juce::MidiMessageSequence track;
+        
+        for (const auto& note : notes)
+        {
+            track.addEvent(juce::MidiMessage::noteOn(1, note.noteNumber, (juce::uint8)100), note.startBeat * 480.0);
+            track.addEvent(juce::MidiMessage::noteOff(1, note.noteNumber), note.endBeat * 480.0);
+        }
+        
+        track.sort();
+        track.updateMatchedPairs();
+        
+        juce::MidiFile midiFile;
+        midiFile.setTicksPerQuarterNote(480);
+        midiFile.addTrack(track);
+        
+        file.deleteFile();
+        juce::FileOutputStream stream(file);
+        return !stream.failedToOpen() && midiFile.writeTo(stream);
+    }
+}
+
 //==============================================================================
 PluginProcessorTests::PluginProcessorTests()
 {
@@ -24,6 +58,22 @@ bool PluginProcessorTests::runAllTests()
     allPassed &= testPlaybackControl();
     allPassed &= testBeatPositionTracking();
     allPassed &= testMidiEventProcessing();
+    allPassed &= testTempoChangeWithoutReload();
+    allPassed &= testRealtimeAllocations();
+    allPassed &= testUnreservedHostBuffer();
+    allPassed &= testAlternatingHostBuffers();
+    allPassed &= testDenseTracksWhilePlaying();
+    allPassed &= testNoteOffsOnStopAndSeek();
+    allPassed &= testNoteChasingOnSeek();
+    allPassed &= testHostLoopWrap();
+    allPassed &= testInternalTransport();
+    allPassed &= testPlaybackCommands();
+    allPassed &= testTrackMixing();
+    allPassed &= testTrackTransforms();
+    allPassed &= testBarHandoff();
+    allPassed &= testOfflineRender();
+    allPassed &= testSharedTracks();
+    allPassed &= testTimingOffsets();
     allPassed &= testFolderMonitoring();
     allPassed &= testStateManagement();
     
@@ -245,6 +295,1141 @@ bool PluginProcessorTests::testMidiEventProcessing()
     return true;
 }
 
+bool PluginProcessorTests::testTempoChangeWithoutReload()
+{
+    DBG("Testing tempo and sample rate changes without reload...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("tempo_bass.mid");
+    
+    // File tempo (90 BPM) deliberately differs from the host tempo
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 4, 480, 90);
+    processor->loadMidiFiles(bassFile.getFullPathName(), "");
+    
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
+    // 120 BPM at 44.1 kHz: one beat = 22050 samples
+    auto noteOns = collectNoteOnSamples(*processor, playHead, 44100.0, 100);
+    TestFramework::assertTrue(noteOns.size() >= 2, "Notes rendered at 120 BPM");
+    TestFramework::assertTrue(noteOns[1] == 22050, "Second beat lands on sample 22050 at 120 BPM");
+    
+    // Host slows to 60 BPM: same data, one beat = 44100 samples
+    playHead = TestPlayHead();
+    playHead.bpm = 60.0;
+    noteOns = collectNoteOnSamples(*processor, playHead, 44100.0, 100);
+    TestFramework::assertTrue(noteOns.size() >= 2, "Notes rendered at 60 BPM");
+    TestFramework::assertTrue(noteOns[1] == 44100, "Second beat lands on sample 44100 at 60 BPM");
+    
+    // Sample rate change: 120 BPM at 48 kHz, one beat = 24000 samples
+    processor->prepareToPlay(48000.0, 512);
+    playHead = TestPlayHead();
+    noteOns = collectNoteOnSamples(*processor, playHead, 48000.0, 100);
+    TestFramework::assertTrue(noteOns.size() >= 2, "Notes rendered at 48 kHz");
+    TestFramework::assertTrue(noteOns[1] == 24000, "Second beat lands on sample 24000 at 48 kHz");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testRealtimeAllocations()
+{
+    DBG("Testing processBlock allocations...");
+    
+    if (!AllocationGuard::isEnabled())
+    {
+        DBG("Allocation detection not built in (DETECT_RT_ALLOCATIONS=OFF), skipping");
+        return true;
+    }
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("alloc_bass.mid");
+    auto drumFile = tempDir.getChildFile("alloc_drum.mid");
+    
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 16);
+    TestFramework::createTestMidiFileInTicks(drumFile.getFullPathName(), 32, 960);
+    processor->loadMidiFiles(bassFile.getFullPathName(), drumFile.getFullPathName());
+    
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    int numAllocations = 0;
+    int numEvents = 0;
+    ActiveNotes soundingNotes;
+    bool notesHangingAfterStop = true;
+    
+    for (int block = 0; block < 400; ++block)
+    {
+        // Control changes happen on this (message) thread between blocks;
+        // new tracks and stop requests are picked up inside processBlock
+        if (block == 100)
+            processor->loadMidiFiles(drumFile.getFullPathName(), bassFile.getFullPathName());
+        
+        if (block == 200)
+            processor->stopPlayback();
+        
+        if (block == 300)
+            processor->startPlayback();
+        
+        createTestBuffers(audioBuffer, midiBuffer);
+        numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+        numEvents += midiBuffer.getNumEvents();
+        
+        for (const auto metadata : midiBuffer)
+            soundingNotes.handleMidiEvent(metadata.data, metadata.numBytes);
+        
+        if (block == 200)
+            notesHangingAfterStop = !soundingNotes.isEmpty();
+        
+        playHead.advance(512, 44100.0);
+    }
+    
+    TestFramework::assertTrue(numEvents > 0, "Tracks were rendered");
+    TestFramework::assertTrue(!notesHangingAfterStop, "Every note released in the block after stopping");
+    TestFramework::assertEqualInt(0, numAllocations, "processBlock does not allocate");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testUnreservedHostBuffer()
+{
+    DBG("Testing an unreserved host MIDI buffer...");
+    
+    if (!AllocationGuard::isEnabled())
+    {
+        DBG("Allocation detection not built in (DETECT_RT_ALLOCATIONS=OFF), skipping");
+        return true;
+    }
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("unreserved_bass.mid");
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 64, 960);
+    processor->loadMidiFiles(bassFile.getFullPathName(), "");
+    
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
+    // Kept across blocks as a host would, but never sized and with incoming
+    // MIDI in it; the first block must not grow it to fit the tracks
+    juce::AudioBuffer<float> audioBuffer = TestFramework::createSilentAudioBuffer(2, 512);
+    juce::MidiBuffer hostBuffer;
+    int numAllocations = 0;
+    int numTrackEvents = 0;
+    bool incomingKept = true;
+    
+    for (int block = 0; block < 200; ++block)
+    {
+        hostBuffer.clear();
+        
+        if (block == 0)
+        {
+            // Fill whatever storage the buffer had before the block
+            hostBuffer.addEvent(juce::MidiMessage::controllerEvent(16, 1, 64), 0);
+            
+            while (hostBuffer.data.size() < hostBuffer.data.getNumAllocated())
+                hostBuffer.addEvent(juce::MidiMessage::controllerEvent(16, 1, 64), 0);
+        }
+        
+        auto numIncoming = hostBuffer.getNumEvents();
+        numAllocations += processBlockCountingAllocations(*processor, audioBuffer, hostBuffer);
+        
+        int numKept = 0;
+        
+        for (const auto metadata : hostBuffer)
+        {
+            if (metadata.getMessage().getChannel() == 16)
+                ++numKept;
+            else
+                ++numTrackEvents;
+        }
+        
+        incomingKept &= numKept == numIncoming;
+        playHead.advance(512, 44100.0);
+    }
+    
+    TestFramework::assertTrue(numTrackEvents > 0, "Tracks were rendered");
+    TestFramework::assertTrue(incomingKept, "Incoming MIDI passed through");
+    TestFramework::assertEqualInt(0, numAllocations, "A full host buffer is not grown");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testAlternatingHostBuffers()
+{
+    DBG("Testing alternating unreserved host MIDI buffers...");
+    
+    if (!AllocationGuard::isEnabled())
+    {
+        DBG("Allocation detection not built in (DETECT_RT_ALLOCATIONS=OFF), skipping");
+        return true;
+    }
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("alternating_bass.mid");
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 64, 960);
+    processor->loadMidiFiles(bassFile.getFullPathName(), "");
+    
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
+    // Double-buffering hosts take turns with two buffers, here never sized;
+    // neither may be grown, before or after it has been swapped once
+    juce::AudioBuffer<float> audioBuffer = TestFramework::createSilentAudioBuffer(2, 512);
+    std::array<juce::MidiBuffer, 2> hostBuffers;
+    int numAllocations = 0;
+    int numTrackEvents = 0;
+    
+    for (int block = 0; block < 200; ++block)
+    {
+        auto& hostBuffer = hostBuffers[static_cast<size_t>(block % 2)];
+        hostBuffer.clear();
+        numAllocations += processBlockCountingAllocations(*processor, audioBuffer, hostBuffer);
+        numTrackEvents += hostBuffer.getNumEvents();
+        playHead.advance(512, 44100.0);
+    }
+    
+    TestFramework::assertTrue(numTrackEvents > 0, "Tracks were rendered");
+    TestFramework::assertEqualInt(0, numAllocations, "Alternating small host buffers are not grown");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testDenseTracksWhilePlaying()
+{
+    DBG("Testing dense tracks loaded while playing...");
+    
+    if (!AllocationGuard::isEnabled())
+    {
+        DBG("Allocation detection not built in (DETECT_RT_ALLOCATIONS=OFF), skipping");
+        return true;
+    }
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto sparseFile = tempDir.getChildFile("sparse_bass.mid");
+    auto denseFile = tempDir.getChildFile("dense_bass.mid");
+    TestFramework::createTestMidiFileInTicks(sparseFile.getFullPathName(), 16);
+    
+    // Every note on every channel, struck on each of the first 24 ticks of
+    // beats 4 and 5: far more events in a block than were reserved for when
+    // the processor was prepared
+    const int notesPerTick = 16 * 128;
+    juce::MidiMessageSequence denseTrack;
+    
+    for (int beat = 4; beat < 6; ++beat)
+    {
+        for (int tick = beat * 480; tick < beat * 480 + 24; ++tick)
+        {
+            for (int i = 0; i < notesPerTick; ++i)
+                denseTrack.addEvent(juce::MidiMessage::noteOn(1 + i / 128, i % 128, (juce::uint8)100), tick);
+            
+            for (int i = 0; i < notesPerTick; ++i)
+                denseTrack.addEvent(juce::MidiMessage::noteOff(1 + i / 128, i % 128), tick + 1);
+        }
+    }
+    
+    denseTrack.updateMatchedPairs();
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(480);
+    midiFile.addTrack(denseTrack);
+    
+    {
+        juce::FileOutputStream stream(denseFile);
+        midiFile.writeTo(stream);
+    }
+    
+    processor->loadMidiFiles(sparseFile.getFullPathName(), "");
+    
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    int numAllocations = 0;
+    int numEvents = 0;
+    
+    // The new tracks take over at the bar line on beat 4, near block 172
+    for (int block = 0; block < 250; ++block)
+    {
+        // Published from this thread, which grows the buffers before the
+        // audio thread can see the new tracks
+        if (block == 20)
+            processor->loadMidiFiles(denseFile.getFullPathName(), "");
+        
+        createTestBuffers(audioBuffer, midiBuffer);
+        numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+        numEvents += midiBuffer.getNumEvents();
+        playHead.advance(512, 44100.0);
+    }
+    
+    TestFramework::assertTrue(numEvents > 24 * notesPerTick, "Dense tracks were rendered");
+    TestFramework::assertEqualInt(0, numAllocations, "Dense tracks do not allocate on the audio thread");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testNoteOffsOnStopAndSeek()
+{
+    DBG("Testing note-offs on stop and seek...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    // One half-beat note per beat: note 36 at beat 0, 37 at beat 1, ...
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("release_bass.mid");
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 8);
+    processor->loadMidiFiles(bassFile.getFullPathName(), "");
+    
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    int numAllocations = 0;
+    
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    TestFramework::assertEqualInt(1, midiBuffer.getNumEvents(), "First note starts");
+    playHead.advance(512, 44100.0);
+    
+    // Host jumps to beat 3 while note 36 is still sounding
+    playHead.ppqPosition = 3.0;
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    
+    juce::Array<juce::MidiMessage> messages;
+    for (const auto metadata : midiBuffer)
+        messages.add(metadata.getMessage());
+    
+    TestFramework::assertEqualInt(2, messages.size(), "Seek releases one note and starts one");
+    
+    if (messages.size() == 2)
+    {
+        TestFramework::assertTrue(messages[0].isNoteOff() && messages[0].getNoteNumber() == 36,
+                                  "Note sounding before the seek is released first");
+        TestFramework::assertTrue(messages[1].isNoteOn() && messages[1].getNoteNumber() == 39,
+                                  "Note at the new position starts");
+    }
+    
+    playHead.advance(512, 44100.0);
+    
+    // Stopping releases exactly the note that is sounding, nothing else
+    processor->stopPlayback();
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    
+    TestFramework::assertEqualInt(1, midiBuffer.getNumEvents(), "Stop sends a single note-off");
+    
+    for (const auto metadata : midiBuffer)
+    {
+        auto message = metadata.getMessage();
+        TestFramework::assertTrue(message.isNoteOff() && message.getNoteNumber() == 39 && metadata.samplePosition == 0,
+                                  "Note-off for the sounding note at the start of the block");
+    }
+    
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    TestFramework::assertTrue(midiBuffer.isEmpty(), "Nothing sent once stopped");
+    
+    TestFramework::assertEqualInt(0, numAllocations, "Releasing notes does not allocate");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testNoteChasingOnSeek()
+{
+    DBG("Testing note chasing on seek...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    // One half-beat note per beat: note 36 at beat 0, 37 at beat 1, ...
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("chase_bass.mid");
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 8);
+    processor->loadMidiFiles(bassFile.getFullPathName(), "");
+    
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    int numAllocations = 0;
+    
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    playHead.advance(512, 44100.0);
+    
+    // Host jumps into the middle of note 38 (beat 2 to 2.5)
+    playHead.ppqPosition = 2.25;
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    
+    juce::Array<juce::MidiMessage> messages;
+    juce::Array<int> positions;
+    
+    for (const auto metadata : midiBuffer)
+    {
+        messages.add(metadata.getMessage());
+        positions.add(metadata.samplePosition);
+    }
+    
+    TestFramework::assertEqualInt(2, messages.size(), "Seek releases the old note and chases the held one");
+    
+    if (messages.size() == 2)
+    {
+        TestFramework::assertTrue(messages[0].isNoteOff() && messages[0].getNoteNumber() == 36,
+                                  "Note sounding before the seek is released first");
+        TestFramework::assertTrue(messages[1].isNoteOn() && messages[1].getNoteNumber() == 38 && positions[1] == 0,
+                                  "Held note re-triggered at the start of the block");
+    }
+    
+    // Stopping releases the chased note
+    playHead.advance(512, 44100.0);
+    processor->stopPlayback();
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    
+    TestFramework::assertEqualInt(1, midiBuffer.getNumEvents(), "Chased note released on stop");
+    TestFramework::assertEqualInt(0, numAllocations, "Chasing notes does not allocate");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testHostLoopWrap()
+{
+    DBG("Testing host loop wrap...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    // One half-beat note per beat: note 36 at beat 0, 37 at beat 1, ...
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("loop_bass.mid");
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 8);
+    processor->loadMidiFiles(bassFile.getFullPathName(), "");
+    
+    const double sampleRate = 44100.0;
+    const double samplesPerBeat = sampleRate / 2.0;
+    
+    // Loop the first beat; the loop end falls 256 samples into the block
+    TestPlayHead playHead;
+    playHead.looping = true;
+    playHead.loopStart = 0.0;
+    playHead.loopEnd = 1.0;
+    playHead.ppqPosition = 1.0 - 256.0 / samplesPerBeat;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    int numAllocations = 0;
+    
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    
+    TestFramework::assertEqualInt(1, midiBuffer.getNumEvents(), "Only the loop start is played");
+    
+    for (const auto metadata : midiBuffer)
+    {
+        auto message = metadata.getMessage();
+        TestFramework::assertTrue(message.isNoteOn() && message.getNoteNumber() == 36 && metadata.samplePosition == 256,
+                                  "Loop start plays at the wrap sample, the note at the loop end does not");
+    }
+    
+    // The host's wrapped position continues the block without a jump
+    playHead.advance(512, sampleRate);
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    TestFramework::assertTrue(midiBuffer.isEmpty(), "Nothing repeated after the wrap");
+    
+    // A quarter-beat loop cuts note 36 short: every wrap releases it and
+    // starts it again, at the exact sample the loop ends
+    processor->stopPlayback();
+    playHead.ppqPosition = 0.0;
+    playHead.loopEnd = 0.25;
+    processor->startPlayback();
+    
+    const double samplesPerLoop = 0.25 * samplesPerBeat;
+    int numNoteOns = 0;
+    int numNoteOffs = 0;
+    bool wrapsOnTime = true;
+    
+    for (int block = 0; block < 40; ++block)
+    {
+        createTestBuffers(audioBuffer, midiBuffer);
+        numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+        playHead.advance(512, sampleRate);
+        
+        for (const auto metadata : midiBuffer)
+        {
+            auto message = metadata.getMessage();
+            
+            if (block == 0 && message.isNoteOff())
+                continue; // released by the stop above
+            
+            auto samplePosition = block * 512 + metadata.samplePosition;
+            auto expectedPosition = juce::roundToInt(numNoteOns * samplesPerLoop);
+            
+            if (message.isNoteOn())
+            {
+                wrapsOnTime &= message.getNoteNumber() == 36 && std::abs(samplePosition - expectedPosition) <= 1;
+                ++numNoteOns;
+            }
+            else
+            {
+                wrapsOnTime &= message.isNoteOff() && numNoteOffs == numNoteOns - 1;
+                ++numNoteOffs;
+            }
+        }
+    }
+    
+    // 40 blocks of 512 samples cover the loop start and three wraps
+    TestFramework::assertEqualInt(4, numNoteOns, "One note-on per loop pass");
+    TestFramework::assertEqualInt(3, numNoteOffs, "One note-off per wrap");
+    TestFramework::assertTrue(wrapsOnTime, "Wraps are sample accurate");
+    TestFramework::assertEqualInt(0, numAllocations, "Loop wraps do not allocate");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testInternalTransport()
+{
+    DBG("Testing internal transport...");
+    
+    // No playhead: the processor runs on its own clock
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    processor->startPlayback();
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    const int numBlocks = 2000;
+    
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        createTestBuffers(audioBuffer, midiBuffer);
+        processor->processBlock(audioBuffer, midiBuffer);
+    }
+    
+    // The position reported is the start of the last block, at 120 BPM
+    auto idealBeat = (numBlocks - 1) * 512 / 22050.0;
+    TestFramework::assertTrue(std::abs(processor->getCurrentBeat() - idealBeat) * 22050.0 < 1.0,
+                              "Internal clock within a sample, not quantised to beats");
+    
+    // Every note plays exactly once while the tempo glides to 240 BPM
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("transport_bass.mid");
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 8);
+    processor->loadMidiFiles(bassFile.getFullPathName(), "");
+    processor->startPlayback();
+    processor->setInternalTempo(240.0, 2.0);
+    
+    juce::Array<int> noteOns;
+    int numAllocations = 0;
+    
+    for (int block = 0; block < 2000 && processor->getCurrentBeat() < 7.9; ++block)
+    {
+        createTestBuffers(audioBuffer, midiBuffer);
+        numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+        
+        for (const auto metadata : midiBuffer)
+            if (metadata.getMessage().isNoteOn())
+                noteOns.add(metadata.getMessage().getNoteNumber());
+    }
+    
+    bool eachNoteOnce = noteOns.size() == 8;
+    
+    for (int i = 0; eachNoteOnce && i < noteOns.size(); ++i)
+        eachNoteOnce = noteOns[i] == 36 + i;
+    
+    TestFramework::assertTrue(eachNoteOnce, "Tempo ramp plays every note once, in order");
+    TestFramework::assertEqualInt(0, numAllocations, "Internal transport does not allocate");
+    
+    return true;
+}
+
+bool PluginProcessorTests::testPlaybackCommands()
+{
+    DBG("Testing playback commands...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    // One note per beat: 36 at beat 0, 37 at beat 1 and so on
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("commands_bass.mid");
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 8);
+    processor->loadMidiFiles(bassFile.getFullPathName(), "");
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    int numAllocations = 0;
+    
+    // New tracks restart playback, so let them go live first
+    createTestBuffers(audioBuffer, midiBuffer);
+    processor->processBlock(audioBuffer, midiBuffer);
+    
+    // Requests show up in the getters at once and reach the audio thread in
+    // order at the next block
+    processor->startPlayback();
+    processor->stopPlayback();
+    processor->startPlayback();
+    processor->setPlaybackPosition(2.0);
+    
+    TestFramework::assertTrue(processor->isPlaying(), "Last transport request is reported");
+    TestFramework::assertEqualDouble(2.0, processor->getCurrentBeat(), "Requested position is reported");
+    
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    
+    bool startsAtSeek = false;
+    
+    for (const auto metadata : midiBuffer)
+        if (metadata.getMessage().isNoteOn())
+            startsAtSeek = metadata.getMessage().getNoteNumber() == 38 && metadata.samplePosition == 0;
+    
+    TestFramework::assertTrue(startsAtSeek, "Playback starts at the seek position at the block start");
+    TestFramework::assertApproxEqual(2.0, processor->getCurrentBeat(), 1.0e-9, "Block starts at the seek position");
+    
+    // Stopping releases the held note at the start of the next block
+    processor->stopPlayback();
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    
+    bool releasedAtStart = midiBuffer.getNumEvents() == 1;
+    
+    for (const auto metadata : midiBuffer)
+        releasedAtStart &= metadata.getMessage().isNoteOff() && metadata.samplePosition == 0;
+    
+    TestFramework::assertTrue(releasedAtStart, "Stop releases the held note at the block start");
+    
+    // Requests lost to a full queue are caught up from the last requested
+    // state: a jump to beat 5 and a change to 90 BPM while playing
+    processor->startPlayback();
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    
+    for (int i = 0; i < CommandQueue::capacity; ++i)
+        processor->setTrackMuted(0, i % 2 == 0);
+    
+    processor->setPlaybackPosition(5.0);
+    processor->setInternalTempo(90.0);
+    
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    
+    bool resumesAtSeek = false;
+    
+    for (const auto metadata : midiBuffer)
+        if (metadata.getMessage().isNoteOn())
+            resumesAtSeek = metadata.getMessage().getNoteNumber() == 41 && metadata.samplePosition == 0;
+    
+    TestFramework::assertTrue(resumesAtSeek, "Lost seek is caught up");
+    
+    createTestBuffers(audioBuffer, midiBuffer);
+    numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+    TestFramework::assertApproxEqual(5.0 + 512 * 1.5 / 44100.0, processor->getCurrentBeat(), 1.0e-6,
+                                     "Lost tempo change is caught up");
+    
+    TestFramework::assertEqualInt(0, numAllocations, "Commands do not allocate on the audio thread");
+    
+    return true;
+}
+
+bool PluginProcessorTests::testTrackMixing()
+{
+    DBG("Testing track mixing...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    // The same part on bass and keys: note 36 over the first half beat
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto partFile = tempDir.getChildFile("mix_part.mid");
+    TestFramework::createTestMidiFileInTicks(partFile.getFullPathName(), 8);
+    
+    juce::StringArray trackFiles;
+    trackFiles.add(partFile.getFullPathName());
+    trackFiles.add("");
+    trackFiles.add(partFile.getFullPathName());
+    TestFramework::assertTrue(processor->loadTrackFiles(trackFiles), "Bass and keys loaded");
+    
+    // Channel and gain are baked into the tracks on a worker thread
+    processor->setTrackGain(TrackExchange::bassTrack, 0.5f);
+    processor->setTrackChannel(TrackExchange::keysTrack, 3);
+    TestFramework::assertTrue(processor->waitForTransforms(5000), "Channel and gain baked");
+    
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    juce::Array<juce::MidiMessage> messages;
+    int numAllocations = 0;
+    
+    auto processNextBlock = [&]
+    {
+        createTestBuffers(audioBuffer, midiBuffer);
+        numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+        playHead.advance(512, 44100.0);
+        
+        messages.clearQuick();
+        for (const auto metadata : midiBuffer)
+            messages.add(metadata.getMessage());
+    };
+    
+    processNextBlock();
+    TestFramework::assertEqualInt(2, messages.size(), "Both tracks start their note");
+    
+    if (messages.size() == 2)
+    {
+        TestFramework::assertTrue(messages[0].getChannel() == 1 && messages[0].getVelocity() == 50,
+                                  "Bass keeps its channel at half velocity");
+        TestFramework::assertTrue(messages[1].getChannel() == 3 && messages[1].getVelocity() == 100,
+                                  "Keys routed to channel 3");
+    }
+    
+    // A new gain only applies to new notes; the held ones carry on
+    processor->setTrackGain(TrackExchange::keysTrack, 0.8f);
+    processor->waitForTransforms(5000);
+    processNextBlock();
+    TestFramework::assertEqualInt(0, messages.size(), "Gain change keeps the held notes");
+    
+    // Muting releases the held note right away
+    processor->setTrackMuted(TrackExchange::keysTrack, true);
+    processNextBlock();
+    TestFramework::assertTrue(messages.size() == 1 && messages[0].isNoteOff() && messages[0].getChannel() == 3,
+                              "Mute releases the track's notes");
+    
+    // Soloing keys silences bass and brings the held keys note back
+    processor->setTrackMuted(TrackExchange::keysTrack, false);
+    processor->setTrackSoloed(TrackExchange::keysTrack, true);
+    processNextBlock();
+    TestFramework::assertEqualInt(2, messages.size(), "Solo swaps the audible tracks");
+    
+    if (messages.size() == 2)
+    {
+        TestFramework::assertTrue(messages[0].isNoteOff() && messages[0].getChannel() == 1, "Bass released by the solo");
+        TestFramework::assertTrue(messages[1].isNoteOn() && messages[1].getChannel() == 3, "Keys note chased on unmute");
+    }
+    
+    // Stopping releases what is left, on the routed channel
+    processor->stopPlayback();
+    processNextBlock();
+    TestFramework::assertTrue(messages.size() == 1 && messages[0].isNoteOff() && messages[0].getChannel() == 3,
+                              "Stop releases the soloed track");
+    TestFramework::assertEqualInt(0, numAllocations, "Mixing does not allocate");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testTrackTransforms()
+{
+    DBG("Testing track transforms...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    // One note per beat, each held for half a beat: 36 at beat 0, 37 at beat 1
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto bassFile = tempDir.getChildFile("transform_bass.mid");
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName(), 8);
+    processor->loadMidiFiles(bassFile.getFullPathName(), "");
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    juce::Array<juce::MidiMessage> messages;
+    int numAllocations = 0;
+    
+    auto processNextBlock = [&]
+    {
+        createTestBuffers(audioBuffer, midiBuffer);
+        numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+        
+        messages.clearQuick();
+        for (const auto metadata : midiBuffer)
+            messages.add(metadata.getMessage());
+    };
+    
+    // Play on the internal transport into the second note
+    processNextBlock();
+    processor->startPlayback();
+    
+    for (int block = 0; block < 1000 && processor->getCurrentBeat() < 1.2; ++block)
+        processNextBlock();
+    
+    // The bake runs on a worker thread; wait for it before the next block
+    EventTransform octaveUp;
+    octaveUp.transpose(12);
+    processor->setTrackTransform(TrackExchange::bassTrack, octaveUp);
+    TestFramework::assertTrue(processor->getTrackTransform(TrackExchange::bassTrack) == octaveUp, "Transform is reported");
+    TestFramework::assertTrue(processor->waitForTransforms(5000), "Transform baked");
+    
+    bool heldNoteReleased = false;
+    int firstTransposedNote = -1;
+    
+    for (int block = 0; block < 100 && firstTransposedNote < 0; ++block)
+    {
+        processNextBlock();
+        
+        for (const auto& message : messages)
+        {
+            heldNoteReleased |= message.isNoteOff() && message.getNoteNumber() == 37;
+            
+            if (message.isNoteOn() && message.getNoteNumber() >= 48 && firstTransposedNote < 0)
+                firstTransposedNote = message.getNoteNumber();
+        }
+    }
+    
+    TestFramework::assertTrue(heldNoteReleased, "Held note is released as it was played");
+    TestFramework::assertEqualInt(49, firstTransposedNote, "Held note is chased an octave up");
+    TestFramework::assertTrue(processor->getCurrentBeat() > 1.2, "Playback carries on without a restart");
+    TestFramework::assertEqualInt(0, numAllocations, "Swapping in the re-baked track does not allocate");
+    
+    processor->stopPlayback();
+    processNextBlock();
+    return true;
+}
+
+bool PluginProcessorTests::testBarHandoff()
+{
+    DBG("Testing bar-quantised handoff...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    TestFramework::assertEqualInt(1, processor->getHandoffBars(), "New tracks wait for the next bar line by default");
+    
+    // Both generations hold note 60 across the bar line at beat 4; only the
+    // old one holds 36 and only the new one 48. Notes 37 and 49 start on the
+    // bar line, 47 in the bar before it.
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto oldFile = tempDir.getChildFile("handoff_old.mid");
+    auto newFile = tempDir.getChildFile("handoff_new.mid");
+    writeTestNotes(oldFile, { { 60, 0.0, 8.0 }, { 36, 3.5, 4.5 }, { 37, 4.0, 4.5 } });
+    writeTestNotes(newFile, { { 47, 1.0, 2.0 }, { 60, 2.0, 6.0 }, { 48, 3.0, 5.0 }, { 49, 4.0, 4.5 } });
+    processor->loadMidiFiles(oldFile.getFullPathName(), "");
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    int numAllocations = 0;
+    
+    // Events with their position in beats, on the internal transport at 120 BPM
+    struct Event { juce::MidiMessage message; double beat; };
+    juce::Array<Event> events;
+    
+    auto processNextBlock = [&]
+    {
+        createTestBuffers(audioBuffer, midiBuffer);
+        numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+        
+        for (const auto metadata : midiBuffer)
+            events.add({ metadata.getMessage(), processor->getCurrentBeat() + metadata.samplePosition / 22050.0 });
+    };
+    
+    processNextBlock();
+    processor->startPlayback();
+    
+    // The new generation arrives during the second beat of the first bar
+    while (processor->getCurrentBeat() < 1.5)
+        processNextBlock();
+    
+    processor->loadMidiFiles(newFile.getFullPathName(), "");
+    events.clearQuick();
+    
+    while (processor->getCurrentBeat() < 5.0)
+        processNextBlock();
+    
+    auto find = [&](bool noteOn, int noteNumber) -> const Event*
+    {
+        for (const auto& event : events)
+            if ((noteOn ? event.message.isNoteOn() : event.message.isNoteOff()) && event.message.getNoteNumber() == noteNumber)
+                return &event;
+        
+        return nullptr;
+    };
+    
+    // The switch itself lands on the last sample before the bar line
+    auto onBarLine = [](const Event* event) { return event != nullptr && std::abs(event->beat - 4.0) * 22050.0 < 1.5; };
+    
+    TestFramework::assertTrue(find(true, 47) == nullptr, "New tracks carry on from the bar line, not from their start");
+    TestFramework::assertTrue(onBarLine(find(false, 36)), "Note only the old tracks hold is released on the bar line");
+    TestFramework::assertTrue(onBarLine(find(true, 48)), "Note only the new tracks hold is chased on the bar line");
+    TestFramework::assertTrue(onBarLine(find(true, 49)), "New note on the bar line plays");
+    TestFramework::assertTrue(find(true, 37) == nullptr, "Old note on the bar line does not");
+    TestFramework::assertTrue(find(true, 60) == nullptr && find(false, 60) == nullptr,
+                              "Note both generations hold carries on untouched");
+    TestFramework::assertEqualInt(0, numAllocations, "Handoff does not allocate");
+    
+    processor->stopPlayback();
+    processNextBlock();
+    return true;
+}
+
+bool PluginProcessorTests::testSharedTracks()
+{
+    DBG("Testing tracks shared between instances...");
+    
+    // Both instances are alive, so they hold the same process-wide cache
+    auto first = createTestProcessor();
+    auto second = createTestProcessor();
+    
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto partFile = tempDir.getChildFile("shared_part.mid");
+    auto copyFile = tempDir.getChildFile("shared_part_copy.mid");
+    TestFramework::assertTrue(writeTestNotes(partFile, { { 41, 0.0, 0.5 }, { 43, 1.0, 1.5 }, { 47, 2.0, 3.75 } }), "Part written");
+    TestFramework::assertTrue(writeTestNotes(copyFile, { { 41, 0.0, 0.5 }, { 43, 1.0, 1.5 }, { 47, 2.0, 3.75 } }), "Copy written");
+    
+    auto before = first->getTimelineCacheStatistics();
+    
+    TestFramework::assertTrue(first->loadMidiFiles(partFile.getFullPathName(), ""), "First instance loads the part");
+    TestFramework::assertTrue(second->loadMidiFiles(copyFile.getFullPathName(), partFile.getFullPathName()), "Second instance loads it twice");
+    
+    // Same content under another name is still the same track
+    auto after = second->getTimelineCacheStatistics();
+    TestFramework::assertEqualInt(before.misses + 1, after.misses, "Part parsed once");
+    TestFramework::assertEqualInt(before.hits + 2, after.hits, "Other loads served from the cache");
+    TestFramework::assertEqualInt(before.numEntries + 1, after.numEntries, "One entry for the part");
+    TestFramework::assertTrue(after.memoryUsage > before.memoryUsage, "Entry memory counted");
+    
+    // A file that does not parse fails the load and is not cached
+    auto brokenFile = tempDir.getChildFile("shared_broken.mid");
+    brokenFile.replaceWithText("not a MIDI file");
+    TestFramework::assertTrue(!first->loadMidiFiles(brokenFile.getFullPathName(), ""), "Broken file fails to load");
+    TestFramework::assertEqualInt(after.numEntries, first->getTimelineCacheStatistics().numEntries, "Broken file not cached");
+    
+    tempDir.deleteRecursively();
+    return true;
+}
+
+bool PluginProcessorTests::testOfflineRender()
+{
+    DBG("Testing offline rendering...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    TestPlayHead hostPlayHead;
+    hostPlayHead.playing = false;
+    processor->setPlayHead(&hostPlayHead);
+    
+    // The same part on bass and drums, notes 36, 37, 38... one per beat. The
+    // bass is an octave up and 10 ms early; drums are on channel 10.
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto partFile = tempDir.getChildFile("render_part.mid");
+    auto outputFile = tempDir.getChildFile("render_output.mid");
+    TestFramework::createTestMidiFileInTicks(partFile.getFullPathName(), 8);
+    processor->loadMidiFiles(partFile.getFullPathName(), partFile.getFullPathName());
+    processor->setTrackChannel(TrackExchange::drumTrack, 10);
+    processor->setTrackTimingOffset(TrackExchange::bassTrack, -10.0);
+    
+    EventTransform octaveUp;
+    octaveUp.transpose(12);
+    processor->setTrackTransform(TrackExchange::bassTrack, octaveUp);
+    
+    // Eight beats at 120 BPM over a loop of the first four
+    AIBandAudioProcessor::OfflineRenderOptions options;
+    options.sampleRate = 48000.0;
+    options.blockSize = 1024;
+    options.lengthInBeats = 8.0;
+    options.tempoBpm = 120.0;
+    options.loopStartBeat = 0.0;
+    options.loopEndBeat = 4.0;
+    
+    AIBandAudioProcessor::OfflineRenderStatistics statistics;
+    auto latency = processor->getLatencySamples();
+    
+    // The instance goes on playing through the render
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    processor->startPlayback();
+    createTestBuffers(audioBuffer, midiBuffer);
+    processor->processBlock(audioBuffer, midiBuffer);
+    auto beatBefore = processor->getCurrentBeat();
+    
+    TestFramework::assertTrue(processor->renderToMidiFile(outputFile.getFullPathName(), options, &statistics), "Render written");
+    TestFramework::assertTrue(statistics.renderedSeconds > 3.99 && statistics.renderedSeconds < 4.01, "Rendered length");
+    TestFramework::assertEqualInt(32, statistics.numEvents, "Note-on and note-off of 8 beats on 2 tracks");
+    TestFramework::assertTrue(statistics.getRealtimeFactor() > 1.0, "Faster than real time");
+    
+    // The host's setup was never touched
+    TestFramework::assertTrue(processor->getPlayHead() == &hostPlayHead, "Host playhead kept");
+    TestFramework::assertEqualInt(latency, processor->getLatencySamples(), "Latency kept");
+    TestFramework::assertTrue(processor->isPlaying(), "Playback carries on after the render");
+    TestFramework::assertTrue(processor->getCurrentBeat() == beatBefore, "Position kept through the render");
+    
+    MidiManager reader;
+    reader.initialize();
+    reader.prepareToPlay(48000.0, 1024);
+    MidiTimeline result;
+    TestFramework::assertTrue(reader.loadMidiFile(outputFile.getFullPathName(), result), "Render reads back");
+    
+    // Drums land on the beat, the bass 10 ms (9.6 ticks at 120 BPM) before it
+    // and on the loop repeat the first notes play again
+    bool drumsOnBeat = true, bassEarly = true;
+    int numNoteOns = 0;
+    
+    for (int i = 0; i < result.getNumEvents(); ++i)
+    {
+        const auto& event = result.getEvent(i);
+        const auto* data = result.getEventData(event);
+        
+        if ((data[0] & 0xf0) != 0x90 || data[2] == 0)
+            continue;
+        
+        auto beat = numNoteOns++ / 2;
+        auto tick = beat * result.getTicksPerQuarterNote();
+        auto expectedNote = 36 + beat % 4;
+        
+        if ((data[0] & 0x0f) == 9)
+            drumsOnBeat &= data[1] == expectedNote && std::abs(static_cast<juce::int64>(event.position) - tick) <= 1;
+        else
+            bassEarly &= data[1] == expectedNote + 12 && std::abs(static_cast<double>(event.position) - juce::jmax(0.0, tick - 9.6)) <= 1.0;
+    }
+    
+    TestFramework::assertEqualInt(16, numNoteOns, "Every note rendered once per pass");
+    TestFramework::assertTrue(drumsOnBeat, "Drums on the beat after latency compensation");
+    TestFramework::assertTrue(bassEarly, "Early, transposed bass");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
+bool PluginProcessorTests::testTimingOffsets()
+{
+    DBG("Testing timing offsets...");
+    
+    auto processor = createTestProcessor();
+    prepareProcessor(*processor);
+    
+    // The same part on bass and drums, one note per beat; drums on channel 10
+    auto tempDir = TestFramework::createTempTestDirectory();
+    auto partFile = tempDir.getChildFile("offset_part.mid");
+    TestFramework::createTestMidiFileInTicks(partFile.getFullPathName(), 8);
+    processor->loadMidiFiles(partFile.getFullPathName(), partFile.getFullPathName());
+    processor->setTrackChannel(TrackExchange::drumTrack, 10);
+    processor->waitForTransforms(5000);     // the channel is baked on a worker thread
+    
+    // Drums 8 ms early: that is the latency the host compensates, and the
+    // bass follows the host playhead 8 ms behind the drums
+    processor->setTrackTimingOffset(TrackExchange::drumTrack, -8.0);
+    const int delay = juce::roundToInt(0.008 * 44100.0);
+    TestFramework::assertEqualInt(delay, processor->getLatencySamples(), "Earliest offset reported as latency");
+    
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    juce::Array<juce::int64> bassNoteOns, drumNoteOns;
+    int numAllocations = 0;
+    
+    auto playBlocks = [&](int numBlocks)
+    {
+        bassNoteOns.clearQuick();
+        drumNoteOns.clearQuick();
+        
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            createTestBuffers(audioBuffer, midiBuffer);
+            numAllocations += processBlockCountingAllocations(*processor, audioBuffer, midiBuffer);
+            
+            for (const auto metadata : midiBuffer)
+            {
+                auto message = metadata.getMessage();
+                auto samplePosition = static_cast<juce::int64>(block) * 512 + metadata.samplePosition;
+                
+                if (message.isNoteOn())
+                    (message.getChannel() == 10 ? drumNoteOns : bassNoteOns).add(samplePosition);
+            }
+            
+            playHead.advance(512, 44100.0);
+        }
+    };
+    
+    auto followsDrums = [&]
+    {
+        bool follows = drumNoteOns.size() > 1 && bassNoteOns.size() == drumNoteOns.size();
+        
+        for (int i = 0; follows && i < drumNoteOns.size(); ++i)
+            follows = bassNoteOns[i] == drumNoteOns[i] + delay;
+        
+        return follows;
+    };
+    
+    // Three beats straight through
+    processor->startPlayback();
+    playBlocks(150);
+    
+    TestFramework::assertTrue(drumNoteOns.size() == 4 && drumNoteOns[1] == 22050,
+                              "Earliest track plays at the host playhead");
+    TestFramework::assertTrue(followsDrums(), "Bass delayed against the drums");
+    
+    // A one-beat loop: the bass takes each wrap at its own, later time and
+    // plays the end of the loop before it
+    processor->stopPlayback();
+    playHead.ppqPosition = 0.0;
+    playHead.looping = true;
+    playHead.loopStart = 0.0;
+    playHead.loopEnd = 1.0;
+    processor->startPlayback();
+    playBlocks(150);
+    
+    TestFramework::assertTrue(drumNoteOns.size() == 4 && drumNoteOns[3] == 3 * 22050, "Drums wrap with the host");
+    TestFramework::assertTrue(followsDrums(), "Bass wraps its delay later");
+    TestFramework::assertEqualInt(0, numAllocations, "Timing offsets do not allocate");
+    
+    // Offsets are kept with the plugin state
+    juce::MemoryBlock stateData;
+    processor->getStateInformation(stateData);
+    
+    auto restored = createTestProcessor();
+    prepareProcessor(*restored);
+    restored->setStateInformation(stateData.getData(), static_cast<int>(stateData.getSize()));
+    TestFramework::assertEqualInt(delay, restored->getLatencySamples(), "Offsets restored with the state");
+    
+    // Late-only offsets need no latency
+    processor->setTrackTimingOffset(TrackExchange::drumTrack, 0.0);
+    processor->setTrackTimingOffset(TrackExchange::bassTrack, 10.0);
+    TestFramework::assertEqualInt(0, processor->getLatencySamples(), "Late offsets add no latency");
+    
+    processor->setPlayHead(nullptr);
+    return true;
+}
+
 bool PluginProcessorTests::testFolderMonitoring()
 {
     DBG("Testing folder monitoring...");
@@ -262,23 +1447,31 @@ bool PluginProcessorTests::testFolderMonitoring()
     auto bassFile = tempDir.getChildFile("bass_test.mid");
     auto drumFile = tempDir.getChildFile("drum_test.mid");
     
-    TestFramework::createTestBassMidiFile(bassFile.getFullPathName());
+    TestFramework::createTestMidiFileInTicks(bassFile.getFullPathName());
     TestFramework::createTestDrumMidiFile(drumFile.getFullPathName());
     
-    // Process some blocks to trigger file checking
+    // Hold the host at the first beat so the first bass note is rendered
+    // as soon as the watcher thread has published the tracks
+    TestPlayHead playHead;
+    processor->setPlayHead(&playHead);
+    processor->startPlayback();
+    
     juce::AudioBuffer<float> audioBuffer;
     juce::MidiBuffer midiBuffer;
+    bool receivedNotes = false;
     
-    for (int i = 0; i < 20; ++i)  // Process enough blocks to trigger file check
+    for (int i = 0; i < 60 && !receivedNotes; ++i)  // Up to 3 seconds
     {
         createTestBuffers(audioBuffer, midiBuffer);
         processor->processBlock(audioBuffer, midiBuffer);
-        juce::Thread::sleep(50);  // Small delay to allow file system operations
+        receivedNotes = !midiBuffer.isEmpty();
+        juce::Thread::sleep(50);  // Give the watcher thread time to load
     }
     
-    // Files should have been detected and loaded (hard to test directly without exposing internals)
-    TestFramework::assertTrue(true, "Folder monitoring processes without errors");
+    TestFramework::assertTrue(receivedNotes, "Files loaded in the background are played");
+    TestFramework::assertTrue(processor->getReloadStatistics().performed >= 1, "Background reloads are counted");
     
+    processor->setPlayHead(nullptr);
     return true;
 }
 
@@ -324,10 +1517,51 @@ void PluginProcessorTests::prepareProcessor(AIBandAudioProcessor& processor)
     processor.prepareToPlay(44100.0, 512);
 }
 
+juce::Array<juce::int64> PluginProcessorTests::collectNoteOnSamples(AIBandAudioProcessor& processor,
+                                                                    TestPlayHead& playHead,
+                                                                    double sampleRate,
+                                                                    int numBlocks,
+                                                                    int blockSize)
+{
+    juce::Array<juce::int64> noteOnSamples;
+    juce::AudioBuffer<float> audioBuffer;
+    juce::MidiBuffer midiBuffer;
+    int numAllocations = 0;
+    
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        createTestBuffers(audioBuffer, midiBuffer, blockSize);
+        numAllocations += processBlockCountingAllocations(processor, audioBuffer, midiBuffer);
+        
+        for (const auto metadata : midiBuffer)
+        {
+            if (metadata.getMessage().isNoteOn())
+                noteOnSamples.add(playHead.timeInSamples + metadata.samplePosition);
+        }
+        
+        playHead.advance(blockSize, sampleRate);
+    }
+    
+    TestFramework::assertEqualInt(0, numAllocations, "No allocations while rendering");
+    return noteOnSamples;
+}
+
+int PluginProcessorTests::processBlockCountingAllocations(AIBandAudioProcessor& processor,
+                                                          juce::AudioBuffer<float>& audioBuffer,
+                                                          juce::MidiBuffer& midiBuffer)
+{
+    AllocationGuard guard("processBlock");
+    processor.processBlock(audioBuffer, midiBuffer);
+    return guard.getNumAllocations();
+}
+
 void PluginProcessorTests::createTestBuffers(juce::AudioBuffer<float>& audioBuffer, 
                                             juce::MidiBuffer& midiBuffer,
                                             int numSamples)
 {
     audioBuffer = TestFramework::createSilentAudioBuffer(2, numSamples);
     midiBuffer.clear();
+    
+    // Hosts hand plugins a pre-sized MIDI buffer; do the same here
+    midiBuffer.ensureSize(8192);
 }
@@ -2,6 +2,7 @@
 
 #include <JuceHeader.h>
 #include "TestFramework.h"
+#include "AllocationGuard.h"
 #include "../Source/PluginProcessor.h"
 
 //==============================================================================
@@ -58,6 +59,54 @@ public:
     
     /** Test MIDI event processing */
     static bool testMidiEventProcessing();
+    
+    /** Test that host tempo and sample rate changes need no reload */
+    static bool testTempoChangeWithoutReload();
+    
+    /** Test that processBlock never allocates after prepareToPlay */
+    static bool testRealtimeAllocations();
+    
+    /** Test that a host MIDI buffer without reserved space is not grown */
+    static bool testUnreservedHostBuffer();
+    
+    /** Test that two small host MIDI buffers used in turn are not grown */
+    static bool testAlternatingHostBuffers();
+    
+    /** Test that tracks denser than the reserved buffers load while playing without allocating */
+    static bool testDenseTracksWhilePlaying();
+    
+    /** Test exact note-offs when playback stops or the playhead jumps */
+    static bool testNoteOffsOnStopAndSeek();
+    
+    /** Test that a seek into a held bass note re-triggers it */
+    static bool testNoteChasingOnSeek();
+    
+    /** Test wrapping at a host loop end that falls inside a block */
+    static bool testHostLoopWrap();
+    
+    /** Test the internal transport without a host playhead */
+    static bool testInternalTransport();
+    
+    /** Test that playback controls reach the audio thread in order at a block start */
+    static bool testPlaybackCommands();
+    
+    /** Test per-track timing offsets and the latency they report */
+    static bool testTimingOffsets();
+    
+    /** Test per-track channel routing, gain, mute and solo */
+    static bool testTrackMixing();
+    
+    /** Test that a changed track transform is swapped in without a restart */
+    static bool testTrackTransforms();
+    
+    /** Test that new tracks loaded while playing take over at the next bar line */
+    static bool testBarHandoff();
+    
+    /** Test rendering the tracks to a MIDI file with a simulated playhead */
+    static bool testOfflineRender();
+    
+    /** Test that instances loading the same file share one parsed track */
+    static bool testSharedTracks();
 
 private:
     //==============================================================================
@@ -67,6 +116,23 @@ private:
     /** Helper method to prepare processor for testing */
     static void prepareProcessor(AIBandAudioProcessor& processor);
     
+    /** Helper method to play blocks from a host playhead and collect
+        the absolute sample positions of all note-on events
+    */
+    static juce::Array<juce::int64> collectNoteOnSamples(AIBandAudioProcessor& processor,
+                                                         TestPlayHead& playHead,
+                                                         double sampleRate,
+                                                         int numBlocks,
+                                                         int blockSize = 512);
+    
+    /** Helper method to run one block under an AllocationGuard, which fails
+        the test on any allocation, and return how many it made (always 0
+        unless the tests are built with allocation detection)
+    */
+    static int processBlockCountingAllocations(AIBandAudioProcessor& processor,
+                                               juce::AudioBuffer<float>& audioBuffer,
+                                               juce::MidiBuffer& midiBuffer);
+    
     /** Helper method to create test audio and MIDI buffers */
     static void createTestBuffers(juce::AudioBuffer<float>& audioBuffer, 
                                  juce::MidiBuffer& midiBuffer,
@@ -0,0 +1,191 @@
+#include "TempoMapTests.h"
+
+//==============================================================================
+TempoMapTests::TempoMapTests()
+{
+}
+
+TempoMapTests::~TempoMapTests()
+{
+}
+
+//==============================================================================
+bool TempoMapTests::runAllTests()
+{
+    DBG("=== Running TempoMap Tests ===");
+
+    bool allPassed = true;
+
+    allPassed &= testConstantTempo();
+    allPassed &= testTempoChanges();
+    allPassed &= testCursorLookups();
+    allPassed &= testMidiFileTempoMap();
+    allPassed &= testBarLines();
+
+    DBG("=== TempoMap Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool TempoMapTests::testConstantTempo()
+{
+    DBG("Testing constant tempo conversions...");
+
+    TempoMap defaultMap;
+    TestFramework::assertTrue(defaultMap.isConstant(), "Default map has one segment");
+    TestFramework::assertApproxEqual(120.0, defaultMap.getTempoAt(10.0), 1.0e-9, "Default tempo is 120 BPM");
+    TestFramework::assertApproxEqual(0.5, defaultMap.beatsToSeconds(1.0), 1.0e-9, "One beat at 120 BPM");
+
+    TempoMap map(90.0, 960);
+    TestFramework::assertApproxEqual(2.0, map.beatsToSeconds(3.0), 1.0e-9, "Three beats at 90 BPM");
+    TestFramework::assertApproxEqual(3.0, map.secondsToBeats(2.0), 1.0e-9, "Two seconds at 90 BPM");
+    TestFramework::assertApproxEqual(2.0, map.ticksToSeconds(3.0 * 960), 1.0e-9, "Ticks to seconds");
+    TestFramework::assertApproxEqual(2880.0, map.secondsToTicks(2.0), 1.0e-6, "Seconds to ticks");
+    TestFramework::assertApproxEqual(88200.0, map.beatsToSamples(3.0, 44100.0), 1.0e-6, "Beats to samples");
+    TestFramework::assertApproxEqual(3.0, map.samplesToBeats(88200.0, 44100.0), 1.0e-9, "Samples to beats");
+
+    return true;
+}
+
+bool TempoMapTests::testTempoChanges()
+{
+    DBG("Testing tempo changes...");
+
+    // 120 BPM for 4 beats (2 s), 60 BPM for 2 beats (2 s), then 240 BPM.
+    // Given out of order, with a change that is overridden at the same beat
+    // and one that repeats the tempo in force
+    TempoMap map({ { 6.0, 240.0 }, { 4.0, 90.0 }, { 4.0, 60.0 }, { 1.0, 120.0 } }, 480);
+
+    TestFramework::assertEqualInt(3, map.getNumSegments(), "Repeated tempo adds no segment");
+    TestFramework::assertApproxEqual(60.0, map.getTempoAt(4.0), 1.0e-9, "Last change at a position wins");
+    TestFramework::assertApproxEqual(2.0, map.getSegment(1).startSeconds, 1.0e-9, "Second segment start time");
+    TestFramework::assertApproxEqual(4.0, map.getSegment(2).startSeconds, 1.0e-9, "Third segment start time");
+
+    TestFramework::assertApproxEqual(1.5, map.beatsToSeconds(3.0), 1.0e-9, "Before the first change");
+    TestFramework::assertApproxEqual(3.0, map.beatsToSeconds(5.0), 1.0e-9, "Inside the slow segment");
+    TestFramework::assertApproxEqual(4.5, map.beatsToSeconds(8.0), 1.0e-9, "After the last change");
+    TestFramework::assertApproxEqual(5.0, map.secondsToBeats(3.0), 1.0e-9, "Seconds back to beats");
+    TestFramework::assertApproxEqual(8.0, map.secondsToBeats(4.5), 1.0e-9, "Seconds back to beats after the last change");
+    TestFramework::assertApproxEqual(3.0, map.ticksToSeconds(5.0 * 480), 1.0e-9, "Ticks across changes");
+
+    // Positions before the start extend the first tempo
+    TestFramework::assertApproxEqual(-0.5, map.beatsToSeconds(-1.0), 1.0e-9, "Negative beats");
+
+    // Invalid tempos are ignored
+    TempoMap invalid({ { 2.0, 0.0 }, { 3.0, -10.0 } }, 480);
+    TestFramework::assertTrue(invalid.isConstant(), "Invalid tempos are ignored");
+
+    return true;
+}
+
+bool TempoMapTests::testCursorLookups()
+{
+    DBG("Testing cursor lookups...");
+
+    // A map with many changes, so the cursor has real work to do
+    std::vector<TempoMap::TempoChange> changes;
+    juce::Random random(7);
+
+    for (int i = 0; i < 200; ++i)
+        changes.push_back({ i * 0.75, 60.0 + random.nextInt(120) });
+
+    TempoMap map(changes, 960);
+
+    // Playback: small forward steps, as the audio thread makes them
+    TempoMap::Cursor cursor;
+    int mismatches = 0;
+
+    for (double beat = 0.0; beat < 160.0; beat += 0.0117)
+    {
+        if (map.beatsToSeconds(beat, cursor) != map.beatsToSeconds(beat))
+            ++mismatches;
+
+        auto seconds = map.beatsToSeconds(beat);
+        if (map.secondsToBeats(seconds, cursor) != map.secondsToBeats(seconds))
+            ++mismatches;
+    }
+
+    TestFramework::assertEqualInt(0, mismatches, "Cursor matches binary search while playing");
+
+    // Seeks: random positions in both directions, including outside the map
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto beat = random.nextDouble() * 200.0 - 10.0;
+
+        if (map.getTempoAt(beat, cursor) != map.getTempoAt(beat))
+            ++mismatches;
+    }
+
+    TestFramework::assertEqualInt(0, mismatches, "Cursor matches binary search after seeks");
+
+    // A cursor left far into one map is still correct with a shorter one
+    TempoMap shortMap({ { 1.0, 60.0 } }, 960);
+    TestFramework::assertApproxEqual(0.25, shortMap.beatsToSeconds(0.5, cursor), 1.0e-9, "Cursor reused with another map");
+
+    return true;
+}
+
+bool TempoMapTests::testMidiFileTempoMap()
+{
+    DBG("Testing tempo maps from MIDI files...");
+
+    // Type 1 layout: tempo events in track 0, notes in track 1
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(480);
+
+    juce::MidiMessageSequence tempoTrack;
+    tempoTrack.addEvent(juce::MidiMessage::tempoMetaEvent(500000), 0.0);        // 120 BPM
+    tempoTrack.addEvent(juce::MidiMessage::tempoMetaEvent(1000000), 4.0 * 480); // 60 BPM from beat 4
+
+    juce::MidiMessageSequence noteTrack;
+    noteTrack.addEvent(juce::MidiMessage::noteOn(1, 36, (juce::uint8)100), 5.0 * 480);
+
+    midiFile.addTrack(tempoTrack);
+    midiFile.addTrack(noteTrack);
+
+    auto map = TempoMap::createFromMidiFile(midiFile);
+    TestFramework::assertEqualInt(480, map->getTicksPerQuarterNote(), "Map keeps the file resolution");
+    TestFramework::assertEqualInt(2, map->getNumSegments(), "Tempo events of the tempo track");
+    TestFramework::assertApproxEqual(3.0, map->ticksToSeconds(5.0 * 480), 1.0e-9, "Note track timed by the tempo track");
+
+    return true;
+}
+
+bool TempoMapTests::testBarLines()
+{
+    DBG("Testing bar lines...");
+
+    TempoMap defaultMap;
+    TestFramework::assertEqualInt(4, defaultMap.getMeterAt(10.0).numerator, "Default time signature is 4/4");
+    TestFramework::assertApproxEqual(0.0, defaultMap.getNextBarLine(0.0), 1.0e-9, "A bar line at the position counts");
+    TestFramework::assertApproxEqual(4.0, defaultMap.getNextBarLine(0.5), 1.0e-9, "Next bar line");
+    TestFramework::assertApproxEqual(8.0, defaultMap.getNextBarLine(0.5, 2), 1.0e-9, "Second bar line");
+    TestFramework::assertApproxEqual(1.5, defaultMap.beatsToBars(6.0), 1.0e-9, "Beats to bars");
+
+    // Two bars of 4/4, 3/4 from beat 8, and 6/8 in the middle of the bar
+    // starting at beat 14, which cuts that bar short. Given out of order.
+    TempoMap map({}, 480, { { 15.5, 6, 8 }, { 8.0, 3, 4 }, { 0.0, 4, 4 } });
+
+    TestFramework::assertEqualInt(3, map.getMeterAt(12.0).numerator, "3/4 section");
+    TestFramework::assertApproxEqual(11.0, map.getNextBarLine(9.0), 1.0e-9, "Bar line in 3/4");
+    TestFramework::assertApproxEqual(15.5, map.getNextBarLine(14.5), 1.0e-9, "Change mid-bar starts a bar");
+    TestFramework::assertApproxEqual(15.5, map.getNextBarLine(9.0, 3), 1.0e-9, "Counting bars across changes");
+    TestFramework::assertApproxEqual(6.0, map.beatsToBars(18.5), 1.0e-9, "Bars after the changes");
+    TestFramework::assertApproxEqual(18.5, map.barsToBeats(6.0), 1.0e-9, "Bars back to beats");
+
+    TempoMap invalid({}, 480, { { 4.0, 3, 5 }, { 4.0, 0, 4 } });
+    TestFramework::assertEqualInt(4, invalid.getMeterAt(5.0).numerator, "Invalid time signatures are ignored");
+
+    // Time signature events of a file
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(480);
+
+    juce::MidiMessageSequence sequence;
+    sequence.addEvent(juce::MidiMessage::timeSignatureMetaEvent(3, 4), 4.0 * 480);
+    midiFile.addTrack(sequence);
+
+    auto fromFile = TempoMap::createFromMidiFile(midiFile);
+    TestFramework::assertApproxEqual(7.0, fromFile->getNextBarLine(5.0), 1.0e-9, "Time signature from a file");
+
+    return true;
+}
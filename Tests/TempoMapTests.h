@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/TempoMap.h"
+
+//==============================================================================
+/**
+    Unit Tests for TempoMap class
+
+    Tests the tempo map including:
+    - Conversions at a constant tempo
+    - Cumulative times across tempo changes, in both directions
+    - Cursor lookups against binary search, in playback and random order
+    - Building a map from the tempo events of a MIDI file
+    - Bar lines across time signature changes
+*/
+class TempoMapTests
+{
+public:
+    //==============================================================================
+    TempoMapTests();
+    ~TempoMapTests();
+
+    //==============================================================================
+    /** Run all TempoMap tests */
+    static bool runAllTests();
+
+    //==============================================================================
+    // Individual Test Methods
+
+    /** Test conversions of a map with one tempo */
+    static bool testConstantTempo();
+
+    /** Test conversions across tempo changes */
+    static bool testTempoChanges();
+
+    /** Test that cursor lookups match random access lookups */
+    static bool testCursorLookups();
+
+    /** Test building a map from a MIDI file */
+    static bool testMidiFileTempoMap();
+
+    /** Test bar positions and bar lines across time signature changes */
+    static bool testBarLines();
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TempoMapTests)
+};
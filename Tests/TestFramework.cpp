@@ -36,13 +36,17 @@ void TestFramework::cleanup()
 
 juce::File TestFramework::createTempTestDirectory()
 {
-    auto tempDir = juce::File::getSpecialLocation(juce::File::tempDirectory)
+    auto testDir = juce::File::getSpecialLocation(juce::File::tempDirectory)
                    .getChildFile("AIBandPluginTests")
                    .getChildFile(juce::Uuid().toString());
     
+    // Files go one level down, so folders created next to them (such as
+    // compiled track caches) are cleaned up with them
+    auto tempDir = testDir.getChildFile("files");
+    
     if (tempDir.createDirectory())
     {
-        tempFilesToCleanup.add(tempDir);
+        tempFilesToCleanup.add(testDir);
         return tempDir;
     }
     
@@ -167,6 +171,42 @@ bool TestFramework::createTestDrumMidiFile(const juce::String& filePath, double
     return !stream.getStatus().failed();
 }
 
+bool TestFramework::createTestMidiFileInTicks(const juce::String& filePath, int numBeats, int ticksPerQuarterNote, int tempo)
+{
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(ticksPerQuarterNote);
+    
+    juce::MidiMessageSequence track;
+    
+    // Timestamps in a MidiMessageSequence are written to the file as ticks
+    track.addEvent(juce::MidiMessage::tempoMetaEvent(60000000 / tempo), 0.0);
+    
+    for (int beat = 0; beat < numBeats; ++beat)
+    {
+        double tick = static_cast<double>(beat * ticksPerQuarterNote);
+        track.addEvent(juce::MidiMessage::noteOn(1, 36 + beat % 12, (juce::uint8)100), tick);
+        track.addEvent(juce::MidiMessage::noteOff(1, 36 + beat % 12), tick + ticksPerQuarterNote / 2);
+    }
+    
+    track.updateMatchedPairs();
+    midiFile.addTrack(track);
+    
+    juce::File file(filePath);
+    juce::FileOutputStream stream(file);
+    
+    if (stream.failedToOpen())
+        return false;
+    
+    // Replace any previous content (FileOutputStream appends by default)
+    stream.setPosition(0);
+    stream.truncate();
+    
+    midiFile.writeTo(stream);
+    tempFilesToCleanup.add(file);
+    
+    return !stream.getStatus().failed();
+}
+
 bool TestFramework::createInvalidMidiFile(const juce::String& filePath)
 {
     juce::File file(filePath);
@@ -2,6 +2,47 @@
 
 #include <JuceHeader.h>
 
+//==============================================================================
+/**
+    Controllable host playhead for tests
+    
+    Lets tests drive the processor with a specific tempo, position and loop
+    region, and advance the position block by block like a host would.
+*/
+class TestPlayHead : public juce::AudioPlayHead
+{
+public:
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo info;
+        info.setIsPlaying(playing);
+        info.setBpm(bpm);
+        info.setPpqPosition(ppqPosition);
+        info.setTimeInSamples(timeInSamples);
+        info.setIsLooping(looping);
+        info.setLoopPoints(juce::AudioPlayHead::LoopPoints { loopStart, loopEnd });
+        return info;
+    }
+    
+    /** Move the playhead forward by one block, wrapping at the loop end like a host */
+    void advance(int numSamples, double sampleRate)
+    {
+        ppqPosition += numSamples / sampleRate * (bpm / 60.0);
+        timeInSamples += numSamples;
+        
+        if (looping && loopEnd > loopStart && ppqPosition >= loopEnd)
+            ppqPosition = loopStart + std::fmod(ppqPosition - loopStart, loopEnd - loopStart);
+    }
+    
+    double bpm = 120.0;
+    double ppqPosition = 0.0;
+    juce::int64 timeInSamples = 0;
+    bool playing = true;
+    bool looping = false;
+    double loopStart = 0.0;
+    double loopEnd = 0.0;
+};
+
 //==============================================================================
 /**
     Test Framework for AI Band Plugin
@@ -44,6 +85,14 @@ public:
                                       double durationInBeats = 8.0,
                                       int tempo = 120);
     
+    /** Create a MIDI file with one note per beat at exact tick positions
+        (note on at beat * ticksPerQuarterNote, note off half a beat later)
+    */
+    static bool createTestMidiFileInTicks(const juce::String& filePath,
+                                          int numBeats = 8,
+                                          int ticksPerQuarterNote = 480,
+                                          int tempo = 120);
+    
     /** Create an invalid MIDI file for error testing */
     static bool createInvalidMidiFile(const juce::String& filePath);
     
@@ -22,7 +22,17 @@ bool TestRunner::runAllTests()
     bool allTestsPassed = true;
     
     // Run all test suites
+    allTestsPassed &= runCommandQueueTests();
+    allTestsPassed &= runEventTransformTests();
+    allTestsPassed &= runMidiFileParserTests();
     allTestsPassed &= runMidiManagerTests();
+    allTestsPassed &= runMidiTimelineTests();
+    allTestsPassed &= runMidiFolderWatcherTests();
+    allTestsPassed &= runTimelineCacheTests();
+    allTestsPassed &= runCompiledTrackCacheTests();
+    allTestsPassed &= runTrackExchangeTests();
+    allTestsPassed &= runTempoMapTests();
+    allTestsPassed &= runTransportClockTests();
     allTestsPassed &= runPluginProcessorTests();
     allTestsPassed &= runIntegrationTests();
     
@@ -53,10 +63,50 @@ bool TestRunner::runTestSuite(const juce::String& suiteName)
     
     bool result = false;
     
-    if (suiteName == "MidiManager")
+    if (suiteName == "CommandQueue")
+    {
+        result = runCommandQueueTests();
+    }
+    else if (suiteName == "EventTransform")
+    {
+        result = runEventTransformTests();
+    }
+    else if (suiteName == "MidiFileParser")
+    {
+        result = runMidiFileParserTests();
+    }
+    else if (suiteName == "MidiManager")
     {
         result = runMidiManagerTests();
     }
+    else if (suiteName == "MidiTimeline")
+    {
+        result = runMidiTimelineTests();
+    }
+    else if (suiteName == "MidiFolderWatcher")
+    {
+        result = runMidiFolderWatcherTests();
+    }
+    else if (suiteName == "TimelineCache")
+    {
+        result = runTimelineCacheTests();
+    }
+    else if (suiteName == "CompiledTrackCache")
+    {
+        result = runCompiledTrackCacheTests();
+    }
+    else if (suiteName == "TrackExchange")
+    {
+        result = runTrackExchangeTests();
+    }
+    else if (suiteName == "TempoMap")
+    {
+        result = runTempoMapTests();
+    }
+    else if (suiteName == "TransportClock")
+    {
+        result = runTransportClockTests();
+    }
     else if (suiteName == "PluginProcessor")
     {
         result = runPluginProcessorTests();
@@ -65,6 +115,10 @@ bool TestRunner::runTestSuite(const juce::String& suiteName)
     {
         result = runIntegrationTests();
     }
+    else if (suiteName == "Performance")
+    {
+        result = runPerformanceBenchmarks();
+    }
     else
     {
         DBG("Unknown test suite: " << suiteName);
@@ -79,7 +133,7 @@ bool TestRunner::runTestSuite(const juce::String& suiteName)
 
 juce::StringArray TestRunner::getAvailableTestSuites()
 {
-    return {"MidiManager", "PluginProcessor", "Integration"};
+    return {"CommandQueue", "EventTransform", "MidiFileParser", "MidiManager", "MidiTimeline", "MidiFolderWatcher", "TimelineCache", "CompiledTrackCache", "TrackExchange", "TempoMap", "TransportClock", "PluginProcessor", "Integration", "Performance"};
 }
 
 juce::String TestRunner::runTestsWithReport()
@@ -109,6 +163,33 @@ juce::String TestRunner::runTestsWithReport()
 //==============================================================================
 // Test Suite Runners
 
+bool TestRunner::runCommandQueueTests()
+{
+    DBG("");
+    DBG("Running CommandQueue Test Suite...");
+    DBG("==================================");
+    
+    return CommandQueueTests::runAllTests();
+}
+
+bool TestRunner::runEventTransformTests()
+{
+    DBG("");
+    DBG("Running EventTransform Test Suite...");
+    DBG("====================================");
+    
+    return EventTransformTests::runAllTests();
+}
+
+bool TestRunner::runMidiFileParserTests()
+{
+    DBG("");
+    DBG("Running MidiFileParser Test Suite...");
+    DBG("====================================");
+    
+    return MidiFileParserTests::runAllTests();
+}
+
 bool TestRunner::runMidiManagerTests()
 {
     DBG("");
@@ -118,6 +199,69 @@ bool TestRunner::runMidiManagerTests()
     return MidiManagerTests::runAllTests();
 }
 
+bool TestRunner::runMidiTimelineTests()
+{
+    DBG("");
+    DBG("Running MidiTimeline Test Suite...");
+    DBG("==================================");
+    
+    return MidiTimelineTests::runAllTests();
+}
+
+bool TestRunner::runMidiFolderWatcherTests()
+{
+    DBG("");
+    DBG("Running MidiFolderWatcher Test Suite...");
+    DBG("=======================================");
+    
+    return MidiFolderWatcherTests::runAllTests();
+}
+
+bool TestRunner::runTimelineCacheTests()
+{
+    DBG("");
+    DBG("Running TimelineCache Test Suite...");
+    DBG("===================================");
+    
+    return TimelineCacheTests::runAllTests();
+}
+
+bool TestRunner::runCompiledTrackCacheTests()
+{
+    DBG("");
+    DBG("Running CompiledTrackCache Test Suite...");
+    DBG("========================================");
+    
+    return CompiledTrackCacheTests::runAllTests();
+}
+
+bool TestRunner::runTrackExchangeTests()
+{
+    DBG("");
+    DBG("Running TrackExchange Test Suite...");
+    DBG("===================================");
+    
+    return TrackExchangeTests::runAllTests();
+}
+
+bool TestRunner::runTempoMapTests()
+{
+    DBG("");
+    DBG("Running TempoMap Test Suite...");
+    DBG("==============================");
+    
+    return TempoMapTests::runAllTests();
+}
+
+bool TestRunner::runTransportClockTests()
+{
+    DBG("");
+    DBG("Running TransportClock Test Suite...");
+    DBG("====================================");
+    
+    return TransportClockTests::runAllTests();
+}
+
 bool TestRunner::runPluginProcessorTests()
 {
     DBG("");
@@ -142,6 +286,15 @@ bool TestRunner::runIntegrationTests()
     return allPassed;
 }
 
+bool TestRunner::runPerformanceBenchmarks()
+{
+    DBG("");
+    DBG("Running Performance Benchmarks...");
+    DBG("=================================");
+    
+    return PerformanceBenchmarks::runAllBenchmarks();
+}
+
 //==============================================================================
 // Integration Tests
 
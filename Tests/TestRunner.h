@@ -2,8 +2,19 @@
 
 #include <JuceHeader.h>
 #include "TestFramework.h"
+#include "CommandQueueTests.h"
+#include "CompiledTrackCacheTests.h"
+#include "EventTransformTests.h"
+#include "MidiFileParserTests.h"
+#include "MidiFolderWatcherTests.h"
 #include "MidiManagerTests.h"
+#include "MidiTimelineTests.h"
 #include "PluginProcessorTests.h"
+#include "TempoMapTests.h"
+#include "TimelineCacheTests.h"
+#include "TrackExchangeTests.h"
+#include "TransportClockTests.h"
+#include "PerformanceBenchmarks.h"
 
 //==============================================================================
 /**
@@ -36,9 +47,20 @@ public:
 private:
     //==============================================================================
     /** Run individual test suites */
+    static bool runCommandQueueTests();
+    static bool runEventTransformTests();
+    static bool runMidiFileParserTests();
     static bool runMidiManagerTests();
+    static bool runMidiTimelineTests();
+    static bool runMidiFolderWatcherTests();
+    static bool runTimelineCacheTests();
+    static bool runCompiledTrackCacheTests();
+    static bool runTrackExchangeTests();
+    static bool runTempoMapTests();
+    static bool runTransportClockTests();
     static bool runPluginProcessorTests();
     static bool runIntegrationTests();
+    static bool runPerformanceBenchmarks();
     
     /** Run integration tests that test component interaction */
     static bool testMidiManagerIntegration();
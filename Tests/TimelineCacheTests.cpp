@@ -0,0 +1,199 @@
+#include "TimelineCacheTests.h"
+
+namespace
+{
+    /** Build the content of a single-track MIDI file, one note per beat */
+    juce::MemoryBlock createMidiData(int numNotes, int noteNumber)
+    {
+        juce::MidiMessageSequence track;
+
+        for (int i = 0; i < numNotes; ++i)
+        {
+            track.addEvent(juce::MidiMessage::noteOn(1, noteNumber, (juce::uint8)100), i * 480.0);
+            track.addEvent(juce::MidiMessage::noteOff(1, noteNumber), i * 480.0 + 240.0);
+        }
+
+        track.updateMatchedPairs();
+
+        juce::MidiFile midiFile;
+        midiFile.setTicksPerQuarterNote(480);
+        midiFile.addTrack(track);
+
+        juce::MemoryBlock data;
+
+        {
+            juce::MemoryOutputStream stream(data, false);
+            midiFile.writeTo(stream);
+        }
+
+        return data;
+    }
+
+    std::shared_ptr<const MidiTimeline> getTimeline(TimelineCache& cache, const juce::MemoryBlock& data)
+    {
+        MidiManager midiManager;
+        return cache.getTimeline(data.getData(), data.getSize(), midiManager);
+    }
+}
+
+//==============================================================================
+TimelineCacheTests::TimelineCacheTests()
+{
+}
+
+TimelineCacheTests::~TimelineCacheTests()
+{
+}
+
+//==============================================================================
+bool TimelineCacheTests::runAllTests()
+{
+    DBG("=== Running TimelineCache Tests ===");
+
+    bool allPassed = true;
+
+    allPassed &= testSharing();
+    allPassed &= testEviction();
+    allPassed &= testInUseEntries();
+    allPassed &= testMemoryAccounting();
+    allPassed &= testInvalidData();
+
+    DBG("=== TimelineCache Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool TimelineCacheTests::testSharing()
+{
+    DBG("Testing shared timelines...");
+
+    TimelineCache cache;
+    auto data = createMidiData(8, 36);
+    auto copy = data;
+
+    auto first = getTimeline(cache, data);
+    TestFramework::assertTrue(first != nullptr, "Data parsed");
+    TestFramework::assertEqualInt(16, first != nullptr ? first->getNumEvents() : 0, "Note-ons and note-offs compiled");
+
+    // A separate copy of the same bytes is the same file
+    auto second = getTimeline(cache, copy);
+    TestFramework::assertTrue(first == second, "Identical content shares one timeline");
+
+    auto other = getTimeline(cache, createMidiData(8, 38));
+    TestFramework::assertTrue(other != nullptr && other != first, "Different content gets its own timeline");
+
+    auto statistics = cache.getStatistics();
+    TestFramework::assertEqualInt(2, statistics.numEntries, "Two distinct files cached");
+    TestFramework::assertEqualInt(1, statistics.hits, "Second lookup hit");
+    TestFramework::assertEqualInt(2, statistics.misses, "Each distinct file parsed once");
+    TestFramework::assertEqualInt(0, statistics.evictions, "Nothing evicted under the limit");
+
+    return true;
+}
+
+bool TimelineCacheTests::testEviction()
+{
+    DBG("Testing least recently used eviction...");
+
+    TimelineCache cache;
+    auto a = createMidiData(16, 36);
+    auto b = createMidiData(16, 38);
+    auto c = createMidiData(16, 42);
+
+    // Same note count, so every entry takes the same memory; room for two.
+    // No timeline is kept, so each one can be evicted as soon as it is returned.
+    getTimeline(cache, a);
+    auto entrySize = cache.getStatistics().memoryUsage;
+    cache.setMemoryLimit(entrySize * 2);
+
+    getTimeline(cache, b);
+    getTimeline(cache, a);      // b is now the least recently used
+    getTimeline(cache, c);
+
+    auto statistics = cache.getStatistics();
+    TestFramework::assertEqualInt(2, statistics.numEntries, "Limit keeps two entries");
+    TestFramework::assertEqualInt(1, statistics.evictions, "One entry evicted");
+    TestFramework::assertTrue(statistics.memoryUsage <= statistics.memoryLimit, "Memory back under the limit");
+
+    getTimeline(cache, a);
+    TestFramework::assertEqualInt(statistics.hits + 1, cache.getStatistics().hits, "Recently used entry kept");
+
+    getTimeline(cache, b);
+    TestFramework::assertEqualInt(statistics.misses + 1, cache.getStatistics().misses, "Least recently used entry evicted");
+
+    return true;
+}
+
+bool TimelineCacheTests::testInUseEntries()
+{
+    DBG("Testing timelines in use...");
+
+    TimelineCache cache;
+    cache.setMemoryLimit(0);
+
+    // A playing track keeps its timeline alive, whatever the limit
+    auto playing = getTimeline(cache, createMidiData(8, 36));
+    getTimeline(cache, createMidiData(8, 38));
+    getTimeline(cache, createMidiData(8, 42));
+
+    // The timeline just returned is only released by its caller afterwards
+    TestFramework::assertEqualInt(1, cache.getStatistics().evictions, "Released timeline evicted on the next insert");
+
+    cache.removeUnused();
+    auto statistics = cache.getStatistics();
+    TestFramework::assertEqualInt(1, statistics.numEntries, "Only the timeline in use stays");
+    TestFramework::assertTrue(statistics.memoryUsage > statistics.memoryLimit, "Limit exceeded while it plays");
+
+    TestFramework::assertTrue(getTimeline(cache, createMidiData(8, 36)) == playing, "Timeline in use still served");
+
+    // Once released, the entry goes with the next eviction
+    playing.reset();
+    cache.removeUnused();
+    TestFramework::assertEqualInt(0, cache.getStatistics().numEntries, "Released timeline evicted");
+    TestFramework::assertTrue(cache.getStatistics().memoryUsage == 0, "No memory left");
+
+    return true;
+}
+
+bool TimelineCacheTests::testMemoryAccounting()
+{
+    DBG("Testing memory accounting...");
+
+    TimelineCache cache;
+
+    auto small = getTimeline(cache, createMidiData(4, 36));
+    auto large = getTimeline(cache, createMidiData(400, 36));
+
+    TestFramework::assertTrue(small != nullptr && large != nullptr, "Both parsed");
+    TestFramework::assertTrue(large->getMemoryUsage() > small->getMemoryUsage(), "Longer track takes more memory");
+    TestFramework::assertTrue(large->getMemoryUsage() >= static_cast<size_t>(large->getNumEvents()) * sizeof(MidiTimeline::Event),
+                              "Memory covers every event");
+
+    auto statistics = cache.getStatistics();
+    TestFramework::assertTrue(statistics.memoryUsage == small->getMemoryUsage() + large->getMemoryUsage(),
+                              "Cache memory is the sum of its timelines");
+    TestFramework::assertTrue(statistics.memoryLimit == TimelineCache::defaultMemoryLimit, "Default limit");
+
+    return true;
+}
+
+bool TimelineCacheTests::testInvalidData()
+{
+    DBG("Testing data that cannot be parsed...");
+
+    TimelineCache cache;
+    MidiManager midiManager;
+
+    const char text[] = "not a MIDI file";
+    TestFramework::assertTrue(cache.getTimeline(text, sizeof(text), midiManager) == nullptr, "Invalid data rejected");
+    TestFramework::assertTrue(cache.getTimeline(nullptr, 0, midiManager) == nullptr, "Empty data rejected");
+
+    // Not cached, so a retry parses again
+    TestFramework::assertTrue(cache.getTimeline(text, sizeof(text), midiManager) == nullptr, "Retry rejected too");
+
+    auto statistics = cache.getStatistics();
+    TestFramework::assertEqualInt(0, statistics.numEntries, "Failed parses not cached");
+    TestFramework::assertEqualInt(2, statistics.misses, "Each attempt parsed");
+
+    return true;
+}
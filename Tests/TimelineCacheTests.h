@@ -0,0 +1,48 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/TimelineCache.h"
+
+//==============================================================================
+/**
+    Unit Tests for TimelineCache class
+
+    Tests the shared timeline cache including:
+    - One parse per content, shared by every lookup
+    - Least recently used eviction over the memory limit
+    - Timelines in use surviving eviction
+    - Memory accounting and data that fails to parse
+*/
+class TimelineCacheTests
+{
+public:
+    //==============================================================================
+    TimelineCacheTests();
+    ~TimelineCacheTests();
+
+    //==============================================================================
+    /** Run all TimelineCache tests */
+    static bool runAllTests();
+
+    //==============================================================================
+    // Individual Test Methods
+
+    /** Test that identical content is parsed once and shared */
+    static bool testSharing();
+
+    /** Test least recently used eviction */
+    static bool testEviction();
+
+    /** Test that timelines still in use are kept */
+    static bool testInUseEntries();
+
+    /** Test memory accounting */
+    static bool testMemoryAccounting();
+
+    /** Test data that cannot be parsed */
+    static bool testInvalidData();
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimelineCacheTests)
+};
@@ -0,0 +1,329 @@
+#include "TrackExchangeTests.h"
+
+namespace
+{
+    /** Publishes a stream of new bass tracks, like a loader thread would */
+    class PublisherThread : public juce::Thread
+    {
+    public:
+        PublisherThread(TrackExchange& exchangeToUse, int generationsToPublish)
+            : juce::Thread("Track Publisher"),
+              exchange(exchangeToUse),
+              numGenerations(generationsToPublish)
+        {
+        }
+
+        void run() override
+        {
+            for (int i = 0; i < numGenerations && !threadShouldExit(); ++i)
+            {
+                auto timeline = std::make_unique<MidiTimeline>();
+                auto numNotes = 1 + i % 16;
+
+                for (int note = 0; note < numNotes; ++note)
+                {
+                    auto message = juce::MidiMessage::noteOn(1, 36 + note, (juce::uint8)100);
+                    timeline->addEvent(message.getRawData(), message.getRawDataSize(), note * 240);
+                }
+
+                timeline->finishCompiling();
+
+                TrackExchange::TrackList newTracks;
+                newTracks.push_back(std::move(timeline));
+                exchange.publish(std::move(newTracks));
+            }
+        }
+
+    private:
+        TrackExchange& exchange;
+        int numGenerations;
+    };
+}
+
+//==============================================================================
+TrackExchangeTests::TrackExchangeTests()
+{
+}
+
+TrackExchangeTests::~TrackExchangeTests()
+{
+}
+
+//==============================================================================
+bool TrackExchangeTests::runAllTests()
+{
+    DBG("=== Running TrackExchange Tests ===");
+
+    bool allPassed = true;
+
+    allPassed &= testPublishAndUpdate();
+    allPassed &= testDeferredReclamation();
+    allPassed &= testConcurrentPublishing();
+    allPassed &= testTrackTable();
+    allPassed &= testTransforms();
+    allPassed &= testQueuedSwitch();
+
+    DBG("=== TrackExchange Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool TrackExchangeTests::testPublishAndUpdate()
+{
+    DBG("Testing snapshot publication...");
+
+    TrackExchange exchange;
+
+    // The initial snapshot holds empty tracks rather than null pointers
+    TestFramework::assertTrue(exchange.getCurrent().getTrack(TrackExchange::bassTrack).isEmpty(), "Initial bass track is empty");
+    TestFramework::assertTrue(exchange.getCurrent().getTrack(TrackExchange::drumTrack).isEmpty(), "Initial drum track is empty");
+    TestFramework::assertTrue(!exchange.update(), "Nothing to update before publishing");
+
+    auto generation = exchange.publish(createTrackList(createTimeline(4), createTimeline(2)));
+    TestFramework::assertEqualInt(1, (int) generation, "First generation number");
+
+    // Publishing alone does not change what the audio thread plays
+    TestFramework::assertTrue(exchange.getCurrent().getTrack(TrackExchange::bassTrack).isEmpty(), "Published tracks wait for update()");
+
+    TestFramework::assertTrue(exchange.update(), "New generation goes live");
+    TestFramework::assertEqualInt(8, exchange.getCurrent().getTrack(TrackExchange::bassTrack).getNumEvents(), "Bass track is current");
+    TestFramework::assertEqualInt(4, exchange.getCurrent().getTrack(TrackExchange::drumTrack).getNumEvents(), "Drum track is current");
+
+    // Replacing only the bass shares the drum track instead of copying it
+    const auto* drums = &exchange.getCurrent().getTrack(TrackExchange::drumTrack);
+    exchange.publish(createTrackList(createTimeline(8), nullptr));
+    exchange.update();
+
+    TestFramework::assertEqualInt(16, exchange.getCurrent().getTrack(TrackExchange::bassTrack).getNumEvents(), "Bass track replaced");
+    TestFramework::assertTrue(&exchange.getCurrent().getTrack(TrackExchange::drumTrack) == drums, "Unchanged drum track is shared");
+    TestFramework::assertEqualInt(2, (int) exchange.getCurrent().generation, "Current generation number");
+
+    // Only the latest of several publications goes live
+    exchange.publish(createTrackList(createTimeline(1), nullptr));
+    exchange.publish(createTrackList(createTimeline(3), nullptr));
+    TestFramework::assertTrue(exchange.update(), "Latest generation goes live");
+    TestFramework::assertEqualInt(6, exchange.getCurrent().getTrack(TrackExchange::bassTrack).getNumEvents(), "Stale publication skipped");
+    TestFramework::assertTrue(!exchange.update(), "No further update pending");
+
+    return true;
+}
+
+bool TrackExchangeTests::testDeferredReclamation()
+{
+    DBG("Testing deferred reclamation...");
+
+    TrackExchange exchange;
+    exchange.publish(createTrackList(createTimeline(4), nullptr));
+    exchange.update();
+
+    std::weak_ptr<const MidiTimeline> firstBass = exchange.getCurrent().tracks[TrackExchange::bassTrack];
+
+    exchange.publish(createTrackList(createTimeline(2), nullptr));
+    TestFramework::assertTrue(!firstBass.expired(), "Playing track survives a publication");
+
+    // The audio thread moves on, but must not free the track it played
+    exchange.update();
+    TestFramework::assertTrue(!firstBass.expired(), "Retired track is not freed by update()");
+
+    // A loader thread frees it later
+    exchange.collectGarbage();
+    TestFramework::assertTrue(firstBass.expired(), "Retired track freed by collectGarbage()");
+
+    return true;
+}
+
+bool TrackExchangeTests::testConcurrentPublishing()
+{
+    DBG("Testing concurrent publishing...");
+
+    const int numGenerations = 2000;
+
+    TrackExchange exchange;
+    PublisherThread publisher(exchange, numGenerations);
+
+    MidiTimeline::Cursor cursor;
+    juce::MidiBuffer output;
+    int numUpdates = 0;
+    bool eventsMatchTrack = true;
+
+    publisher.startThread();
+
+    // Audio thread side: pick up new generations at block boundaries and
+    // render whatever is current; a torn or freed snapshot would show up as
+    // an event count that does not match the track
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    while (exchange.getCurrent().generation < (juce::uint32) numGenerations
+           && juce::Time::getMillisecondCounterHiRes() - startTime < 10000.0)
+    {
+        if (exchange.update())
+        {
+            ++numUpdates;
+            cursor.reset();
+        }
+
+        const auto& bass = exchange.getCurrent().getTrack(TrackExchange::bassTrack);
+
+        // One window past the last event covers the whole track
+        MidiTimeline::MergeSource source { &bass, &cursor, nullptr, 0.0, bass.getLengthInBeats() + 1.0 };
+
+        output.clear();
+        auto numRendered = MidiTimeline::renderMergedBeatWindows(&source, 1, 1.0, output, 0, 1);
+        eventsMatchTrack &= numRendered == bass.getNumEvents();
+        cursor.reset();
+    }
+
+    publisher.stopThread(2000);
+    exchange.collectGarbage();
+    exchange.update();
+
+    TestFramework::assertTrue(eventsMatchTrack, "Rendered snapshots are always complete");
+    TestFramework::assertTrue(numUpdates > 0, "Generations went live while publishing");
+    TestFramework::assertEqualInt(numGenerations, (int) exchange.getCurrent().generation, "Final generation is current");
+
+    return true;
+}
+
+bool TrackExchangeTests::testTrackTable()
+{
+    DBG("Testing the track table...");
+
+    TrackExchange exchange;
+    TestFramework::assertEqualInt(TrackExchange::numNamedTracks, exchange.getCurrent().getNumTracks(),
+                                  "Every named instrument has a slot");
+
+    // Keys and a sixth track; the slots skipped in between start out empty
+    TrackExchange::TrackList newTracks(6);
+    newTracks[TrackExchange::keysTrack] = createTimeline(3);
+    newTracks[5] = createTimeline(5);
+    exchange.publish(std::move(newTracks));
+    exchange.update();
+
+    const auto& tracks = exchange.getCurrent();
+    TestFramework::assertEqualInt(6, tracks.getNumTracks(), "Table grows to the longest list");
+    TestFramework::assertEqualInt(6, tracks.getTrack(TrackExchange::keysTrack).getNumEvents(), "Keys track loaded");
+    TestFramework::assertEqualInt(10, tracks.getTrack(5).getNumEvents(), "Extra track loaded");
+    TestFramework::assertTrue(tracks.getTrack(4).isEmpty(), "Skipped slot is empty");
+
+    // A shorter list keeps the tracks after it
+    exchange.publish(createTrackList(createTimeline(2), nullptr));
+    exchange.update();
+    TestFramework::assertEqualInt(6, exchange.getCurrent().getNumTracks(), "Table does not shrink");
+    TestFramework::assertEqualInt(10, exchange.getCurrent().getTrack(5).getNumEvents(), "Other tracks kept");
+
+    // Density is summed over every track: four events per quarter note on
+    // each of the three loaded tracks
+    TestFramework::assertEqualInt(12, exchange.getCurrent().maxEventsPerBeat, "Density covers all tracks");
+
+    return true;
+}
+
+bool TrackExchangeTests::testTransforms()
+{
+    DBG("Testing track transforms...");
+
+    TrackExchange exchange;
+    exchange.publish(createTrackList(createTimeline(4), createTimeline(2)));
+    exchange.update();
+
+    const auto* bass = &exchange.getCurrent().getTrack(TrackExchange::bassTrack);
+    const auto* drums = &exchange.getCurrent().getTrack(TrackExchange::drumTrack);
+    auto loadGeneration = exchange.getCurrent().loadGeneration;
+
+    EventTransform octaveDown;
+    octaveDown.transpose(-12);
+
+    TestFramework::assertTrue(exchange.setTransform(TrackExchange::bassTrack, octaveDown), "New transform needs a bake");
+    TestFramework::assertTrue(!exchange.setTransform(TrackExchange::bassTrack, octaveDown), "Same transform again does not");
+    TestFramework::assertTrue(!exchange.update(), "Setting a transform publishes nothing by itself");
+
+    TestFramework::assertTrue(exchange.bakeTransforms() != 0, "Bake publishes the changed track");
+    TestFramework::assertEqualInt(0, static_cast<int>(exchange.bakeTransforms()), "Nothing left to bake");
+    exchange.update();
+
+    const auto& tracks = exchange.getCurrent();
+    TestFramework::assertTrue(&tracks.getTrack(TrackExchange::bassTrack) != bass, "Bass track re-baked");
+    TestFramework::assertTrue(&tracks.getTrack(TrackExchange::drumTrack) == drums, "Drum track shared, not copied");
+    TestFramework::assertTrue(tracks.loadGeneration == loadGeneration, "Re-bake is not a new load");
+    TestFramework::assertEqualInt(24, tracks.getTrack(TrackExchange::bassTrack).getEventData(tracks.getTrack(TrackExchange::bassTrack).getEvent(0))[1],
+                                  "Bass is an octave down");
+
+    // New files are baked with the transform already in place
+    exchange.publish(createTrackList(createTimeline(1), nullptr));
+    exchange.update();
+    const auto& reloaded = exchange.getCurrent().getTrack(TrackExchange::bassTrack);
+    TestFramework::assertEqualInt(24, reloaded.getEventData(reloaded.getEvent(0))[1], "Loaded track is transformed");
+    TestFramework::assertTrue(exchange.getCurrent().loadGeneration != loadGeneration, "Loading is a new load");
+
+    // Back to the identity shares the loaded track again
+    exchange.setTransform(TrackExchange::bassTrack, EventTransform());
+    exchange.bakeTransforms();
+    exchange.update();
+    const auto& restored = exchange.getCurrent().getTrack(TrackExchange::bassTrack);
+    TestFramework::assertEqualInt(36, restored.getEventData(restored.getEvent(0))[1], "Identity plays the track as loaded");
+
+    return true;
+}
+
+bool TrackExchangeTests::testQueuedSwitch()
+{
+    DBG("Testing queued switches...");
+
+    TrackExchange exchange;
+    TestFramework::assertTrue(exchange.receive() == nullptr, "Nothing queued at first");
+
+    exchange.publish(createTrackList(createTimeline(3), nullptr));
+    const auto* queued = exchange.receive();
+
+    TestFramework::assertTrue(queued != nullptr && queued->getTrack(TrackExchange::bassTrack).getNumEvents() == 6,
+                              "Published snapshot is queued");
+    TestFramework::assertTrue(exchange.getCurrent().getTrack(TrackExchange::bassTrack).isEmpty(), "Queued snapshot is not playing yet");
+    TestFramework::assertTrue(exchange.receive() == queued, "Queued snapshot waits for the switch");
+
+    // A newer publication replaces the queued one before the switch
+    std::weak_ptr<const MidiTimeline> replacedBass = queued->tracks[TrackExchange::bassTrack];
+    exchange.publish(createTrackList(createTimeline(5), nullptr));
+    queued = exchange.receive();
+
+    TestFramework::assertTrue(queued != nullptr && queued->getTrack(TrackExchange::bassTrack).getNumEvents() == 10,
+                              "Newer snapshot replaces the queued one");
+    TestFramework::assertTrue(!replacedBass.expired(), "Replaced snapshot is not freed by the audio thread");
+
+    exchange.collectGarbage();
+    TestFramework::assertTrue(replacedBass.expired(), "Replaced snapshot freed by collectGarbage()");
+
+    TestFramework::assertTrue(exchange.switchToQueued(), "Switch to the queued snapshot");
+    TestFramework::assertEqualInt(10, exchange.getCurrent().getTrack(TrackExchange::bassTrack).getNumEvents(), "Queued snapshot is playing");
+    TestFramework::assertTrue(exchange.receive() == nullptr && !exchange.switchToQueued(), "Nothing left to switch to");
+
+    return true;
+}
+
+//==============================================================================
+// Helper Methods
+
+std::unique_ptr<MidiTimeline> TrackExchangeTests::createTimeline(int numNotes)
+{
+    auto timeline = std::make_unique<MidiTimeline>();
+
+    for (int note = 0; note < numNotes; ++note)
+    {
+        auto noteOn = juce::MidiMessage::noteOn(1, 36 + note, (juce::uint8)100);
+        auto noteOff = juce::MidiMessage::noteOff(1, 36 + note);
+
+        timeline->addEvent(noteOn.getRawData(), noteOn.getRawDataSize(), note * 480);
+        timeline->addEvent(noteOff.getRawData(), noteOff.getRawDataSize(), note * 480 + 240);
+    }
+
+    timeline->finishCompiling();
+    return timeline;
+}
+
+TrackExchange::TrackList TrackExchangeTests::createTrackList(std::unique_ptr<MidiTimeline> bass,
+                                                             std::unique_ptr<MidiTimeline> drums)
+{
+    TrackExchange::TrackList newTracks;
+    newTracks.push_back(std::move(bass));
+    newTracks.push_back(std::move(drums));
+    return newTracks;
+}
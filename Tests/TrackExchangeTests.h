@@ -0,0 +1,61 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/TrackExchange.h"
+
+//==============================================================================
+/**
+    Unit Tests for TrackExchange class
+
+    Tests the publication of track snapshots to the audio thread including:
+    - Generations going live on update()
+    - Sharing of unchanged tracks between snapshots
+    - Deferred reclamation of retired snapshots
+    - Publishing while the audio thread is rendering
+    - Growing the track table beyond bass and drums
+*/
+class TrackExchangeTests
+{
+public:
+    //==============================================================================
+    TrackExchangeTests();
+    ~TrackExchangeTests();
+
+    //==============================================================================
+    /** Run all TrackExchange tests */
+    static bool runAllTests();
+
+    //==============================================================================
+    // Individual Test Methods
+
+    /** Test that published tracks go live on the next update */
+    static bool testPublishAndUpdate();
+
+    /** Test that old snapshots are only freed by collectGarbage() */
+    static bool testDeferredReclamation();
+
+    /** Test publishing from another thread while rendering */
+    static bool testConcurrentPublishing();
+
+    /** Test publishing a table of more than two tracks */
+    static bool testTrackTable();
+
+    /** Test that changed transforms re-bake only their own track */
+    static bool testTransforms();
+
+    /** Test receiving a snapshot ahead of switching to it */
+    static bool testQueuedSwitch();
+
+private:
+    //==============================================================================
+    /** Helper method to create a timeline with a number of notes */
+    static std::unique_ptr<MidiTimeline> createTimeline(int numNotes);
+
+    /** Helper method to list new bass and drum tracks for publish(); nullptr keeps a track */
+    static TrackExchange::TrackList createTrackList(std::unique_ptr<MidiTimeline> bass,
+                                                    std::unique_ptr<MidiTimeline> drums);
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackExchangeTests)
+};
@@ -0,0 +1,157 @@
+#include "TransportClockTests.h"
+
+//==============================================================================
+TransportClockTests::TransportClockTests()
+{
+}
+
+TransportClockTests::~TransportClockTests()
+{
+}
+
+//==============================================================================
+bool TransportClockTests::runAllTests()
+{
+    DBG("=== Running TransportClock Tests ===");
+
+    bool allPassed = true;
+
+    allPassed &= testLongRunAccuracy();
+    allPassed &= testTempoRamp();
+    allPassed &= testResetAndSampleRate();
+
+    DBG("=== TransportClock Tests Complete ===");
+    return allPassed;
+}
+
+//==============================================================================
+bool TransportClockTests::testLongRunAccuracy()
+{
+    DBG("Testing long-run transport accuracy...");
+
+    // Six hours at 48 kHz and 137 BPM, in the irregular block sizes some
+    // hosts use; the position is checked against exact integer arithmetic
+    const double sampleRate = 48000.0;
+    const juce::int64 samplesPerMinute = 48000 * 60;
+    const juce::int64 bpm = 137;
+    const juce::int64 totalSamples = (juce::int64) 6 * 60 * samplesPerMinute;
+
+    TransportClock clock;
+    clock.setSampleRate(sampleRate);
+    clock.setTempo(static_cast<double>(bpm));
+    clock.reset();
+
+    double maxErrorInSamples = 0.0;
+    int blockIndex = 0;
+
+    while (clock.getSamplePosition() < totalSamples)
+    {
+        clock.advance(getBlockSize(blockIndex++));
+
+        // Ideal beat = samples * bpm / samplesPerMinute, split into whole and
+        // fractional beats so it stays exact at any length
+        auto scaled = clock.getSamplePosition() * bpm;
+        auto idealBeat = static_cast<double>(scaled / samplesPerMinute)
+                         + static_cast<double>(scaled % samplesPerMinute) / static_cast<double>(samplesPerMinute);
+
+        auto errorInSamples = std::abs(clock.getBeatPosition() - idealBeat) * static_cast<double>(samplesPerMinute) / bpm;
+        maxErrorInSamples = juce::jmax(maxErrorInSamples, errorInSamples);
+    }
+
+    TestFramework::assertTrue(clock.getSamplePosition() >= totalSamples, "Six hours simulated");
+    TestFramework::assertTrue(maxErrorInSamples < 1.0, "Position within one sample after six hours");
+    TestFramework::assertTrue(maxErrorInSamples < 0.01, "No rounding builds up between blocks");
+
+    return true;
+}
+
+bool TransportClockTests::testTempoRamp()
+{
+    DBG("Testing tempo ramps...");
+
+    const double sampleRate = 44100.0;
+    const juce::int64 rampLength = 10 * 44100;
+
+    TransportClock clock;
+    clock.setSampleRate(sampleRate);
+    clock.setTempo(120.0);
+    clock.reset();
+
+    // One beat at 120 BPM, then ramp to 180 BPM over ten seconds
+    clock.advance(22050);
+    TestFramework::assertApproxEqual(1.0, clock.getBeatPosition(), 1.0e-12, "One beat before the ramp");
+
+    clock.setTempo(180.0, rampLength);
+    TestFramework::assertTrue(clock.isRamping(), "Ramp in progress");
+
+    int blockIndex = 0;
+
+    while (clock.getSamplePosition() < 22050 + rampLength / 2)
+        clock.advance(juce::jmin(getBlockSize(blockIndex++), static_cast<int>(22050 + rampLength / 2 - clock.getSamplePosition())));
+
+    // Halfway the tempo is 150 BPM; the beats played are the integral of the
+    // ramp: 5 s at an average of 135 BPM
+    TestFramework::assertApproxEqual(150.0, clock.getTempo(), 1.0e-9, "Tempo halfway through the ramp");
+    TestFramework::assertApproxEqual(1.0 + 5.0 * 135.0 / 60.0, clock.getBeatPosition(), 1.0e-9, "Position halfway through the ramp");
+
+    while (clock.getSamplePosition() < 22050 + rampLength + 60 * 44100)
+        clock.advance(getBlockSize(blockIndex++));
+
+    // After the ramp: 10 s at an average of 150 BPM, then 180 BPM
+    auto secondsAfterRamp = static_cast<double>(clock.getSamplePosition() - 22050 - rampLength) / sampleRate;
+    auto expectedBeat = 1.0 + 10.0 * 150.0 / 60.0 + secondsAfterRamp * 3.0;
+
+    TestFramework::assertTrue(!clock.isRamping(), "Ramp finished");
+    TestFramework::assertEqualDouble(180.0, clock.getTempo(), "Target tempo reached");
+    TestFramework::assertTrue(std::abs(clock.getBeatPosition() - expectedBeat) * 14700.0 < 1.0,
+                              "Position within one sample after the ramp");
+
+    // A ramp can be redirected before it finishes
+    clock.setTempo(90.0, 44100);
+    clock.advance(22050);
+    clock.setTempo(60.0);
+    TestFramework::assertTrue(!clock.isRamping(), "Immediate change cancels the ramp");
+    TestFramework::assertEqualDouble(60.0, clock.getTempo(), "Immediate tempo change");
+
+    return true;
+}
+
+bool TransportClockTests::testResetAndSampleRate()
+{
+    DBG("Testing transport reset and sample rate changes...");
+
+    TransportClock clock;
+    clock.setSampleRate(44100.0);
+    clock.setTempo(120.0);
+    clock.reset(4.0);
+
+    TestFramework::assertEqualDouble(4.0, clock.getBeatPosition(), "Reset to a beat");
+
+    clock.advance(44100);
+    TestFramework::assertApproxEqual(6.0, clock.getBeatPosition(), 1.0e-12, "Two beats per second at 120 BPM");
+
+    // A new sample rate keeps the position and the tempo
+    clock.setSampleRate(96000.0);
+    TestFramework::assertApproxEqual(6.0, clock.getBeatPosition(), 1.0e-12, "Position kept across sample rates");
+
+    clock.advance(96000);
+    TestFramework::assertApproxEqual(8.0, clock.getBeatPosition(), 1.0e-12, "Tempo kept across sample rates");
+
+    clock.reset();
+    TestFramework::assertEqualDouble(0.0, clock.getBeatPosition(), "Reset to the start");
+    TestFramework::assertTrue(clock.getSamplePosition() == 0, "Sample counter restarts");
+    TestFramework::assertEqualDouble(120.0, clock.getTempo(), "Reset keeps the tempo");
+
+    return true;
+}
+
+//==============================================================================
+// Helper Methods
+
+int TransportClockTests::getBlockSize(int blockIndex)
+{
+    // Mostly full blocks with the odd short one, like hosts splitting blocks
+    // at automation points
+    static const int blockSizes[] = { 512, 512, 333, 512, 64, 512, 1, 511, 480, 441 };
+    return blockSizes[blockIndex % 10];
+}
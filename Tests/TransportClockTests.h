@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TestFramework.h"
+#include "../Source/TransportClock.h"
+
+//==============================================================================
+/**
+    Unit Tests for TransportClock class
+
+    Tests the internal transport including:
+    - Sample accuracy over hours of playback with irregular block sizes
+    - Linear tempo ramps against their exact integral
+    - Reset and sample rate changes
+*/
+class TransportClockTests
+{
+public:
+    //==============================================================================
+    TransportClockTests();
+    ~TransportClockTests();
+
+    //==============================================================================
+    /** Run all TransportClock tests */
+    static bool runAllTests();
+
+    //==============================================================================
+    // Individual Test Methods
+
+    /** Test that a constant tempo stays within a sample over hours */
+    static bool testLongRunAccuracy();
+
+    /** Test tempo ramps and the tempo after them */
+    static bool testTempoRamp();
+
+    /** Test reset and sample rate changes */
+    static bool testResetAndSampleRate();
+
+private:
+    //==============================================================================
+    /** Helper method returning the next block size of an irregular host */
+    static int getBlockSize(int blockIndex);
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TransportClockTests)
+};